@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "api_client.h"
+
+namespace {
+    struct BenchConfig {
+        std::string base_url = "https://www.dnd5eapi.co/api/2014";
+        std::string endpoint = "spells";
+        std::string index = "fireball";
+        int requests_per_caller = 50;
+        std::vector<int> callers = {1, 4, 16, 64};
+        dnd5e::ApiClientOptions client_options;
+    };
+
+    std::vector<int> ParseCallers(const std::string& value) {
+        std::vector<int> callers;
+        std::stringstream stream(value);
+        std::string token;
+        while (std::getline(stream, token, ',')) {
+            callers.push_back(std::stoi(token));
+        }
+        return callers;
+    }
+
+    double Percentile(std::vector<double>& latencies, double percentile) {
+        if (latencies.empty()) {
+            return 0.0;
+        }
+        size_t rank = std::min(latencies.size() - 1, static_cast<size_t>(percentile * latencies.size()));
+        std::nth_element(latencies.begin(), latencies.begin() + rank, latencies.end());
+        return latencies[rank];
+    }
+
+    void RunRound(dnd5e::ApiClient& client, const BenchConfig& config, int callers) {
+        std::atomic<int> failures{0};
+        std::vector<std::thread> threads;
+        std::vector<std::vector<double>> latencies(callers);
+        threads.reserve(callers);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < callers; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < config.requests_per_caller; ++i) {
+                    auto request_start = std::chrono::steady_clock::now();
+                    try {
+                        if (config.index.empty()) {
+                            client.GetList(config.endpoint);
+                        } else {
+                            client.GetItem(config.endpoint, config.index);
+                        }
+                    } catch (const std::exception&) {
+                        failures++;
+                    }
+                    latencies[t].push_back(std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - request_start).count());
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        int total = callers * config.requests_per_caller;
+        std::vector<double> all_latencies;
+        for (const auto& caller_latencies : latencies) {
+            all_latencies.insert(all_latencies.end(), caller_latencies.begin(), caller_latencies.end());
+        }
+        std::cout << std::setw(8) << callers
+                  << std::setw(10) << total
+                  << std::setw(10) << failures.load()
+                  << std::setw(12) << std::fixed << std::setprecision(3) << elapsed
+                  << std::setw(14) << std::fixed << std::setprecision(1) << (total / elapsed)
+                  << std::setw(10) << std::fixed << std::setprecision(2) << Percentile(all_latencies, 0.50)
+                  << std::setw(10) << std::fixed << std::setprecision(2) << Percentile(all_latencies, 0.99)
+                  << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--base-url" && i + 1 < argc) {
+            config.base_url = argv[++i];
+        } else if (arg == "--endpoint" && i + 1 < argc) {
+            config.endpoint = argv[++i];
+        } else if (arg == "--index" && i + 1 < argc) {
+            config.index = argv[++i];
+        } else if (arg == "--requests" && i + 1 < argc) {
+            config.requests_per_caller = std::stoi(argv[++i]);
+        } else if (arg == "--callers" && i + 1 < argc) {
+            config.callers = ParseCallers(argv[++i]);
+        } else if (arg == "--http2") {
+            config.client_options.http2 = true;
+        } else if (arg == "--http2-max-streams" && i + 1 < argc) {
+            config.client_options.http2_max_streams = std::stol(argv[++i]);
+        } else if (arg == "--hedge") {
+            config.client_options.hedge = true;
+        } else if (arg == "--hedge-percentile" && i + 1 < argc) {
+            config.client_options.hedge_percentile = std::stod(argv[++i]);
+        } else if (arg == "--hedge-budget" && i + 1 < argc) {
+            config.client_options.hedge_budget = std::stod(argv[++i]);
+        } else if (arg == "--help") {
+            std::cout << "ApiClient throughput benchmark\n";
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << "Options:\n";
+            std::cout << "  --base-url <url>    Upstream base URL (default: " << config.base_url << ")\n";
+            std::cout << "  --endpoint <name>   Endpoint to fetch (default: spells)\n";
+            std::cout << "  --index <index>     Item index, empty string fetches the list (default: fireball)\n";
+            std::cout << "  --requests <n>      Requests per caller (default: 50)\n";
+            std::cout << "  --callers <list>    Comma separated caller counts (default: 1,4,16,64)\n";
+            std::cout << "  --http2             Multiplex requests over HTTP/2\n";
+            std::cout << "  --http2-max-streams <n>  Max concurrent HTTP/2 streams (default: 100)\n";
+            std::cout << "  --hedge             Hedge slow item requests\n";
+            std::cout << "  --hedge-percentile <p>  Latency percentile that triggers a hedge (default: 0.95)\n";
+            std::cout << "  --hedge-budget <ratio>  Max hedges per primary request (default: 0.05)\n";
+            return 0;
+        }
+    }
+
+    dnd5e::ApiClient client(config.base_url, config.client_options);
+
+    std::cout << "Target: " << config.base_url << "/" << config.endpoint;
+    if (!config.index.empty()) {
+        std::cout << "/" << config.index;
+    }
+    std::cout << "\n";
+    std::cout << std::setw(8) << "callers"
+              << std::setw(10) << "requests"
+              << std::setw(10) << "failed"
+              << std::setw(12) << "seconds"
+              << std::setw(14) << "req/sec"
+              << std::setw(10) << "p50 ms"
+              << std::setw(10) << "p99 ms" << "\n";
+
+    for (int callers : config.callers) {
+        RunRound(client, config, callers);
+    }
+
+    if (config.client_options.hedge) {
+        auto hedge = client.GetHedgeStats();
+        std::cout << "Hedges: " << hedge.hedges_sent << " sent for " << hedge.primary_requests << " requests, "
+                  << hedge.hedges_won << " won, " << hedge.hedges_throttled << " throttled\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "item_cache.h"
+
+// Replays an item access trace through the item cache under each eviction
+// policy and compares hit ratios. Without --trace it synthesizes one: Zipf
+// traffic over a hot set mixed with a scraper walking a much larger range
+// in order, the pattern that flushes a plain LRU.
+
+namespace {
+    struct Access {
+        std::string key;
+        size_t bytes;
+    };
+
+    struct TraceConfig {
+        size_t requests = 500000;
+        size_t hot_keys = 2000;
+        double zipf_exponent = 0.9;
+        size_t scan_keys = 20000;
+        double scan_share = 0.3;
+        uint64_t seed = 42;
+    };
+
+    // Deterministic body size in [512, 8 KiB) so every replay charges the same
+    size_t BodyBytes(const std::string& key) {
+        return 512 + std::hash<std::string>{}(key) % (8 * 1024 - 512);
+    }
+
+    std::vector<Access> SynthesizeTrace(const TraceConfig& config) {
+        std::vector<double> cdf(config.hot_keys);
+        double total = 0.0;
+        for (size_t rank = 0; rank < config.hot_keys; ++rank) {
+            total += 1.0 / std::pow(static_cast<double>(rank + 1), config.zipf_exponent);
+            cdf[rank] = total;
+        }
+
+        std::mt19937_64 rng(config.seed);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::vector<Access> trace;
+        trace.reserve(config.requests);
+        size_t scan_position = 0;
+        for (size_t i = 0; i < config.requests; ++i) {
+            std::string key;
+            if (uniform(rng) < config.scan_share) {
+                key = (scan_position % 2 == 0 ? "equipment/scan-" : "monsters/scan-") + std::to_string(scan_position);
+                scan_position = (scan_position + 1) % config.scan_keys;
+            } else {
+                size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng) * total) - cdf.begin();
+                key = (rank % 2 == 0 ? "spells/hot-" : "monsters/hot-") + std::to_string(rank);
+            }
+            size_t bytes = BodyBytes(key);
+            trace.push_back({std::move(key), bytes});
+        }
+        return trace;
+    }
+
+    // One access per line: "<endpoint>/<index> [body bytes]"
+    std::vector<Access> ReadTrace(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("Cannot open trace: " + path);
+        }
+        std::vector<Access> trace;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            Access access;
+            if (!(fields >> access.key)) {
+                continue;
+            }
+            if (!(fields >> access.bytes)) {
+                access.bytes = BodyBytes(access.key);
+            }
+            trace.push_back(std::move(access));
+        }
+        return trace;
+    }
+
+    void WriteTrace(const std::string& path, const std::vector<Access>& trace) {
+        std::ofstream out(path);
+        for (const auto& access : trace) {
+            out << access.key << ' ' << access.bytes << '\n';
+        }
+    }
+
+    struct ReplayResult {
+        double hit_ratio;
+        size_t rejections;
+        double seconds;
+    };
+
+    ReplayResult Replay(const std::vector<Access>& trace, size_t capacity_bytes, size_t shards, dnd5e::CachePolicy policy) {
+        dnd5e::ItemCache cache(capacity_bytes, shards, policy);
+        auto fresh_until = dnd5e::ItemCache::Clock::now() + std::chrono::hours(1);
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& access : trace) {
+            if (!cache.Get(access.key).value) {
+                auto item = std::make_shared<dnd5e::ApiClient::ItemResponse>();
+                item->raw_json.assign(access.bytes, ' ');
+                cache.Put(access.key, std::move(item), fresh_until);
+            }
+        }
+        auto stats = cache.GetStats();
+        double lookups = static_cast<double>(stats.fresh_hits + stats.stale_hits + stats.misses);
+        return {lookups > 0 ? static_cast<double>(stats.fresh_hits + stats.stale_hits) / lookups : 0.0,
+                stats.rejections,
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+    }
+}
+
+int main(int argc, char* argv[]) {
+    TraceConfig config;
+    std::string trace_path;
+    std::string write_trace_path;
+    size_t shards = 16;
+    std::vector<double> capacities = {0.1, 0.25, 0.5, 1.0};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--write-trace" && i + 1 < argc) {
+            write_trace_path = argv[++i];
+        } else if (arg == "--requests" && i + 1 < argc) {
+            config.requests = std::stoul(argv[++i]);
+        } else if (arg == "--hot-keys" && i + 1 < argc) {
+            config.hot_keys = std::stoul(argv[++i]);
+        } else if (arg == "--zipf" && i + 1 < argc) {
+            config.zipf_exponent = std::stod(argv[++i]);
+        } else if (arg == "--scan-keys" && i + 1 < argc) {
+            config.scan_keys = std::stoul(argv[++i]);
+        } else if (arg == "--scan-share" && i + 1 < argc) {
+            config.scan_share = std::stod(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::stoull(argv[++i]);
+        } else if (arg == "--shards" && i + 1 < argc) {
+            shards = std::stoul(argv[++i]);
+        } else if (arg == "--help") {
+            std::cout << "Item cache eviction policy replay benchmark\n";
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << "Options:\n";
+            std::cout << "  --trace <file>      Replay a recorded trace: one \"<endpoint>/<index> [bytes]\" per line\n";
+            std::cout << "  --write-trace <file>  Save the synthesized trace\n";
+            std::cout << "  --requests <n>      Synthesized accesses (default: 500000)\n";
+            std::cout << "  --hot-keys <n>      Keys drawn by Zipf popularity (default: 2000)\n";
+            std::cout << "  --zipf <s>          Zipf exponent (default: 0.9)\n";
+            std::cout << "  --scan-keys <n>     Keys the scraper walks in order (default: 20000)\n";
+            std::cout << "  --scan-share <p>    Fraction of accesses from the scraper (default: 0.3)\n";
+            std::cout << "  --seed <n>          Random seed (default: 42)\n";
+            std::cout << "  --shards <n>        Item cache shards (default: 16)\n";
+            return 0;
+        }
+    }
+
+    std::vector<Access> trace = trace_path.empty() ? SynthesizeTrace(config) : ReadTrace(trace_path);
+    if (!write_trace_path.empty()) {
+        WriteTrace(write_trace_path, trace);
+    }
+
+    // Capacities are fractions of the bytes needed to hold every distinct key
+    std::vector<std::string> keys;
+    keys.reserve(trace.size());
+    for (const auto& access : trace) {
+        keys.push_back(access.key);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    size_t distinct_bytes = 0;
+    for (const auto& key : keys) {
+        distinct_bytes += BodyBytes(key);
+    }
+    std::cout << "Trace: " << trace.size() << " accesses, " << keys.size() << " distinct keys, "
+              << distinct_bytes / 1024 << " KiB distinct\n";
+
+    std::cout << std::setw(10) << "capacity"
+              << std::setw(12) << "KiB"
+              << std::setw(10) << "LRU %"
+              << std::setw(13) << "TinyLFU %"
+              << std::setw(10) << "delta"
+              << std::setw(12) << "rejected"
+              << std::setw(16) << "LRU/TLFU s" << "\n";
+    for (double fraction : capacities) {
+        auto capacity = static_cast<size_t>(fraction * static_cast<double>(distinct_bytes));
+        auto lru = Replay(trace, capacity, shards, dnd5e::CachePolicy::Lru);
+        auto tiny_lfu = Replay(trace, capacity, shards, dnd5e::CachePolicy::TinyLfu);
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(9) << fraction * 100 << "%"
+                  << std::setw(12) << capacity / 1024
+                  << std::setw(10) << lru.hit_ratio * 100
+                  << std::setw(13) << tiny_lfu.hit_ratio * 100
+                  << std::setw(10) << (tiny_lfu.hit_ratio - lru.hit_ratio) * 100
+                  << std::setw(12) << tiny_lfu.rejections
+                  << std::setw(8) << lru.seconds << "/" << std::setw(7) << tiny_lfu.seconds << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "json_backend.h"
+
+#ifndef DND5E_FIXTURES_DIR
+#define DND5E_FIXTURES_DIR "fixtures"
+#endif
+
+namespace {
+    struct Payload {
+        std::string label;
+        std::string body;
+    };
+
+    struct BenchConfig {
+        std::vector<std::string> files;
+        int iterations = 20000;
+    };
+
+    std::string ReadFile(const std::filesystem::path& path) {
+        std::ifstream input(path, std::ios::binary);
+        std::ostringstream contents;
+        contents << input.rdbuf();
+        return contents.str();
+    }
+
+    std::vector<Payload> LoadPayloads(const BenchConfig& config) {
+        std::vector<Payload> payloads;
+        if (!config.files.empty()) {
+            for (const auto& file : config.files) {
+                payloads.push_back({std::filesystem::path(file).filename().string(), ReadFile(file)});
+            }
+            return payloads;
+        }
+
+        // Default to every item fixture shipped with the repository
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(DND5E_FIXTURES_DIR, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".json" &&
+                entry.path().parent_path() != std::filesystem::path(DND5E_FIXTURES_DIR)) {
+                auto relative = std::filesystem::relative(entry.path(), DND5E_FIXTURES_DIR);
+                payloads.push_back({relative.string(), ReadFile(entry.path())});
+            }
+        }
+        std::sort(payloads.begin(), payloads.end(),
+            [](const Payload& a, const Payload& b) { return a.label < b.label; });
+        return payloads;
+    }
+
+    template <typename Fn>
+    void RunCase(const std::string& label, const std::string& name, const Payload& payload, int iterations, Fn&& fn) {
+        size_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            checksum += fn(payload.body);
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double ns_per_op = elapsed * 1e9 / iterations;
+        double mb_per_sec = (static_cast<double>(payload.body.size()) * iterations) / elapsed / (1024.0 * 1024.0);
+        std::cout << std::left << std::setw(44) << label << std::setw(18) << name << std::right
+                  << std::setw(12) << std::fixed << std::setprecision(0) << ns_per_op
+                  << std::setw(12) << std::fixed << std::setprecision(1) << mb_per_sec
+                  << std::setw(10) << (checksum % 1000) << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--file" && i + 1 < argc) {
+            config.files.push_back(argv[++i]);
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            config.iterations = std::stoi(argv[++i]);
+        } else if (arg == "--help") {
+            std::cout << "Item JSON backend benchmark\n";
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << "Options:\n";
+            std::cout << "  --file <path>       Item payload to parse (repeatable, default: bundled fixtures)\n";
+            std::cout << "  --iterations <n>    Extractions per payload and backend (default: 20000)\n";
+            return 0;
+        }
+    }
+
+    auto payloads = LoadPayloads(config);
+    if (payloads.empty()) {
+        std::cerr << "No payloads found in " << DND5E_FIXTURES_DIR << "\n";
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(44) << "payload" << std::setw(18) << "backend" << std::right
+              << std::setw(12) << "ns/op" << std::setw(12) << "MiB/s" << std::setw(10) << "check" << "\n";
+
+    for (const auto& payload : payloads) {
+        std::string label = payload.label + " (" + std::to_string(payload.body.size()) + " B)";
+
+        // What GetItem used to do: full DOM parse followed by a full dump()
+        RunCase(label, "nlohmann+dump", payload, config.iterations, [](const std::string& body) {
+            auto json = nlohmann::json::parse(body);
+            std::string name = json.value("name", "");
+            return name.size() + json.dump().size();
+        });
+
+        for (const auto& backend_name : dnd5e::GetAvailableJsonBackends()) {
+            auto backend = dnd5e::CreateJsonBackend(backend_name);
+            RunCase(label, backend_name, payload, config.iterations, [&backend](const std::string& body) {
+                auto fields = backend->ExtractItemFields(body);
+                return fields.name.size() + body.size();
+            });
+        }
+    }
+
+    return 0;
+}
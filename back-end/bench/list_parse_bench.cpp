@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "api_client.h"
+#include "list_stream_parser.h"
+
+// Heap accounting so each strategy can report its peak allocation
+namespace {
+    std::atomic<size_t> g_current_bytes{0};
+    std::atomic<size_t> g_peak_bytes{0};
+
+    constexpr size_t kHeaderSize = alignof(std::max_align_t);
+
+    void* TrackedAlloc(size_t size) {
+        void* block = std::malloc(size + kHeaderSize);
+        if (!block) {
+            throw std::bad_alloc();
+        }
+        *static_cast<size_t*>(block) = size;
+        size_t current = g_current_bytes.fetch_add(size) + size;
+        size_t peak = g_peak_bytes.load();
+        while (current > peak && !g_peak_bytes.compare_exchange_weak(peak, current)) {
+        }
+        return static_cast<char*>(block) + kHeaderSize;
+    }
+
+    void TrackedFree(void* ptr) {
+        if (!ptr) {
+            return;
+        }
+        void* block = static_cast<char*>(ptr) - kHeaderSize;
+        g_current_bytes.fetch_sub(*static_cast<size_t*>(block));
+        std::free(block);
+    }
+}
+
+void* operator new(size_t size) { return TrackedAlloc(size); }
+void* operator new[](size_t size) { return TrackedAlloc(size); }
+void operator delete(void* ptr) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { TrackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { TrackedFree(ptr); }
+
+namespace {
+    struct BenchConfig {
+        std::string file;
+        int items = 20000;
+        int iterations = 20;
+        size_t chunk_size = 16 * 1024;
+    };
+
+    std::string GeneratePayload(int items) {
+        std::ostringstream out;
+        out << "{\"count\":" << items << ",\"results\":[";
+        for (int i = 0; i < items; ++i) {
+            if (i > 0) {
+                out << ",";
+            }
+            out << "{\"index\":\"srd-entry-" << i << "\","
+                << "\"name\":\"SRD Entry " << i << "\","
+                << "\"level\":" << (i % 10) << ","
+                << "\"url\":\"/api/2014/monsters/srd-entry-" << i << "\"}";
+        }
+        out << "]}";
+        return out.str();
+    }
+
+    // Previous behaviour: buffer the whole body, build a DOM, copy fields out
+    dnd5e::ApiClient::ApiResponse ParseWithDom(const std::string& payload, size_t chunk_size) {
+        std::string body;
+        for (size_t pos = 0; pos < payload.size(); pos += chunk_size) {
+            body.append(payload, pos, chunk_size);
+        }
+
+        auto json = nlohmann::json::parse(body);
+        dnd5e::ApiClient::ApiResponse response;
+        response.count = json.value("count", 0);
+        if (json.contains("results") && json["results"].is_array()) {
+            for (const auto& item : json["results"]) {
+                dnd5e::ApiClient::ApiItem api_item;
+                api_item.index = item.value("index", "");
+                api_item.name = item.value("name", "");
+                api_item.url = item.value("url", "");
+                response.results.push_back(api_item);
+            }
+        }
+        return response;
+    }
+
+    dnd5e::ApiClient::ApiResponse ParseStreaming(const std::string& payload, size_t chunk_size) {
+        dnd5e::ListStreamParser parser;
+        for (size_t pos = 0; pos < payload.size(); pos += chunk_size) {
+            parser.Feed(payload.data() + pos, std::min(chunk_size, payload.size() - pos));
+        }
+        return parser.Finish();
+    }
+
+    template <typename Fn>
+    void RunCase(const std::string& name, const BenchConfig& config, const std::string& payload, Fn&& parse) {
+        std::vector<double> timings;
+        size_t peak_bytes = 0;
+        size_t item_count = 0;
+
+        for (int i = 0; i < config.iterations; ++i) {
+            size_t baseline = g_current_bytes.load();
+            g_peak_bytes = baseline;
+
+            auto start = std::chrono::steady_clock::now();
+            auto response = parse(payload, config.chunk_size);
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            timings.push_back(elapsed);
+            peak_bytes = std::max(peak_bytes, g_peak_bytes.load() - baseline);
+            item_count = response.results.size();
+        }
+
+        std::sort(timings.begin(), timings.end());
+        std::cout << std::left << std::setw(12) << name << std::right
+                  << std::setw(10) << item_count
+                  << std::setw(14) << std::fixed << std::setprecision(3) << timings[timings.size() / 2]
+                  << std::setw(14) << std::fixed << std::setprecision(3) << timings.front()
+                  << std::setw(16) << std::fixed << std::setprecision(2) << (peak_bytes / (1024.0 * 1024.0))
+                  << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--file" && i + 1 < argc) {
+            config.file = argv[++i];
+        } else if (arg == "--items" && i + 1 < argc) {
+            config.items = std::stoi(argv[++i]);
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            config.iterations = std::stoi(argv[++i]);
+        } else if (arg == "--chunk-size" && i + 1 < argc) {
+            config.chunk_size = std::stoul(argv[++i]);
+        } else if (arg == "--help") {
+            std::cout << "List response parsing benchmark (DOM vs streaming)\n";
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << "Options:\n";
+            std::cout << "  --file <path>       Parse a saved list response instead of a generated one\n";
+            std::cout << "  --items <n>         Items in the generated list (default: 20000)\n";
+            std::cout << "  --iterations <n>    Runs per strategy (default: 20)\n";
+            std::cout << "  --chunk-size <n>    Bytes per simulated write callback (default: 16384)\n";
+            return 0;
+        }
+    }
+
+    std::string payload;
+    if (!config.file.empty()) {
+        std::ifstream input(config.file, std::ios::binary);
+        if (!input) {
+            std::cerr << "Cannot open " << config.file << "\n";
+            return 1;
+        }
+        std::ostringstream contents;
+        contents << input.rdbuf();
+        payload = contents.str();
+    } else {
+        payload = GeneratePayload(config.items);
+    }
+
+    std::cout << "Payload: " << payload.size() << " bytes, chunk size " << config.chunk_size << "\n";
+    std::cout << std::left << std::setw(12) << "parser" << std::right
+              << std::setw(10) << "items"
+              << std::setw(14) << "median ms"
+              << std::setw(14) << "best ms"
+              << std::setw(16) << "peak heap MiB" << "\n";
+
+    RunCase("dom", config, payload, ParseWithDom);
+    RunCase("streaming", config, payload, ParseStreaming);
+
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dnd5e_service.h"
+#include "fake_transport.h"
+
+// Drives the gRPC service handlers directly against an in-process fake
+// upstream, so results depend only on this code and the chosen latency model.
+
+namespace {
+    const std::string kBaseUrl = "http://fake-upstream/api/2014";
+
+    struct BenchConfig {
+        dnd5e::FakeTransportOptions fake;
+        dnd5e::ApiClientOptions client_options;
+        int requests_per_caller = 200;
+        dnd5e::ServiceOptions service_options;
+        std::vector<int> callers = {1, 4, 16, 64};
+    };
+
+    std::vector<int> ParseCallers(const std::string& value) {
+        std::vector<int> callers;
+        std::stringstream stream(value);
+        std::string token;
+        while (std::getline(stream, token, ',')) {
+            callers.push_back(std::stoi(token));
+        }
+        return callers;
+    }
+
+    double Percentile(std::vector<double>& latencies, double percentile) {
+        if (latencies.empty()) {
+            return 0.0;
+        }
+        size_t rank = std::min(latencies.size() - 1, static_cast<size_t>(percentile * latencies.size()));
+        std::nth_element(latencies.begin(), latencies.begin() + rank, latencies.end());
+        return latencies[rank];
+    }
+
+    // One RPC from a fixed mix: mostly item lookups, some lists and searches
+    bool CallOnce(dnd5e::Dnd5eServiceImpl& service, int sequence) {
+        grpc::ServerContext context;
+        grpc::Status status;
+        switch (sequence % 10) {
+            case 0: {
+                dnd5e::GetListRequest request;
+                request.set_endpoint("spells");
+                dnd5e::GetListResponse response;
+                status = service.GetList(&context, &request, &response);
+                break;
+            }
+            case 1: {
+                dnd5e::SearchItemsRequest request;
+                request.set_query("fire");
+                request.add_endpoints("spells");
+                request.set_max_results(10);
+                dnd5e::SearchItemsResponse response;
+                status = service.SearchItems(&context, &request, &response);
+                break;
+            }
+            default: {
+                dnd5e::GetItemRequest request;
+                request.set_endpoint(sequence % 2 ? "spells" : "monsters");
+                request.set_index(sequence % 2 ? "fireball" : "adult-red-dragon");
+                dnd5e::GetItemResponse response;
+                status = service.GetItem(&context, &request, &response);
+                break;
+            }
+        }
+        return status.ok();
+    }
+
+    void RunRound(dnd5e::Dnd5eServiceImpl& service, const BenchConfig& config, int callers) {
+        std::atomic<int> failures{0};
+        std::vector<std::thread> threads;
+        std::vector<std::vector<double>> latencies(callers);
+        threads.reserve(callers);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < callers; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < config.requests_per_caller; ++i) {
+                    auto request_start = std::chrono::steady_clock::now();
+                    if (!CallOnce(service, t * config.requests_per_caller + i)) {
+                        failures++;
+                    }
+                    latencies[t].push_back(std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - request_start).count());
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        int total = callers * config.requests_per_caller;
+        std::vector<double> all_latencies;
+        for (const auto& caller_latencies : latencies) {
+            all_latencies.insert(all_latencies.end(), caller_latencies.begin(), caller_latencies.end());
+        }
+        std::cout << std::setw(8) << callers
+                  << std::setw(10) << total
+                  << std::setw(10) << failures.load()
+                  << std::setw(12) << std::fixed << std::setprecision(3) << elapsed
+                  << std::setw(14) << std::fixed << std::setprecision(1) << (total / elapsed)
+                  << std::setw(10) << std::fixed << std::setprecision(2) << Percentile(all_latencies, 0.50)
+                  << std::setw(10) << std::fixed << std::setprecision(2) << Percentile(all_latencies, 0.99)
+                  << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    config.service_options.item_cache_bytes = 0;
+    config.fake.data_dir = DND5E_FIXTURES_DIR;
+    config.fake.base_url = kBaseUrl;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--data-dir" && i + 1 < argc) {
+            config.fake.data_dir = argv[++i];
+        } else if (arg == "--latency-ms" && i + 1 < argc) {
+            config.fake.latency_median_ms = std::stod(argv[++i]);
+        } else if (arg == "--latency-sigma" && i + 1 < argc) {
+            config.fake.latency_sigma = std::stod(argv[++i]);
+        } else if (arg == "--tail-probability" && i + 1 < argc) {
+            config.fake.tail_probability = std::stod(argv[++i]);
+        } else if (arg == "--tail-latency-ms" && i + 1 < argc) {
+            config.fake.tail_latency_ms = std::stod(argv[++i]);
+        } else if (arg == "--error-rate" && i + 1 < argc) {
+            config.fake.error_rate = std::stod(argv[++i]);
+        } else if (arg == "--drop-rate" && i + 1 < argc) {
+            config.fake.drop_rate = std::stod(argv[++i]);
+        } else if (arg == "--payload-scale" && i + 1 < argc) {
+            config.fake.payload_scale = std::stoul(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.fake.seed = std::stoull(argv[++i]);
+        } else if (arg == "--requests" && i + 1 < argc) {
+            config.requests_per_caller = std::stoi(argv[++i]);
+        } else if (arg == "--callers" && i + 1 < argc) {
+            config.callers = ParseCallers(argv[++i]);
+        } else if (arg == "--hedge") {
+            config.client_options.hedge = true;
+        } else if (arg == "--json-backend" && i + 1 < argc) {
+            config.client_options.json_backend = argv[++i];
+        } else if (arg == "--item-cache-bytes" && i + 1 < argc) {
+            config.service_options.item_cache_bytes = std::stoull(argv[++i]);
+        } else if (arg == "--cache-ttl-s" && i + 1 < argc) {
+            config.service_options.cache_ttl = std::chrono::seconds(std::stol(argv[++i]));
+        } else if (arg == "--refresh-threads" && i + 1 < argc) {
+            config.service_options.refresh_threads = std::stoul(argv[++i]);
+        } else if (arg == "--help") {
+            std::cout << "gRPC service benchmark against a fake upstream\n";
+            std::cout << "Usage: " << argv[0] << " [options]\n";
+            std::cout << "Options:\n";
+            std::cout << "  --data-dir <dir>    SRD dump served by the fake upstream (default: fixtures)\n";
+            std::cout << "  --latency-ms <ms>   Median upstream latency (default: 20)\n";
+            std::cout << "  --latency-sigma <s> Log-normal latency spread (default: 0.5)\n";
+            std::cout << "  --tail-probability <p>  Chance of an extra slow-tail delay (default: 0)\n";
+            std::cout << "  --tail-latency-ms <ms>  Slow-tail delay (default: 500)\n";
+            std::cout << "  --error-rate <ratio>    Fraction of 503 responses (default: 0)\n";
+            std::cout << "  --drop-rate <ratio>     Fraction of dropped connections (default: 0)\n";
+            std::cout << "  --payload-scale <n> Inflate bodies n times (default: 1)\n";
+            std::cout << "  --seed <n>          Random seed for latency and failures (default: 42)\n";
+            std::cout << "  --requests <n>      Requests per caller (default: 200)\n";
+            std::cout << "  --callers <list>    Comma separated caller counts (default: 1,4,16,64)\n";
+            std::cout << "  --hedge             Hedge slow item requests\n";
+            std::cout << "  --json-backend <name>  Item JSON parser (default: fastest built)\n";
+            std::cout << "  --item-cache-bytes <n>  Service item cache budget, 0 to disable (default: 0)\n";
+            std::cout << "  --cache-ttl-s <s>   Freshness of cached lists and items (default: 3600)\n";
+            std::cout << "  --refresh-threads <n>  Background refreshers, 0 to refresh inline (default: 2)\n";
+            return 0;
+        }
+    }
+
+    auto transport = std::make_unique<dnd5e::FakeTransport>(config.fake);
+    std::cout << "Fake upstream: " << transport->GetEntryCount() << " entries from " << config.fake.data_dir
+              << ", median " << config.fake.latency_median_ms << " ms, errors "
+              << config.fake.error_rate * 100 << "%, drops " << config.fake.drop_rate * 100 << "%\n";
+
+    auto client = std::make_shared<dnd5e::ApiClient>(kBaseUrl, config.client_options, std::move(transport));
+    dnd5e::Dnd5eServiceImpl service(client, config.service_options);
+
+    std::cout << std::setw(8) << "callers"
+              << std::setw(10) << "requests"
+              << std::setw(10) << "failed"
+              << std::setw(12) << "seconds"
+              << std::setw(14) << "req/sec"
+              << std::setw(10) << "p50 ms"
+              << std::setw(10) << "p99 ms" << "\n";
+
+    for (int callers : config.callers) {
+        RunRound(service, config, callers);
+    }
+
+    for (const auto& [endpoint, stats] : client->GetTransferStats()) {
+        std::cout << "Upstream " << endpoint << ": " << stats.requests << " requests, "
+                  << stats.decoded_bytes << " bytes\n";
+    }
+    auto lists = service.GetSearchEngine().GetListCacheStats();
+    std::cout << "List cache: " << lists.fresh_hits << " fresh hits, " << lists.stale_hits << " stale hits, "
+              << lists.misses << " blocking misses\n";
+    if (const dnd5e::ItemCache* item_cache = service.GetItemCache()) {
+        auto cache = item_cache->GetStats();
+        std::cout << "Item cache: " << cache.fresh_hits << " fresh hits, " << cache.stale_hits << " stale hits, "
+                  << cache.misses << " blocking misses, "
+                  << cache.evictions << " evictions, " << cache.bytes << " bytes\n";
+    }
+
+    return 0;
+}
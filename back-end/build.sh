@@ -57,7 +57,7 @@ if ! pkg-config --exists protobuf; then
         sudo apt-get install -y build-essential cmake pkg-config \
             libprotobuf-dev protobuf-compiler libgrpc++-dev \
             protobuf-compiler-grpc libcurl4-openssl-dev \
-            nlohmann-json3-dev
+            nlohmann-json3-dev libsimdjson-dev
     else
         print_error "Please install protobuf and gRPC dependencies manually."
         exit 1
@@ -3,12 +3,56 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
-#include <nlohmann/json.hpp>
-#include <curl/curl.h>
+#include "circuit_breaker.h"
+#include "hedge_policy.h"
+#include "json_backend.h"
+#include "local_data_source.h"
+#include "single_flight.h"
+#include "upstream_error.h"
+#include "upstream_transport.h"
 
 namespace dnd5e {
 
+class ListStreamParser;
+
+struct ApiClientOptions {
+    // Multiplex all upstream requests over one HTTP/2 connection per host
+    bool http2 = false;
+    long http2_max_streams = 100;
+    // See GetAvailableJsonBackends(); empty picks the fastest one built in
+    std::string json_backend;
+    // Duplicate item requests still running past this latency percentile,
+    // with hedges capped at hedge_budget per primary request
+    bool hedge = false;
+    double hedge_percentile = 0.95;
+    double hedge_budget = 0.05;
+    // Retryable failures are retried with full-jitter exponential backoff;
+    // max_attempts includes the first try
+    int max_attempts = 3;
+    long retry_base_delay_ms = 100;
+    long retry_max_delay_ms = 2000;
+    // Per-endpoint breaker: fail fast after this many consecutive failures
+    size_t breaker_failure_threshold = 5;
+    long breaker_open_ms = 10000;
+    // A dead host should not cost the whole request timeout
+    long connect_timeout_ms = 5000;
+    // Resolve the upstream host at startup and re-resolve in the background
+    bool pin_dns = false;
+    long dns_refresh_ms = 60000;
+    // Serve everything from a local SRD dump and never contact upstream;
+    // at most one of the two may be set
+    std::string data_dir;
+    std::string data_pack;
+};
+
 class ApiClient {
 public:
     struct ApiItem {
@@ -17,12 +61,36 @@ public:
         std::string url;
     };
 
+    using Validators = HttpValidators;
+
     struct ApiResponse {
         int count;
         std::vector<ApiItem> results;
+        Validators validators;
+    };
+
+    // Upstream item body passed through untouched, plus the fields we index on
+    struct ItemResponse {
+        std::string raw_json;
+        std::string name;
+        std::string url;
+        Validators validators;
+    };
+
+    // Bytes received on the wire vs. bytes after content decoding
+    struct TransferStats {
+        size_t requests = 0;
+        size_t wire_bytes = 0;
+        size_t decoded_bytes = 0;
     };
 
-    explicit ApiClient(const std::string& base_url = "https://www.dnd5eapi.co/api/2014");
+    using ListCallback = std::function<void(std::exception_ptr error, ApiResponse response)>;
+    using ItemCallback = std::function<void(std::exception_ptr error, ItemResponse item)>;
+
+    // A null transport builds the libcurl one from options
+    explicit ApiClient(const std::string& base_url = "https://www.dnd5eapi.co/api/2014",
+                       const ApiClientOptions& options = ApiClientOptions(),
+                       std::unique_ptr<UpstreamTransport> transport = nullptr);
     ~ApiClient();
 
     ApiClient(const ApiClient&) = delete;
@@ -30,24 +98,93 @@ public:
     ApiClient(ApiClient&&) = delete;
     ApiClient& operator=(ApiClient&&) = delete;
 
-    ApiResponse GetList(const std::string& endpoint);
-    nlohmann::json GetItem(const std::string& endpoint, const std::string& index);
+    // control bounds how long this caller waits; a request it aborts fails with
+    // RequestCancelledError or DeadlineExceededError
+    ApiResponse GetList(const std::string& endpoint, const RequestControl& control = {});
+    ItemResponse GetItem(const std::string& endpoint, const std::string& index, const RequestControl& control = {});
+    std::optional<ApiResponse> GetListIfModified(const std::string& endpoint, const Validators& validators,
+                                                 const RequestControl& control = {});
+    std::optional<ItemResponse> GetItemIfModified(const std::string& endpoint, const std::string& index,
+                                                  const Validators& validators, const RequestControl& control = {});
+    // Async fetches coalesce with sync and async fetches of the same URL
+    std::future<ApiResponse> GetListAsync(const std::string& endpoint);
+    std::future<ItemResponse> GetItemAsync(const std::string& endpoint, const std::string& index);
+    void GetListAsync(const std::string& endpoint, ListCallback callback);
+    void GetItemAsync(const std::string& endpoint, const std::string& index, ItemCallback callback);
     std::vector<std::string> GetEndpoints();
     bool IsValidEndpoint(const std::string& endpoint);
     const std::string& GetBaseUrl() const;
+    const ApiClientOptions& GetOptions() const;
+    const char* GetJsonBackendName() const;
+    const char* GetTransportName() const;
+    // Opens up to `connections` upstream connections (DNS, TCP, TLS) ahead of
+    // traffic; returns how many succeeded. A no-op for local data.
+    size_t WarmUp(size_t connections);
+    // Null when requests go to the upstream API
+    const LocalDataSource* GetLocalDataSource() const;
     void SetTimeout(int timeout_seconds);
+    std::unordered_map<std::string, size_t> GetRequestStats() const;
+    std::unordered_map<std::string, TransferStats> GetTransferStats() const;
+    HedgePolicy::Stats GetHedgeStats() const;
+    // Null for unknown endpoints
+    const CircuitBreaker* GetCircuitBreaker(const std::string& endpoint) const;
 
 private:
+    struct RetryingRequest;
+
+    struct HttpResponse : UpstreamResponse {
+        // When set, a 200 body is parsed as it arrives instead of being buffered
+        std::shared_ptr<ListStreamParser> list_parser;
+    };
+
     std::string base_url_;
-    CURL* curl_;
-    int timeout_seconds_;
+    ApiClientOptions options_;
+    std::unique_ptr<JsonBackend> json_backend_;
+    std::unique_ptr<LocalDataSource> local_source_;
+    std::atomic<size_t> local_reads_;
+    std::unique_ptr<UpstreamTransport> transport_;
+    std::unique_ptr<HedgePolicy> hedge_policy_;
+    std::atomic<int> timeout_seconds_;
     std::vector<std::string> valid_endpoints_;
+    SingleFlight<ApiResponse> list_flights_;
+    SingleFlight<ItemResponse> item_flights_;
+    SingleFlight<std::optional<ApiResponse>> conditional_list_flights_;
+    SingleFlight<std::optional<ItemResponse>> conditional_item_flights_;
+    mutable std::mutex transfer_stats_mutex_;
+    std::unordered_map<std::string, TransferStats> transfer_stats_;
+    // Built once in the constructor, read-only afterwards
+    std::unordered_map<std::string, std::unique_ptr<CircuitBreaker>> circuit_breakers_;
 
-    void InitializeCurl();
-    void CleanupCurl();
-    std::string MakeRequest(const std::string& url);
-    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* userp);
-    ApiResponse ParseListResponse(const std::string& json_str);
+    template <typename T, typename Fn>
+    static std::shared_ptr<const T> DoShared(SingleFlight<T>& flights, const std::string& key,
+                                             const RequestControl& control, Fn&& fn);
+    HttpResponse MakeRequest(const std::string& endpoint, const std::string& url, const Validators& validators = {},
+                             bool stream_list = false, const RequestControl& control = {});
+    HttpResponse PerformRequest(const std::string& url, const Validators& validators, bool stream_list,
+                                const RequestControl& control);
+    void MakeRequestAsync(const std::string& endpoint, const std::string& url, const Validators& validators,
+                          bool stream_list, const RequestControl& control,
+                          std::function<void(std::exception_ptr, HttpResponse)> on_done);
+    void StartAttempt(std::shared_ptr<RetryingRequest> request);
+    void MakeHedgedRequestAsync(const std::string& url, const Validators& validators, const RequestControl& control,
+                                std::function<void(std::exception_ptr, HttpResponse)> on_done);
+    UpstreamTransport::RequestId SubmitTransfer(const std::string& url, const Validators& validators, bool stream_list,
+                                                const RequestControl& control,
+                                                std::function<void(std::exception_ptr, HttpResponse)> on_done);
+    UpstreamRequest MakeUpstreamRequest(const std::string& url, const Validators& validators,
+                                        const RequestControl& control) const;
+    static std::exception_ptr AttributeAbort(const RequestControl& control, std::exception_ptr error);
+    static bool IsPastDeadline(const RequestControl& control, UpstreamTransport::Clock::time_point when);
+    static void AttachListParser(HttpResponse& response);
+    static void CheckStatus(const HttpResponse& response);
+    static ApiResponse FinishListResponse(HttpResponse& response);
+    ItemResponse FinishItemResponse(HttpResponse& response) const;
+    void RecordTransfer(const std::string& endpoint, const HttpResponse& response);
+    static bool RecordAttempt(CircuitBreaker& breaker, std::exception_ptr error);
+    std::chrono::milliseconds GetRetryDelay(int retry) const;
+    std::optional<ApiResponse> ReadLocalList(const std::string& endpoint, const Validators& validators);
+    std::optional<ItemResponse> ReadLocalItem(const std::string& endpoint, const std::string& index,
+                                              const Validators& validators);
     void LoadValidEndpoints();
 };
 
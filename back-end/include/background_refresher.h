@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace dnd5e {
+
+// Spreads a TTL uniformly over [ttl * (1 - jitter), ttl * (1 + jitter)] so
+// entries cached together do not all expire together
+std::chrono::steady_clock::duration JitterTtl(std::chrono::steady_clock::duration ttl, double jitter);
+
+// Small worker pool for stale-while-revalidate refreshes. Each key is queued
+// or running at most once, so a stale entry read by many requests is still
+// refreshed by a single upstream call.
+class BackgroundRefresher {
+public:
+    struct Stats {
+        size_t scheduled = 0;
+        size_t completed = 0;
+        size_t failed = 0;
+        // Already queued or running, or the queue was full
+        size_t skipped = 0;
+    };
+
+    explicit BackgroundRefresher(size_t threads, size_t max_pending = 1024);
+    // Queued refreshes are dropped; running ones finish first
+    ~BackgroundRefresher();
+
+    BackgroundRefresher(const BackgroundRefresher&) = delete;
+    BackgroundRefresher& operator=(const BackgroundRefresher&) = delete;
+    BackgroundRefresher(BackgroundRefresher&&) = delete;
+    BackgroundRefresher& operator=(BackgroundRefresher&&) = delete;
+
+    // Returns false if the key is already pending or the queue is full.
+    // Exceptions from the task are logged and counted as failures
+    bool Schedule(const std::string& key, std::function<void()> task);
+    Stats GetStats() const;
+
+private:
+    size_t max_pending_;
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_;
+    std::deque<std::pair<std::string, std::function<void()>>> queue_;
+    // Queued and running keys
+    std::unordered_set<std::string> pending_keys_;
+    Stats stats_;
+    std::vector<std::thread> workers_;
+
+    void RunWorker();
+};
+
+} // namespace dnd5e
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include "item_cache.h"
+#include "search_engine.h"
+
+namespace dnd5e {
+
+struct CacheSnapshotStats {
+    size_t lists = 0;
+    size_t items = 0;
+    size_t bytes = 0;
+};
+
+// Writes every cached list and item to path (via a temporary file and a
+// rename, so readers never see a partial snapshot). Remaining freshness is
+// stored relative to the wall clock and carried over on load.
+CacheSnapshotStats WriteCacheSnapshot(const std::string& path, const std::string& base_url,
+                                      const SearchEngine& lists, const ItemCache* items);
+
+// Memory-maps a snapshot and seeds the caches from it. Returns nullopt if the
+// file does not exist; throws, restoring nothing, if it is corrupt, from
+// another format version or taken against a different upstream base URL.
+std::optional<CacheSnapshotStats> LoadCacheSnapshot(const std::string& path, const std::string& base_url,
+                                                    SearchEngine& lists, ItemCache* items);
+
+} // namespace dnd5e
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+
+#include "dnd5e.grpc.pb.h"
+#include "dnd5e_service.h"
+#include "response_cache.h"
+
+namespace dnd5e {
+
+using RawResponseServiceBase = Dnd5eService::WithRawCallbackMethod_GetList<
+    Dnd5eService::WithRawCallbackMethod_GetItem<Dnd5eService::Service>>;
+
+// What the server registers in front of Dnd5eServiceImpl when the response
+// cache is on. GetList and GetItem take and return raw ByteBuffers: a repeat
+// request is answered with the bytes serialized the first time, after
+// checking the list or item they came from is still the current fresh one,
+// without decoding the request or encoding a message. Misses are handed to
+// miss_threads workers, since they may wait on upstream and callback
+// handlers must not block; once miss_queue_capacity misses are waiting for
+// a worker, further ones fail fast with RESOURCE_EXHAUSTED. Other methods go
+// straight to the service. Item responses are only cached while the service
+// has an item cache.
+class CachedResponseService final : public RawResponseServiceBase {
+public:
+    CachedResponseService(Dnd5eServiceImpl& service, size_t capacity_bytes, size_t miss_threads,
+                          size_t miss_queue_capacity);
+    ~CachedResponseService() override;
+
+    CachedResponseService(const CachedResponseService&) = delete;
+    CachedResponseService& operator=(const CachedResponseService&) = delete;
+    CachedResponseService(CachedResponseService&&) = delete;
+    CachedResponseService& operator=(CachedResponseService&&) = delete;
+
+    grpc::ServerUnaryReactor* GetList(grpc::CallbackServerContext* context, const grpc::ByteBuffer* request,
+                                      grpc::ByteBuffer* response) override;
+    grpc::ServerUnaryReactor* GetItem(grpc::CallbackServerContext* context, const grpc::ByteBuffer* request,
+                                      grpc::ByteBuffer* response) override;
+    grpc::Status GetEndpoints(grpc::ServerContext* context, const GetEndpointsRequest* request, GetEndpointsResponse* response) override;
+    grpc::Status SearchItems(grpc::ServerContext* context, const SearchItemsRequest* request, SearchItemsResponse* response) override;
+    grpc::Status HealthCheck(grpc::ServerContext* context, const HealthCheckRequest* request, HealthCheckResponse* response) override;
+
+    ResponseCache::Stats GetStats() const;
+    // Misses turned away because the queue was full
+    size_t GetRejectedMisses() const;
+
+private:
+    Dnd5eServiceImpl& service_;
+    ResponseCache cache_;
+    std::mutex miss_mutex_;
+    std::condition_variable miss_cv_;
+    std::deque<std::function<void()>> misses_;
+    size_t miss_queue_capacity_;
+    std::atomic<size_t> rejected_misses_;
+    bool stopping_;
+    std::vector<std::thread> miss_workers_;
+
+    // Returns true with *response set when the cached response still holds
+    bool ServeCached(const std::string& key, grpc::ByteBuffer* response);
+    void ServeList(grpc::CallbackServerContext* context, std::string key, grpc::ByteBuffer* response,
+                   grpc::ServerUnaryReactor* reactor);
+    void ServeItem(grpc::CallbackServerContext* context, std::string key, grpc::ByteBuffer* response,
+                   grpc::ServerUnaryReactor* reactor);
+    // False, without running task, when the queue is full
+    bool RunMiss(std::function<void()> task);
+    void MissWorkerLoop();
+};
+
+} // namespace dnd5e
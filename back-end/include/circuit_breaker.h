@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace dnd5e {
+
+// Consecutive-failure circuit breaker. After failure_threshold failures in a
+// row the circuit opens and requests are rejected for open_duration; then a
+// single probe is let through. A successful probe closes the circuit, a
+// failed one re-opens it. A probe whose outcome is never reported simply
+// lets another probe through one open_duration later.
+class CircuitBreaker {
+public:
+    enum class State {
+        Closed,
+        Open,
+        HalfOpen
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    CircuitBreaker(size_t failure_threshold, std::chrono::milliseconds open_duration);
+
+    CircuitBreaker(const CircuitBreaker&) = delete;
+    CircuitBreaker& operator=(const CircuitBreaker&) = delete;
+    CircuitBreaker(CircuitBreaker&&) = delete;
+    CircuitBreaker& operator=(CircuitBreaker&&) = delete;
+
+    bool AllowRequest();
+    void RecordSuccess();
+    void RecordFailure();
+
+    State GetState() const;
+    size_t GetTripCount() const;
+    size_t GetRejectedCount() const;
+
+private:
+    size_t failure_threshold_;
+    std::chrono::milliseconds open_duration_;
+
+    mutable std::mutex mutex_;
+    State state_;
+    size_t consecutive_failures_;
+    Clock::time_point next_probe_at_;
+
+    std::atomic<size_t> trip_count_;
+    std::atomic<size_t> rejected_count_;
+
+    void Trip();
+};
+
+} // namespace dnd5e
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <curl/curl.h>
+
+namespace dnd5e {
+
+// Pool of reusable cURL easy handles. Every handle is attached to one CURLSH
+// share object so DNS lookups and TLS sessions are shared between threads,
+// while each idle handle keeps its own live connections for reuse.
+class CurlHandlePool {
+public:
+    using HandleInitializer = std::function<void(CURL*)>;
+
+    class Lease {
+    public:
+        Lease(CurlHandlePool* pool, CURL* handle);
+        ~Lease();
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+
+        CURL* get() const { return handle_; }
+
+    private:
+        CurlHandlePool* pool_;
+        CURL* handle_;
+    };
+
+    explicit CurlHandlePool(HandleInitializer initializer, size_t max_idle_handles = 64);
+    ~CurlHandlePool();
+
+    CurlHandlePool(const CurlHandlePool&) = delete;
+    CurlHandlePool& operator=(const CurlHandlePool&) = delete;
+    CurlHandlePool(CurlHandlePool&&) = delete;
+    CurlHandlePool& operator=(CurlHandlePool&&) = delete;
+
+    Lease Acquire();
+    CURLSH* GetShare() const;
+    size_t GetIdleCount() const;
+
+private:
+    HandleInitializer initializer_;
+    size_t max_idle_handles_;
+    CURLSH* share_;
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> share_locks_;
+    mutable std::mutex mutex_;
+    std::vector<CURL*> idle_handles_;
+
+    CURL* CreateHandle();
+    void Release(CURL* handle);
+    static void LockCallback(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void UnlockCallback(CURL* handle, curl_lock_data data, void* userptr);
+};
+
+} // namespace dnd5e
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <curl/curl.h>
+
+namespace dnd5e {
+
+// Single event-loop thread driving a curl_multi handle. Transfers are
+// submitted as configured easy handles; the completion callback runs on the
+// loop thread once the handle has been removed from the multi handle.
+// Timers scheduled on the loop also fire on that thread; any still pending at
+// destruction run then, so the requests they drive still complete.
+class CurlMultiLoop {
+public:
+    using Completion = std::function<void(CURL* handle, CURLcode result)>;
+    using Clock = std::chrono::steady_clock;
+
+    // Zero leaves the corresponding libcurl default in place
+    explicit CurlMultiLoop(long max_host_connections = 0, long max_concurrent_streams = 0);
+    ~CurlMultiLoop();
+
+    CurlMultiLoop(const CurlMultiLoop&) = delete;
+    CurlMultiLoop& operator=(const CurlMultiLoop&) = delete;
+    CurlMultiLoop(CurlMultiLoop&&) = delete;
+    CurlMultiLoop& operator=(CurlMultiLoop&&) = delete;
+
+    void Submit(CURL* handle, Completion on_complete);
+    void Schedule(Clock::time_point when, std::function<void()> fn);
+    // Loop thread only (completion or timer callbacks). Completes the transfer
+    // with CURLE_ABORTED_BY_CALLBACK; a handle that already finished is ignored.
+    void Cancel(CURL* handle);
+    size_t GetActiveCount() const;
+
+private:
+    CURLM* multi_;
+    std::thread thread_;
+    std::atomic<bool> stopping_;
+    std::atomic<size_t> active_count_;
+    mutable std::mutex mutex_;
+    std::vector<std::pair<CURL*, Completion>> pending_;
+    std::unordered_map<CURL*, Completion> active_;
+    std::multimap<Clock::time_point, std::function<void()>> timers_;
+
+    void Run();
+    void AddPending();
+    void RunDueTimers();
+    int GetPollTimeout() const;
+    void DrainCompleted();
+    void AbortAll();
+};
+
+} // namespace dnd5e
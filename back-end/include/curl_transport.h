@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <curl/curl.h>
+#include "curl_handle_pool.h"
+#include "curl_multi_loop.h"
+#include "dns_pinner.h"
+#include "upstream_transport.h"
+
+namespace dnd5e {
+
+struct CurlTransportOptions {
+    // Multiplex all requests over one HTTP/2 connection per host
+    bool http2 = false;
+    long http2_max_streams = 100;
+    long connect_timeout_ms = 5000;
+    // Resolve this URL's host once and re-resolve in the background instead
+    // of on the request path; empty leaves DNS to libcurl
+    std::string pin_dns_url;
+    long dns_refresh_ms = 60000;
+};
+
+// libcurl transport: blocking requests run on pooled easy handles in the
+// caller's thread, async ones on a shared curl_multi event loop.
+class CurlTransport final : public UpstreamTransport {
+public:
+    explicit CurlTransport(const CurlTransportOptions& options = CurlTransportOptions());
+    ~CurlTransport() override;
+
+    CurlTransport(const CurlTransport&) = delete;
+    CurlTransport& operator=(const CurlTransport&) = delete;
+    CurlTransport(CurlTransport&&) = delete;
+    CurlTransport& operator=(CurlTransport&&) = delete;
+
+    const char* GetName() const override;
+    void Perform(const UpstreamRequest& request, UpstreamResponse& response) override;
+    RequestId Submit(const UpstreamRequest& request, std::shared_ptr<UpstreamResponse> response,
+                     Completion on_done) override;
+    void Cancel(RequestId id) override;
+    void Schedule(Clock::time_point when, std::function<void()> fn) override;
+
+private:
+    CurlTransportOptions options_;
+    std::unique_ptr<CurlHandlePool> handle_pool_;
+    std::unique_ptr<CurlMultiLoop> multi_loop_;
+    std::unique_ptr<DnsPinner> dns_pinner_;
+    std::atomic<RequestId> next_request_id_;
+    std::mutex in_flight_mutex_;
+    // Ids are never reused, unlike pooled handles, so a late Cancel is harmless
+    std::unordered_map<RequestId, CURL*> in_flight_;
+
+    void ConfigureHandle(CURL* handle) const;
+    static curl_slist* PrepareTransfer(CURL* handle, const UpstreamRequest& request, UpstreamResponse* response,
+                                       curl_slist* resolve);
+    static void FinishTransfer(CURL* handle, curl_slist* headers);
+    static void CheckResult(CURL* handle, CURLcode result, UpstreamResponse* response);
+    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, UpstreamResponse* response);
+    static int ProgressCallback(void* control, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
+    static size_t HeaderCallback(char* buffer, size_t size, size_t nitems, UpstreamResponse* response);
+};
+
+} // namespace dnd5e
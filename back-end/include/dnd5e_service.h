@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -7,13 +9,47 @@
 
 #include "dnd5e.grpc.pb.h"
 #include "api_client.h"
+#include "background_refresher.h"
+#include "cache_snapshot.h"
+#include "item_cache.h"
+#include "l2_cache.h"
+#include "negative_cache.h"
 #include "search_engine.h"
 
 namespace dnd5e {
 
+struct ServiceOptions {
+    // Byte budget for serialized GetItem responses; 0 disables the item cache
+    size_t item_cache_bytes = 64 * 1024 * 1024;
+    CachePolicy item_cache_policy = CachePolicy::TinyLfu;
+    // Cached lists and items stay fresh for cache_ttl +/- cache_ttl_jitter (a
+    // fraction of it). Expired entries are served stale while refresh_threads
+    // workers refetch them; with 0 threads the next reader refetches inline
+    std::chrono::seconds cache_ttl{3600};
+    double cache_ttl_jitter = 0.1;
+    size_t refresh_threads = 2;
+    // Items upstream answered 404 for are answered NOT_FOUND locally for
+    // negative_ttl; 0 disables
+    std::chrono::seconds negative_ttl{60};
+    size_t negative_cache_entries = 10000;
+    // Finished SearchItems results kept per normalized query; 0 disables
+    size_t search_cache_entries = 1024;
+};
+
+// How GetItem answered NOT_FOUND
+struct NotFoundStats {
+    // Index missing from the endpoint's fresh cached list; upstream not asked
+    size_t rejected_by_list = 0;
+    // Recent upstream 404 for the same item
+    size_t negative_hits = 0;
+    size_t upstream_not_found = 0;
+};
+
 class Dnd5eServiceImpl final : public Dnd5eService::Service {
 public:
-    explicit Dnd5eServiceImpl(std::shared_ptr<ApiClient> api_client);
+    // l2_cache, if set, is consulted on list and item-cache misses before upstream
+    explicit Dnd5eServiceImpl(std::shared_ptr<ApiClient> api_client, const ServiceOptions& options = ServiceOptions(),
+                              std::shared_ptr<L2Cache> l2_cache = nullptr);
     ~Dnd5eServiceImpl() = default;
 
     Dnd5eServiceImpl(const Dnd5eServiceImpl&) = delete;
@@ -27,10 +63,52 @@ public:
     grpc::Status SearchItems(grpc::ServerContext* context, const SearchItemsRequest* request, SearchItemsResponse* response) override;
     grpc::Status HealthCheck(grpc::ServerContext* context, const HealthCheckRequest* request, HealthCheckResponse* response) override;
 
+    // GetList / GetItem for any server context, including the callback API's.
+    // source, if set, receives what the response was built from, for
+    // IsCurrentList / IsCurrentItem to check later
+    grpc::Status ServeList(grpc::ServerContextBase* context, const GetListRequest* request, GetListResponse* response,
+                           std::shared_ptr<const ListSnapshot>* source);
+    grpc::Status ServeItem(grpc::ServerContextBase* context, const GetItemRequest* request, GetItemResponse* response,
+                           ItemCache::Value* source);
+    // True while source is still what a GetList / GetItem for it would be
+    // built from without a refresh, so a response built from it still holds.
+    // Neither changes what the caches hold or count
+    bool IsCurrentList(const std::string& endpoint, const ListSnapshot* source) const;
+    bool IsCurrentItem(const std::string& endpoint, const std::string& index, const ApiClient::ItemResponse* source) const;
+
+    // Null when the item cache is disabled
+    const ItemCache* GetItemCache() const;
+    const SearchEngine& GetSearchEngine() const;
+    // Null without refresh threads
+    const BackgroundRefresher* GetRefresher() const;
+    // Null without an L2 cache
+    const L2Cache* GetL2Cache() const;
+    NotFoundStats GetNotFoundStats() const;
+    // See WriteCacheSnapshot / LoadCacheSnapshot
+    CacheSnapshotStats SaveCacheSnapshot(const std::string& path) const;
+    std::optional<CacheSnapshotStats> LoadCacheSnapshot(const std::string& path);
+
 private:
     std::shared_ptr<ApiClient> api_client_;
+    ServiceOptions options_;
+    std::shared_ptr<L2Cache> l2_cache_;
     std::unique_ptr<SearchEngine> search_engine_;
+    std::unique_ptr<ItemCache> item_cache_;
+    std::unique_ptr<NegativeCache> negative_cache_;
+    std::atomic<size_t> rejected_by_list_;
+    std::atomic<size_t> negative_hits_;
+    std::atomic<size_t> upstream_not_found_;
+    // Declared last so its workers stop before the caches they refresh go away
+    std::unique_ptr<BackgroundRefresher> refresher_;
     bool IsValidEndpoint(const std::string& endpoint) const;
+    // Copies an item from the L2 cache into the item cache; empty on an L2 miss
+    ItemCache::Lookup LoadItemFromL2(const std::string& endpoint, const std::string& index);
+    // Upstream says the item does not exist: drop any cached copy and remember the 404
+    void RecordNotFound(const std::string& endpoint, const std::string& index);
+    // Revalidates a cached item; returns the new value, or current if unchanged
+    ItemCache::Value RefreshItem(const std::string& endpoint, const std::string& index,
+                                 const ItemCache::Value& current, const RequestControl& control);
+    grpc::Status UpstreamErrorStatus(const UpstreamError& error, const std::string& prefix) const;
     ApiItem ConvertToProtoItem(const ApiClient::ApiItem& item, const std::string& endpoint) const;
     std::vector<std::string> GetAllEndpoints() const;
 };
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+
+namespace dnd5e {
+
+// Resolves one upstream host up front and hands libcurl the addresses via
+// CURLOPT_RESOLVE, so requests never wait on DNS. A background thread
+// re-resolves on a fixed interval; lookups that fail keep the last good set.
+class DnsPinner {
+public:
+    using ResolveList = std::shared_ptr<curl_slist>;
+
+    DnsPinner(const std::string& url, std::chrono::milliseconds refresh_interval);
+    ~DnsPinner();
+
+    DnsPinner(const DnsPinner&) = delete;
+    DnsPinner& operator=(const DnsPinner&) = delete;
+    DnsPinner(DnsPinner&&) = delete;
+    DnsPinner& operator=(DnsPinner&&) = delete;
+
+    // Null until the first successful lookup; keep it alive for the whole transfer
+    ResolveList GetResolveList() const;
+    std::vector<std::string> GetAddresses() const;
+    size_t GetRefreshCount() const;
+
+private:
+    std::string host_;
+    long port_;
+    std::chrono::milliseconds refresh_interval_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable stop_cv_;
+    bool stopping_;
+    std::vector<std::string> addresses_;
+    ResolveList resolve_list_;
+    size_t refresh_count_;
+    std::thread refresher_;
+
+    void Refresh();
+    void RunRefresher();
+    std::vector<std::string> Resolve() const;
+};
+
+} // namespace dnd5e
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "upstream_transport.h"
+
+namespace dnd5e {
+
+struct FakeTransportOptions {
+    // SRD dump in the local data layout (<endpoint>.json, <endpoint>/<index>.json)
+    std::string data_dir;
+    // Stripped from request URLs to find the entry, e.g. the ApiClient base URL
+    std::string base_url;
+    // Log-normal latency around the median, plus an occasional slow tail
+    double latency_median_ms = 20.0;
+    double latency_sigma = 0.5;
+    double tail_probability = 0.0;
+    double tail_latency_ms = 500.0;
+    // Fraction of requests answered with 503 / failed as a dropped connection
+    double error_rate = 0.0;
+    double drop_rate = 0.0;
+    // Bodies are inflated this many times to model larger payloads
+    size_t payload_scale = 1;
+    // Bodies are handed to the response in chunks of this size, like a socket read
+    size_t chunk_size = 16384;
+    uint64_t seed = 42;
+};
+
+// In-process upstream serving a local SRD dump with synthetic latency and
+// failures. Everything is loaded up front so runs are repeatable and never
+// touch the network.
+class FakeTransport final : public UpstreamTransport {
+public:
+    explicit FakeTransport(const FakeTransportOptions& options);
+    ~FakeTransport() override;
+
+    FakeTransport(const FakeTransport&) = delete;
+    FakeTransport& operator=(const FakeTransport&) = delete;
+    FakeTransport(FakeTransport&&) = delete;
+    FakeTransport& operator=(FakeTransport&&) = delete;
+
+    const char* GetName() const override;
+    void Perform(const UpstreamRequest& request, UpstreamResponse& response) override;
+    RequestId Submit(const UpstreamRequest& request, std::shared_ptr<UpstreamResponse> response,
+                     Completion on_done) override;
+    void Cancel(RequestId id) override;
+    void Schedule(Clock::time_point when, std::function<void()> fn) override;
+
+    size_t GetEntryCount() const;
+
+private:
+    struct Entry {
+        std::string body;
+        std::string etag;
+    };
+
+    enum class Outcome {
+        Ok,
+        NotModified,
+        NotFound,
+        ServerError,
+        Dropped,
+        TimedOut
+    };
+
+    struct Reply {
+        Outcome outcome;
+        const Entry* entry;
+        std::chrono::microseconds delay;
+    };
+
+    FakeTransportOptions options_;
+    // Keyed by the path below base_url, e.g. "spells" or "spells/fireball"
+    std::unordered_map<std::string, Entry> entries_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_;
+    std::mt19937_64 generator_;
+    RequestId next_request_id_;
+    std::multimap<Clock::time_point, std::function<void()>> timers_;
+    // Submitted requests that have neither completed nor been cancelled
+    std::unordered_map<RequestId, Completion> pending_;
+    std::thread worker_;
+
+    void LoadEntries();
+    std::string ScalePayload(const std::string& key, const std::string& body) const;
+    Reply Plan(const UpstreamRequest& request);
+    void Deliver(const Reply& reply, UpstreamResponse& response) const;
+    // Like libcurl's progress callback: abort a pending request once its caller is gone
+    void PollCancellation(RequestId id, RequestControl control);
+    void Run();
+};
+
+} // namespace dnd5e
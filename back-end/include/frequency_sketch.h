@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dnd5e {
+
+// Approximate access counts for TinyLFU admission: a count-min sketch of
+// four rows of 4-bit counters, 16 to a word. Every sample_size increments
+// all counters are halved so past popularity fades. Not thread-safe.
+class FrequencySketch {
+public:
+    // width counters per row, rounded up to a power of two
+    explicit FrequencySketch(size_t width);
+
+    void Increment(uint64_t hash);
+    // Saturates at 15
+    uint32_t Estimate(uint64_t hash) const;
+
+private:
+    static constexpr size_t kRows = 4;
+
+    std::vector<uint64_t> table_;
+    size_t words_per_row_;
+    size_t counter_mask_;
+    size_t additions_;
+    size_t sample_size_;
+
+    size_t CounterIndex(uint64_t hash, size_t row) const;
+    void Halve();
+};
+
+} // namespace dnd5e
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace dnd5e {
+
+// Decides when a slow upstream request deserves a duplicate. The hedge delay
+// tracks a percentile of recent latencies; a token budget caps hedges to a
+// fraction of primary requests so a slow upstream is not hit twice as hard.
+class HedgePolicy {
+public:
+    struct Stats {
+        size_t primary_requests = 0;
+        size_t hedges_sent = 0;
+        size_t hedges_won = 0;
+        size_t hedges_throttled = 0;
+    };
+
+    HedgePolicy(double percentile, double budget_ratio, size_t window_size = 1024, size_t min_samples = 32);
+
+    HedgePolicy(const HedgePolicy&) = delete;
+    HedgePolicy& operator=(const HedgePolicy&) = delete;
+    HedgePolicy(HedgePolicy&&) = delete;
+    HedgePolicy& operator=(HedgePolicy&&) = delete;
+
+    // Empty until enough samples have been seen to trust the percentile
+    std::optional<std::chrono::microseconds> GetHedgeDelay() const;
+
+    void RecordPrimary();
+    void RecordLatency(std::chrono::microseconds latency);
+    // Consumes one budget token; false means the hedge must not be sent
+    bool TryAcquireHedge();
+    void RecordHedgeWin();
+
+    Stats GetStats() const;
+
+private:
+    static constexpr double kMaxTokens = 10.0;
+
+    double percentile_;
+    double budget_ratio_;
+    size_t min_samples_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::chrono::microseconds> samples_;
+    size_t next_sample_;
+    size_t sample_count_;
+    std::chrono::microseconds hedge_delay_;
+    double tokens_;
+
+    std::atomic<size_t> primary_requests_;
+    std::atomic<size_t> hedges_sent_;
+    std::atomic<size_t> hedges_won_;
+    std::atomic<size_t> hedges_throttled_;
+
+    void RecomputeDelay();
+};
+
+} // namespace dnd5e
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "api_client.h"
+#include "frequency_sketch.h"
+
+namespace dnd5e {
+
+// Byte-bounded LRU for upstream item bodies, keyed by "<endpoint>/<index>".
+// Keys are spread over independently locked shards so concurrent lookups of
+// different items never contend; each shard evicts its own least recently
+// used entries to stay within its share of the budget. Entries past their
+// freshness deadline are still returned, flagged stale, for the caller to
+// refresh.
+//
+// With TinyLfu (W-TinyLFU) each shard keeps a 1% LRU window in front of a
+// segmented main area: probation, and protected for entries hit again.
+// Entries leaving the window only enter main if a frequency sketch says they
+// are used more often than the entries they would evict, so one-off scans
+// cannot flush the hot set.
+enum class CachePolicy {
+    Lru,
+    TinyLfu,
+};
+
+class ItemCache {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Value = std::shared_ptr<const ApiClient::ItemResponse>;
+
+    struct Lookup {
+        // Null on a miss
+        Value value;
+        bool stale = false;
+    };
+
+    struct Exported {
+        std::string key;
+        Value value;
+        Clock::time_point fresh_until;
+    };
+
+    struct Stats {
+        size_t fresh_hits = 0;
+        size_t stale_hits = 0;
+        size_t misses = 0;
+        size_t insertions = 0;
+        size_t evictions = 0;
+        // Left the window but lost the frequency contest (TinyLfu only)
+        size_t rejections = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t capacity_bytes = 0;
+    };
+
+    explicit ItemCache(size_t capacity_bytes, size_t shard_count = 16, CachePolicy policy = CachePolicy::TinyLfu);
+    ~ItemCache() = default;
+
+    ItemCache(const ItemCache&) = delete;
+    ItemCache& operator=(const ItemCache&) = delete;
+    ItemCache(ItemCache&&) = delete;
+    ItemCache& operator=(ItemCache&&) = delete;
+
+    static std::string MakeKey(const std::string& endpoint, const std::string& index);
+
+    Lookup Get(const std::string& key);
+    // Get without side effects: recency, frequency and hit counts are left alone
+    Lookup Peek(const std::string& key) const;
+    // Items larger than a shard's budget are not cached
+    void Put(const std::string& key, Value value, Clock::time_point fresh_until);
+    // Restarts the freshness window of an entry revalidated upstream (304)
+    void Touch(const std::string& key, Clock::time_point fresh_until);
+    void Erase(const std::string& key);
+    void Clear();
+    // Every entry, shard by shard: probation, protected, then window, each
+    // least recently used first
+    std::vector<Exported> Export() const;
+    Stats GetStats() const;
+
+private:
+    enum class Segment {
+        Window,
+        Probation,
+        Protected,
+    };
+
+    struct Entry {
+        std::string key;
+        size_t hash;
+        Value value;
+        size_t charge;
+        Clock::time_point fresh_until;
+        Segment segment;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    // With Lru everything lives in the window
+    struct Shard {
+        explicit Shard(size_t sketch_width) : sketch(sketch_width) {}
+
+        mutable std::mutex mutex;
+        // Fronts are most recently used
+        EntryList window;
+        EntryList probation;
+        EntryList protected_main;
+        std::unordered_map<std::string, EntryList::iterator> index;
+        size_t window_bytes = 0;
+        size_t probation_bytes = 0;
+        size_t protected_bytes = 0;
+        FrequencySketch sketch;
+        size_t fresh_hits = 0;
+        size_t stale_hits = 0;
+        size_t misses = 0;
+        size_t insertions = 0;
+        size_t evictions = 0;
+        size_t rejections = 0;
+    };
+
+    size_t capacity_bytes_;
+    size_t shard_capacity_;
+    CachePolicy policy_;
+    size_t window_capacity_;
+    size_t main_capacity_;
+    size_t protected_capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    Shard& GetShard(size_t hash) const;
+    static EntryList& GetList(Shard& shard, Segment segment);
+    static size_t& GetBytes(Shard& shard, Segment segment);
+    // Moves an entry to the front of a segment
+    static void MoveTo(Shard& shard, EntryList::iterator entry, Segment segment);
+    static void Remove(Shard& shard, EntryList::iterator entry);
+    // Restores every segment to its budget after an insert or resize
+    void Rebalance(Shard& shard);
+    // Moves the window's oldest entry into probation if it beats the victims
+    void Admit(Shard& shard, EntryList::iterator candidate);
+    static size_t GetCharge(const std::string& key, const ApiClient::ItemResponse& item);
+};
+
+} // namespace dnd5e
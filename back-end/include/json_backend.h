@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dnd5e {
+
+struct ItemFields {
+    std::string name;
+    std::string url;
+};
+
+// Pulls the handful of top-level fields the service needs out of an item
+// body. The body itself is never re-serialized; callers pass it through.
+class JsonBackend {
+public:
+    virtual ~JsonBackend() = default;
+
+    virtual const char* GetName() const = 0;
+    virtual ItemFields ExtractItemFields(const std::string& body) const = 0;
+};
+
+// Empty name selects the fastest backend compiled in
+std::unique_ptr<JsonBackend> CreateJsonBackend(const std::string& name = "");
+std::vector<std::string> GetAvailableJsonBackends();
+
+} // namespace dnd5e
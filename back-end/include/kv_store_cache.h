@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "l2_cache.h"
+
+namespace dnd5e {
+
+struct KvStoreOptions {
+    std::string path;
+    // Address space reserved for the log file. When an append would cross it
+    // the live records are compacted into a fresh file; if they still do not
+    // fit, new writes are dropped
+    size_t max_bytes = size_t{1} << 30;
+    // Pending writes; a power of two. Writes beyond it are dropped
+    size_t queue_capacity = 4096;
+    // Records appended per batch and how long the writer sleeps when idle
+    size_t batch_size = 64;
+    long flush_interval_ms = 50;
+};
+
+// Embedded L2 cache for single-node deployments: an append-only log keyed by
+// (endpoint, index) and memory-mapped read-only, so lookups are a hash probe
+// plus one copy out of the page cache. The index is rebuilt by scanning the
+// log at open; a torn tail left by a crash is cut off. Writes are appended by
+// one background writer, as with the MariaDB cache.
+std::unique_ptr<L2Cache> OpenKvStoreCache(const KvStoreOptions& options);
+
+} // namespace dnd5e
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "api_client.h"
+
+namespace dnd5e {
+
+struct ListSnapshot;
+struct SearchHit;
+
+struct L2CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    // Failed reads count as misses too
+    size_t errors = 0;
+    size_t writes_queued = 0;
+    size_t writes_stored = 0;
+    // Queue full or store unavailable
+    size_t writes_dropped = 0;
+    // Log rewrites that reclaimed overwritten records (KV store only)
+    size_t compactions = 0;
+};
+
+// Second cache tier behind the in-memory caches: slower, but it survives
+// restarts and can be shared. Reads block; writes never do.
+class L2Cache {
+public:
+    using SystemClock = std::chrono::system_clock;
+
+    struct StoredItem {
+        ApiClient::ItemResponse item;
+        SystemClock::time_point stored_at;
+    };
+
+    struct StoredList {
+        std::vector<ApiClient::ApiItem> items;
+        ApiClient::Validators validators;
+        SystemClock::time_point stored_at;
+    };
+
+    virtual ~L2Cache() = default;
+
+    // Maps a stored_at onto the in-memory caches' clock: what is left of ttl
+    // after the time the entry has already spent in the store
+    static std::chrono::steady_clock::time_point FreshUntil(SystemClock::time_point stored_at,
+                                                            std::chrono::steady_clock::duration ttl) {
+        auto age = std::max(SystemClock::duration::zero(), SystemClock::now() - stored_at);
+        return std::chrono::steady_clock::now() + ttl - std::chrono::duration_cast<std::chrono::steady_clock::duration>(age);
+    }
+
+    virtual const char* GetName() const = 0;
+    // Misses and store failures both return nullopt
+    virtual std::optional<StoredItem> GetItem(const std::string& endpoint, const std::string& index) = 0;
+    virtual std::optional<StoredList> GetList(const std::string& endpoint) = 0;
+    // Queued for a background writer; may be dropped under pressure
+    virtual void PutItem(const std::string& endpoint, const std::string& index,
+                         std::shared_ptr<const ApiClient::ItemResponse> item) = 0;
+    virtual void PutList(const std::string& endpoint, std::shared_ptr<const ListSnapshot> list,
+                         const ApiClient::Validators& validators) = 0;
+    // Finished searches keyed as in SearchEngine::CachedSearch; null unless
+    // stored for exactly this dataset_version. Caches that do not keep
+    // searches always miss and drop writes
+    virtual std::shared_ptr<const std::vector<SearchHit>> GetSearch(const std::string& query,
+                                                                   const std::vector<std::string>& endpoints,
+                                                                   int max_results, uint64_t dataset_version) {
+        (void)query;
+        (void)endpoints;
+        (void)max_results;
+        (void)dataset_version;
+        return nullptr;
+    }
+    virtual void PutSearch(const std::string& query, const std::vector<std::string>& endpoints, int max_results,
+                           uint64_t dataset_version, std::shared_ptr<const std::vector<SearchHit>> hits) {
+        (void)query;
+        (void)endpoints;
+        (void)max_results;
+        (void)dataset_version;
+        (void)hits;
+    }
+    virtual L2CacheStats GetStats() const = 0;
+};
+
+} // namespace dnd5e
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "api_client.h"
+
+namespace dnd5e {
+
+// Incremental parser for upstream list bodies ({"count": N, "results": [...]}).
+// Bytes can be fed in arbitrary chunks straight from the transfer; items are
+// built as soon as their object closes, without a DOM or a buffered body.
+class ListStreamParser {
+public:
+    ListStreamParser();
+
+    ListStreamParser(const ListStreamParser&) = delete;
+    ListStreamParser& operator=(const ListStreamParser&) = delete;
+    ListStreamParser(ListStreamParser&&) = delete;
+    ListStreamParser& operator=(ListStreamParser&&) = delete;
+
+    void Feed(const char* data, size_t size);
+    ApiClient::ApiResponse Finish();
+
+private:
+    enum class LexState {
+        Value,
+        String,
+        StringEscape,
+        StringUnicode,
+        Number,
+        Literal
+    };
+
+    enum class Expect {
+        KeyOrEnd,
+        Key,
+        Colon,
+        Value,
+        ValueOrEnd,
+        CommaOrEnd
+    };
+
+    struct Frame {
+        bool is_object;
+        Expect expect;
+    };
+
+    LexState lex_state_;
+    std::string token_;
+    uint32_t unicode_value_;
+    int unicode_digits_;
+    uint32_t pending_high_surrogate_;
+    std::vector<Frame> stack_;
+    bool done_;
+    size_t offset_;
+
+    // Key most recently read at the top level and inside the current item
+    std::string top_level_key_;
+    std::string item_key_;
+    bool in_results_;
+    ApiClient::ApiItem current_item_;
+    ApiClient::ApiResponse response_;
+
+    void ProcessChar(char c);
+    void BeginValue(bool is_object);
+    void EndValue();
+    void OnString(std::string value);
+    void OnScalar(const std::string& text, bool is_number);
+    void OnBeginContainer(bool is_object);
+    void OnEndContainer(bool is_object);
+    void OnComma();
+    void OnColon();
+    void AppendCodePoint(uint32_t code_point);
+    [[noreturn]] void Fail(const std::string& reason) const;
+};
+
+} // namespace dnd5e
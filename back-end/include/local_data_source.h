@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dnd5e {
+
+// One stored upstream response body. version changes whenever the body
+// may have changed and is handed out as the ETag for revalidation.
+struct LocalEntry {
+    std::string body;
+    std::string version;
+};
+
+// Read-only SRD dump that stands in for the upstream API. Lists and items
+// are stored as the exact JSON bodies upstream would have returned.
+class LocalDataSource {
+public:
+    virtual ~LocalDataSource() = default;
+
+    virtual const std::string& GetPath() const = 0;
+    virtual std::optional<LocalEntry> ReadList(const std::string& endpoint) const = 0;
+    virtual std::optional<LocalEntry> ReadItem(const std::string& endpoint, const std::string& index) const = 0;
+};
+
+// True if name can be used as a single path component under the data root
+bool IsSafeDataName(const std::string& name);
+
+// <dir>/<endpoint>.json holds a list, <dir>/<endpoint>/<index>.json an item.
+// A missing list file is synthesized from the endpoint's item files.
+std::unique_ptr<LocalDataSource> OpenDataDirectory(const std::string& path);
+
+// Single file produced by WriteDataPack, memory-mapped for the process lifetime
+std::unique_ptr<LocalDataSource> OpenDataPack(const std::string& path);
+
+// Packs every list and item found for the given endpoints; returns the entry count
+size_t WriteDataPack(const std::string& data_dir, const std::string& pack_path,
+                     const std::vector<std::string>& endpoints);
+
+} // namespace dnd5e
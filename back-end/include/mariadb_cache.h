@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "l2_cache.h"
+
+namespace dnd5e {
+
+struct MariaDbOptions {
+    std::string host = "127.0.0.1";
+    unsigned int port = 3306;
+    std::string database = "dnd5e";
+    std::string user = "dnduser";
+    std::string password;
+    // A slow or dead database must not hold requests up for long
+    unsigned int connect_timeout_s = 2;
+    unsigned int io_timeout_s = 1;
+    size_t max_idle_connections = 8;
+    // Pending writes; a power of two. Writes beyond it are dropped
+    size_t queue_capacity = 4096;
+    // Rows per INSERT and how long the writer sleeps when the queue is empty
+    size_t batch_size = 64;
+    long flush_interval_ms = 50;
+};
+
+// False when built without the MariaDB client library
+bool IsMariaDbAvailable();
+
+// L2 cache on the api_cache / api_list_cache tables from sql/init. Reads go
+// straight to the database; writes are queued lock-free and upserted in
+// batches by one background writer. Database failures read as misses and
+// trip a circuit breaker so an outage costs requests nothing after a few
+// failures.
+std::unique_ptr<L2Cache> CreateMariaDbCache(const MariaDbOptions& options);
+
+} // namespace dnd5e
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "api_client.h"
+
+namespace dnd5e {
+
+struct MirrorOptions {
+    // Written in the local data layout, loadable with --data-dir
+    std::string output_dir;
+    // Empty mirrors every endpoint the client knows
+    std::vector<std::string> endpoints;
+    size_t concurrency = 8;
+    // Token bucket shared by all workers
+    double requests_per_second = 20.0;
+    double burst = 10.0;
+};
+
+// Copies every list and item of the SRD into a local directory. Files are
+// written atomically, so an interrupted run is resumed by running it again:
+// anything already on disk is skipped.
+class MirrorCrawler {
+public:
+    struct Stats {
+        size_t lists_fetched = 0;
+        size_t lists_skipped = 0;
+        size_t items_fetched = 0;
+        size_t items_skipped = 0;
+        size_t failures = 0;
+        bool stopped = false;
+    };
+
+    MirrorCrawler(std::shared_ptr<ApiClient> api_client, const MirrorOptions& options);
+    ~MirrorCrawler() = default;
+
+    MirrorCrawler(const MirrorCrawler&) = delete;
+    MirrorCrawler& operator=(const MirrorCrawler&) = delete;
+    MirrorCrawler(MirrorCrawler&&) = delete;
+    MirrorCrawler& operator=(MirrorCrawler&&) = delete;
+
+    // Blocks until everything is mirrored or Stop() is called
+    Stats Run();
+    // Async-signal-safe; workers finish their current request and exit
+    void Stop();
+
+private:
+    struct Task {
+        std::string endpoint;
+        // Empty for the endpoint's list
+        std::string index;
+    };
+
+    std::shared_ptr<ApiClient> api_client_;
+    MirrorOptions options_;
+    std::atomic<bool> stop_requested_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<Task> queue_;
+    size_t active_tasks_;
+
+    std::mutex bucket_mutex_;
+    double tokens_;
+    std::chrono::steady_clock::time_point last_refill_;
+
+    std::mutex stats_mutex_;
+    Stats stats_;
+
+    void RunWorker();
+    void Enqueue(std::vector<Task> tasks);
+    void MirrorList(const std::string& endpoint);
+    void MirrorItem(const std::string& endpoint, const std::string& index);
+    bool AcquireToken();
+    std::string GetListPath(const std::string& endpoint) const;
+    std::string GetItemPath(const std::string& endpoint, const std::string& index) const;
+    static void WriteFileAtomically(const std::string& path, const std::string& contents);
+};
+
+} // namespace dnd5e
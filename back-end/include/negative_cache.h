@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace dnd5e {
+
+// Remembers keys upstream answered 404 for, so repeats are answered locally
+// until the TTL runs out. Bounded: a full cache first sweeps expired keys and,
+// if that frees nothing, starts over empty.
+class NegativeCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    NegativeCache(Clock::duration ttl, size_t max_entries);
+    ~NegativeCache() = default;
+
+    NegativeCache(const NegativeCache&) = delete;
+    NegativeCache& operator=(const NegativeCache&) = delete;
+    NegativeCache(NegativeCache&&) = delete;
+    NegativeCache& operator=(NegativeCache&&) = delete;
+
+    bool Contains(const std::string& key);
+    void Add(const std::string& key);
+    size_t GetSize() const;
+
+private:
+    Clock::duration ttl_;
+    size_t max_entries_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Clock::time_point> expires_at_;
+};
+
+} // namespace dnd5e
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <grpcpp/support/byte_buffer.h>
+
+namespace dnd5e {
+
+// Byte-bounded LRU of fully serialized RPC responses, keyed by the method and
+// the request's wire bytes. Responses are kept as grpc::ByteBuffers, so
+// handing one out copies slice references, not bytes. The cache does not
+// know when a response goes out of date: each entry carries what it was
+// built from, for the caller to check before serving it.
+class ResponseCache {
+public:
+    struct Entry {
+        grpc::ByteBuffer response;
+        std::string endpoint;
+        // Empty for list responses
+        std::string index;
+        // Held so the address stays unique while the entry lives
+        std::shared_ptr<const void> source;
+    };
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        // Found but built from data that has since changed or expired
+        size_t invalidated = 0;
+        size_t insertions = 0;
+        size_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t capacity_bytes = 0;
+    };
+
+    explicit ResponseCache(size_t capacity_bytes, size_t shard_count = 8);
+    ~ResponseCache() = default;
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+    ResponseCache(ResponseCache&&) = delete;
+    ResponseCache& operator=(ResponseCache&&) = delete;
+
+    // Counts a miss when absent; the caller reports the outcome of its check
+    std::optional<Entry> Get(const std::string& key);
+    void Put(const std::string& key, Entry entry);
+    void RecordHit();
+    // Drops an entry that failed the caller's check
+    void RecordInvalidated(const std::string& key);
+    Stats GetStats() const;
+
+private:
+    struct Node {
+        std::string key;
+        Entry entry;
+        size_t charge;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Node> lru;
+        std::unordered_map<std::string, std::list<Node>::iterator> index;
+        size_t bytes = 0;
+        size_t insertions = 0;
+        size_t evictions = 0;
+    };
+
+    size_t capacity_bytes_;
+    size_t shard_capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<size_t> hits_;
+    std::atomic<size_t> misses_;
+    std::atomic<size_t> invalidated_;
+
+    Shard& GetShard(const std::string& key);
+};
+
+} // namespace dnd5e
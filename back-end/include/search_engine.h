@@ -1,11 +1,18 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include <optional>
+#include <shared_mutex>
 #include "api_client.h"
+#include "background_refresher.h"
+#include "l2_cache.h"
+#include "search_result_cache.h"
 
 namespace dnd5e {
 
@@ -16,9 +23,50 @@ struct SearchHit {
     std::string endpoint;
 };
 
+// Parsed endpoint list shared by every reader until the next refresh replaces it
+struct ListSnapshot {
+    std::vector<ApiClient::ApiItem> items;
+    // Item index -> position in items
+    std::unordered_map<std::string, size_t> positions;
+    // Hash of every item's index, name and url: equal lists have equal
+    // versions, in any process
+    uint64_t version = 0;
+};
+
 class SearchEngine {
 public:
-    explicit SearchEngine(std::shared_ptr<ApiClient> api_client);
+    struct ExportedList {
+        std::string endpoint;
+        std::shared_ptr<const ListSnapshot> snapshot;
+        ApiClient::Validators validators;
+        std::chrono::steady_clock::time_point fresh_until;
+    };
+
+    // How list reads were answered. Stale hits found an expired list (refreshed
+    // inline when there is no refresher); misses found nothing and waited on upstream
+    struct ListCacheStats {
+        size_t fresh_hits = 0;
+        size_t stale_hits = 0;
+        size_t misses = 0;
+    };
+
+    // How CachedSearch answered. Scans ran the full search, including every
+    // search while a list was missing or expired
+    struct SearchCacheStats {
+        size_t hits = 0;
+        size_t l2_hits = 0;
+        size_t scans = 0;
+        // Cached for an older dataset version
+        size_t invalidated = 0;
+        size_t entries = 0;
+    };
+
+    // With a refresher, expired lists are served stale and refreshed in the
+    // background; without one they are refreshed before returning. Lists missing
+    // from memory are looked up in l2_cache before upstream, and every fetched
+    // list is written back to it
+    explicit SearchEngine(std::shared_ptr<ApiClient> api_client, BackgroundRefresher* refresher = nullptr,
+                          L2Cache* l2_cache = nullptr);
     ~SearchEngine() = default;
 
     SearchEngine(const SearchEngine&) = delete;
@@ -26,19 +74,94 @@ public:
     SearchEngine(SearchEngine&&) = delete;
     SearchEngine& operator=(SearchEngine&&) = delete;
 
-    std::vector<SearchHit> Search(const std::string& query, const std::vector<std::string>& endpoints = {}, int max_results = 100);
-    std::vector<SearchHit> SearchInEndpoint(const std::string& query, const std::string& endpoint, int max_results = 100);
-    void PreloadData(const std::vector<std::string>& endpoints = {});
+    // Every search path trims surrounding whitespace from the query, then matches
+    // and scores it case-insensitively; a blank query matches nothing. An
+    // aborted control throws RequestAbortedError instead of returning partial results
+    std::vector<SearchHit> Search(const std::string& query, const std::vector<std::string>& endpoints = {}, int max_results = 100,
+                                  const RequestControl& control = {});
+    // Search through the result cache (see SetResultCacheSize). The key is the
+    // normalized query, the endpoint set as a set, and max_results. An entry holds
+    // while the lists it scanned are fresh and their combined content version
+    // (the dataset version) is unchanged; with an L2 cache, searches are also
+    // shared through it
+    std::shared_ptr<const std::vector<SearchHit>> CachedSearch(const std::string& query, const std::vector<std::string>& endpoints,
+                                                               int max_results, const RequestControl& control = {});
+    std::vector<SearchHit> SearchInEndpoint(const std::string& query, const std::string& endpoint, int max_results = 100,
+                                            const RequestControl& control = {});
+    void PreloadData(const std::vector<std::string>& endpoints = {}, const RequestControl& control = {});
+    // Cached list, refreshed once past its (jittered) refresh interval. Retryable upstream
+    // failures fall back to the last list fetched; anything else throws
+    std::shared_ptr<const ListSnapshot> GetList(const std::string& endpoint, const RequestControl& control = {});
     void ClearCache();
+    // Last list fetched for the endpoint regardless of age, without touching upstream; null if none
+    std::shared_ptr<const ListSnapshot> GetCachedList(const std::string& endpoint) const;
+    // Cached list if it has not expired; null otherwise. Never refreshes
+    std::shared_ptr<const ListSnapshot> GetFreshList(const std::string& endpoint) const;
+    // Whether the endpoint's cached list has the index; nullopt when no list is
+    // cached or it has expired, since upstream may have added items since
+    std::optional<bool> ContainsIndex(const std::string& endpoint, const std::string& index) const;
     std::unordered_map<std::string, size_t> GetCacheStats() const;
+    ListCacheStats GetListCacheStats() const;
+    std::vector<ExportedList> ExportLists() const;
+    // Seeds the cache, e.g. from a snapshot; a list already cached is kept.
+    // Returns whichever list ends up cached
+    std::shared_ptr<const ListSnapshot> RestoreList(const std::string& endpoint, std::vector<ApiClient::ApiItem> items,
+                     ApiClient::Validators validators, std::chrono::steady_clock::time_point fresh_until);
+    // Each list stays fresh for interval +/- jitter (a fraction of it)
+    void SetRefreshInterval(std::chrono::seconds interval, double jitter = 0.1);
+    // Finished searches CachedSearch keeps; 0 (the default) disables. Set before use
+    void SetResultCacheSize(size_t max_entries);
+    // Nullopt when the result cache is disabled
+    std::optional<SearchCacheStats> GetSearchCacheStats() const;
 
 private:
+    struct CachedList {
+        std::shared_ptr<const ListSnapshot> snapshot;
+        ApiClient::Validators validators;
+        std::chrono::steady_clock::time_point fresh_until;
+    };
+
     std::shared_ptr<ApiClient> api_client_;
-    std::unordered_map<std::string, std::vector<ApiClient::ApiItem>> cached_data_;
+    BackgroundRefresher* refresher_;
+    L2Cache* l2_cache_;
+    std::unordered_map<std::string, CachedList> cached_data_;
+    mutable std::shared_mutex cache_mutex_;
+    std::chrono::seconds refresh_interval_;
+    double refresh_jitter_;
+    std::atomic<size_t> fresh_hits_;
+    std::atomic<size_t> stale_hits_;
+    std::atomic<size_t> misses_;
+    std::unique_ptr<SearchResultCache> result_cache_;
+    std::atomic<size_t> l2_search_hits_;
+    std::atomic<size_t> search_scans_;
+
+    using SearchLists = std::vector<std::pair<std::string, std::shared_ptr<const ListSnapshot>>>;
 
-    float CalculateRelevanceScore(const ApiClient::ApiItem& item, const std::string& query, const std::string& matched_field) const;
-    bool ContainsQuery(const std::string& text, const std::string& query) const;
-    std::vector<ApiClient::ApiItem> GetEndpointData(const std::string& endpoint);
+    // Arguments are already lowercase
+    float CalculateRelevanceScore(const std::string& name, const std::string& index, const std::string& query,
+                                  const std::string& matched_field) const;
+    // Trimmed and lowercased, as every search matches it
+    static std::string NormalizeQuery(const std::string& query);
+    SearchLists LoadSearchLists(const std::vector<std::string>& endpoints, const RequestControl& control);
+    std::vector<SearchHit> ScanLists(const std::string& query, const SearchLists& lists, int max_results) const;
+    std::vector<SearchHit> ScanList(const std::string& query, const std::string& endpoint, const ListSnapshot& list,
+                                    int max_results) const;
+    static uint64_t DatasetVersion(const SearchLists& lists);
+    // Nullopt if any of the lists is missing or expired
+    std::optional<uint64_t> FreshDatasetVersion(const std::vector<std::string>& endpoints) const;
+    // Never null: failures are logged and leave the last list (or an empty one)
+    std::shared_ptr<const ListSnapshot> GetEndpointData(const std::string& endpoint, const RequestControl& control);
+    std::shared_ptr<const ListSnapshot> LoadEndpointData(const std::string& endpoint, const RequestControl& control);
+    // The list in memory, else in l2_cache (restored into memory); null if neither
+    // has it. Never goes upstream
+    std::shared_ptr<const ListSnapshot> FindCachedList(const std::string& endpoint, ApiClient::Validators& validators,
+                                                       bool& expired);
+    // Revalidates when validators are set, otherwise fetches the whole list
+    std::shared_ptr<const ListSnapshot> RefreshEndpointData(const std::string& endpoint, const ApiClient::Validators& validators,
+                                                            const RequestControl& control);
+    std::chrono::steady_clock::time_point NextFreshUntil() const;
+    static std::shared_ptr<const ListSnapshot> MakeSnapshot(std::vector<ApiClient::ApiItem> items);
+    std::shared_ptr<const ListSnapshot> StoreEndpointData(const std::string& endpoint, ApiClient::ApiResponse response);
     std::optional<SearchHit> SearchInItem(const ApiClient::ApiItem& item, const std::string& query, const std::string& endpoint) const;
 };
 
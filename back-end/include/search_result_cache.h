@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dnd5e {
+
+struct SearchHit;
+
+// LRU of finished searches keyed by normalized query, endpoint set and
+// max_results. Each entry remembers the dataset version (see
+// SearchEngine::CachedSearch) it was computed against and only answers
+// lookups for that version, so a list refresh that changes content retires
+// every search over it.
+class SearchResultCache {
+public:
+    using Hits = std::shared_ptr<const std::vector<SearchHit>>;
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        // Found but computed against another dataset version
+        size_t invalidated = 0;
+        size_t entries = 0;
+    };
+
+    explicit SearchResultCache(size_t max_entries);
+    ~SearchResultCache() = default;
+
+    SearchResultCache(const SearchResultCache&) = delete;
+    SearchResultCache& operator=(const SearchResultCache&) = delete;
+    SearchResultCache(SearchResultCache&&) = delete;
+    SearchResultCache& operator=(SearchResultCache&&) = delete;
+
+    // Null on a miss or a version mismatch
+    Hits Get(const std::string& key, uint64_t dataset_version);
+    void Put(const std::string& key, uint64_t dataset_version, Hits hits);
+    Stats GetStats() const;
+
+private:
+    struct Node {
+        std::string key;
+        uint64_t dataset_version;
+        Hits hits;
+    };
+
+    size_t max_entries_;
+    mutable std::mutex mutex_;
+    std::list<Node> lru_;
+    std::unordered_map<std::string, std::list<Node>::iterator> index_;
+    size_t hits_;
+    size_t misses_;
+    size_t invalidated_;
+};
+
+} // namespace dnd5e
@@ -1,19 +1,58 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
+#include <vector>
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/health_check_service_interface.h>
 #include <grpcpp/ext/proto_server_reflection_plugin.h>
 
+#include "cached_response_service.h"
 #include "dnd5e_service.h"
+#include "fake_transport.h"
+#include "kv_store_cache.h"
+#include "mariadb_cache.h"
 
 namespace dnd5e {
 
+struct ServerOptions {
+    std::string api_base_url = "https://www.dnd5eapi.co/api/2014";
+    ApiClientOptions api_client;
+    // Replace the upstream API with an in-process fake (benchmarking only)
+    std::optional<FakeTransportOptions> fake_upstream;
+    // Upstream connections opened before the port starts serving, then
+    // re-opened on an interval so idle ones dropped by either side come back
+    size_t warm_connections = 0;
+    std::chrono::seconds warm_interval{60};
+    ServiceOptions service;
+    // Caches are restored from this file at startup and written back every
+    // snapshot_interval and on shutdown; empty disables snapshots
+    std::string snapshot_path;
+    std::chrono::seconds snapshot_interval{300};
+    // Shared MariaDB L2 cache behind the in-memory caches
+    std::optional<MariaDbOptions> mariadb;
+    // Embedded on-disk L2 cache for single-node deployments
+    std::optional<KvStoreOptions> kv_store;
+    // Byte budget for serialized GetList / GetItem responses served as-is
+    // (see CachedResponseService); 0, the default, serves every request
+    // through the typed handlers. Misses run on response_miss_threads
+    // workers, with at most response_miss_queue waiting for one
+    size_t response_cache_bytes = 0;
+    size_t response_miss_threads = 16;
+    size_t response_miss_queue = 1024;
+};
+
 class Server {
 public:
-    explicit Server(const std::string& server_address = "0.0.0.0:50051");
-    ~Server() = default;
+    explicit Server(const std::string& server_address = "0.0.0.0:50051",
+                    const ServerOptions& options = ServerOptions());
+    ~Server();
 
     Server(const Server&) = delete;
     Server& operator=(const Server&) = delete;
@@ -29,11 +68,27 @@ public:
 
 private:
     std::string server_address_;
+    ServerOptions options_;
     std::unique_ptr<grpc::Server> server_;
+    std::shared_ptr<ApiClient> api_client_;
     std::unique_ptr<Dnd5eServiceImpl> service_;
+    // Registered in place of service_ when set; wraps it
+    std::unique_ptr<CachedResponseService> cached_service_;
     bool is_running_;
+    std::mutex periodic_mutex_;
+    std::condition_variable periodic_cv_;
+    bool periodic_stopping_;
+    std::vector<std::thread> periodic_threads_;
+    std::mutex snapshot_mutex_;
 
     void SetupServerBuilder(grpc::ServerBuilder& builder);
+    void WarmUpstream();
+    void SaveSnapshot();
+    void LoadSnapshot();
+    // Runs task every interval on its own thread until StopPeriodic()
+    void StartPeriodic(std::chrono::seconds interval, std::function<void()> task);
+    void StopPeriodic();
+    void LogStats() const;
 };
 
 } // namespace dnd5e
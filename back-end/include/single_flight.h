@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dnd5e {
+
+// Coalesces concurrent calls that share a key: the first caller runs the
+// work, everyone arriving while it is in flight waits for the same result.
+// Blocking (Do) and callback (DoAsync) callers join the same flights.
+template <typename T>
+class SingleFlight {
+public:
+    using ResultPtr = std::shared_ptr<const T>;
+    using Callback = std::function<void(ResultPtr result, std::exception_ptr error)>;
+
+    template <typename Fn>
+    ResultPtr Do(const std::string& key, Fn&& fn) {
+        return Do(key, std::forward<Fn>(fn), nullptr);
+    }
+
+    // check_abandon runs periodically while a follower waits and may throw
+    // to stop waiting; the shared call keeps running for everyone else.
+    template <typename Fn>
+    ResultPtr Do(const std::string& key, Fn&& fn, const std::function<void()>& check_abandon) {
+        auto [flight, leader] = Join(key, nullptr);
+
+        if (leader) {
+            ResultPtr result;
+            std::exception_ptr error;
+            try {
+                result = std::make_shared<const T>(fn());
+            } catch (...) {
+                error = std::current_exception();
+            }
+            Finish(key, flight, std::move(result), error);
+        } else if (check_abandon) {
+            while (flight->future.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready) {
+                check_abandon();
+            }
+        }
+
+        return flight->future.get();
+    }
+
+    // Never blocks: joins the call in flight for key, or starts one by calling
+    // start with a completion it must invoke exactly once. on_done runs on
+    // whichever thread finishes the shared call.
+    template <typename Start>
+    void DoAsync(const std::string& key, Start&& start, Callback on_done) {
+        auto [flight, leader] = Join(key, std::move(on_done));
+        if (leader) {
+            start([this, key, flight = flight](ResultPtr result, std::exception_ptr error) {
+                Finish(key, flight, std::move(result), error);
+            });
+        }
+    }
+
+    size_t GetExecutedCount() const { return executed_count_; }
+    size_t GetCoalescedCount() const { return coalesced_count_; }
+
+private:
+    struct Flight {
+        std::promise<ResultPtr> promise;
+        std::shared_future<ResultPtr> future;
+        // DoAsync callers, told once the result is set
+        std::vector<Callback> waiters;
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> in_flight_;
+    std::atomic<size_t> executed_count_{0};
+    std::atomic<size_t> coalesced_count_{0};
+
+    // Returns the flight for key and whether the caller leads it
+    std::pair<std::shared_ptr<Flight>, bool> Join(const std::string& key, Callback waiter) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = in_flight_.find(key);
+        bool leader = it == in_flight_.end();
+        if (leader) {
+            auto flight = std::make_shared<Flight>();
+            flight->future = flight->promise.get_future().share();
+            it = in_flight_.emplace(key, std::move(flight)).first;
+            executed_count_++;
+        } else {
+            coalesced_count_++;
+        }
+        if (waiter) {
+            it->second->waiters.push_back(std::move(waiter));
+        }
+        return {it->second, leader};
+    }
+
+    void Finish(const std::string& key, const std::shared_ptr<Flight>& flight, ResultPtr result,
+                std::exception_ptr error) {
+        // Late arrivals start a fresh call rather than reuse a finished one
+        std::vector<Callback> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_.erase(key);
+            waiters.swap(flight->waiters);
+        }
+
+        if (error) {
+            flight->promise.set_exception(error);
+        } else {
+            flight->promise.set_value(result);
+        }
+        for (auto& waiter : waiters) {
+            waiter(result, error);
+        }
+    }
+};
+
+} // namespace dnd5e
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+namespace dnd5e {
+
+// Failure talking to the upstream API. Retryable errors (timeouts, resets,
+// 5xx, 429) feed the circuit breaker; the rest mean upstream answered but
+// we cannot use the answer.
+class UpstreamError : public std::runtime_error {
+public:
+    UpstreamError(const std::string& message, long http_status, bool retryable)
+        : std::runtime_error(message), http_status_(http_status), retryable_(retryable) {}
+
+    // Zero when the request never produced an HTTP response
+    long GetHttpStatus() const { return http_status_; }
+    bool IsRetryable() const { return retryable_; }
+
+private:
+    long http_status_;
+    bool retryable_;
+};
+
+// Thrown without touching the network while an endpoint's breaker is open
+class CircuitOpenError : public UpstreamError {
+public:
+    explicit CircuitOpenError(const std::string& endpoint)
+        : UpstreamError("Upstream circuit open for endpoint: " + endpoint, 0, true) {}
+};
+
+// The caller stopped waiting for the answer. Never retried, and says
+// nothing about upstream health.
+class RequestAbortedError : public UpstreamError {
+protected:
+    explicit RequestAbortedError(const std::string& message)
+        : UpstreamError(message, 0, false) {}
+};
+
+class RequestCancelledError : public RequestAbortedError {
+public:
+    RequestCancelledError() : RequestAbortedError("Request cancelled by caller") {}
+};
+
+class DeadlineExceededError : public RequestAbortedError {
+public:
+    DeadlineExceededError() : RequestAbortedError("Request deadline exceeded") {}
+};
+
+} // namespace dnd5e
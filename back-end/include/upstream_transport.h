@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace dnd5e {
+
+// HTTP cache validators used for conditional revalidation
+struct HttpValidators {
+    std::string etag;
+    std::string last_modified;
+};
+
+// Limits set by whoever waits for the response, e.g. an RPC's deadline
+// and cancellation. Default-constructed means "wait as long as it takes".
+struct RequestControl {
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    // Polled while the request runs; must be cheap and thread-safe
+    std::function<bool()> is_cancelled;
+
+    bool IsCancelled() const;
+    bool IsExpired() const;
+    // Throws RequestCancelledError or DeadlineExceededError
+    void ThrowIfAborted() const;
+};
+
+struct UpstreamRequest {
+    std::string url;
+    HttpValidators validators;
+    // Already capped at the control's deadline by the caller
+    std::chrono::milliseconds timeout{30000};
+    RequestControl control;
+};
+
+// Filled in by the transport while the response arrives. Callers may derive
+// from it to carry per-request state; it is never deleted through a base pointer.
+struct UpstreamResponse {
+    long status = 0;
+    std::string body;
+    HttpValidators validators;
+    size_t wire_bytes = 0;
+    size_t decoded_bytes = 0;
+    // When set, a 200 body is handed over as it arrives instead of being buffered
+    std::function<void(const char* data, size_t size)> body_consumer;
+    std::exception_ptr body_error;
+
+    // False once the consumer has thrown; the transport must abort the transfer
+    bool AppendBody(const char* data, size_t size);
+};
+
+// Moves bytes between ApiClient and the upstream API. Transport failures
+// surface as UpstreamError; HTTP status codes are left to the caller.
+// A running request is aborted soon after control.IsCancelled() turns true.
+class UpstreamTransport {
+public:
+    using RequestId = uint64_t;
+    using Clock = std::chrono::steady_clock;
+    using Completion = std::function<void(std::exception_ptr error)>;
+
+    virtual ~UpstreamTransport() = default;
+
+    virtual const char* GetName() const = 0;
+
+    // Blocks the calling thread until the response is complete
+    virtual void Perform(const UpstreamRequest& request, UpstreamResponse& response) = 0;
+
+    // on_done runs exactly once on the transport's callback thread
+    virtual RequestId Submit(const UpstreamRequest& request, std::shared_ptr<UpstreamResponse> response,
+                             Completion on_done) = 0;
+
+    // Callback thread only. Completes the request with a non-retryable error;
+    // requests that already completed are ignored.
+    virtual void Cancel(RequestId id) = 0;
+
+    // Runs fn on the callback thread once when is reached
+    virtual void Schedule(Clock::time_point when, std::function<void()> fn) = 0;
+};
+
+} // namespace dnd5e
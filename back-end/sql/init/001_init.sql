@@ -2,8 +2,8 @@
 
 CREATE TABLE IF NOT EXISTS api_cache (
   id BIGINT UNSIGNED NOT NULL AUTO_INCREMENT,
-  endpoint VARCHAR(128) NOT NULL,
-  item_index VARCHAR(256) NOT NULL,
+  endpoint VARCHAR(128) COLLATE utf8mb4_bin NOT NULL,
+  item_index VARCHAR(256) COLLATE utf8mb4_bin NOT NULL,
   raw_json LONGTEXT NOT NULL,
   etag VARCHAR(128) NULL,
   updated_at TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
@@ -13,7 +13,7 @@ CREATE TABLE IF NOT EXISTS api_cache (
 
 CREATE TABLE IF NOT EXISTS api_list_cache (
   id BIGINT UNSIGNED NOT NULL AUTO_INCREMENT,
-  endpoint VARCHAR(128) NOT NULL,
+  endpoint VARCHAR(128) COLLATE utf8mb4_bin NOT NULL,
   page INT NOT NULL DEFAULT 0,
   page_size INT NOT NULL DEFAULT 0,
   raw_json LONGTEXT NOT NULL,
@@ -24,8 +24,8 @@ CREATE TABLE IF NOT EXISTS api_list_cache (
 
 CREATE TABLE IF NOT EXISTS search_cache (
   id BIGINT UNSIGNED NOT NULL AUTO_INCREMENT,
-  query VARCHAR(256) NOT NULL,
-  endpoints TEXT NULL,
+  query VARCHAR(256) COLLATE utf8mb4_bin NOT NULL,
+  endpoints TEXT COLLATE utf8mb4_bin NULL,
   results LONGTEXT NOT NULL,
   updated_at TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
   PRIMARY KEY (id),
@@ -1,102 +1,600 @@
 #include "api_client.h"
+#include "curl_transport.h"
+#include "list_stream_parser.h"
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
 #include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <random>
+#include <thread>
 
 namespace dnd5e {
 
-ApiClient::ApiClient(const std::string& base_url)
-    : base_url_(base_url), curl_(nullptr), timeout_seconds_(30) {
-    InitializeCurl();
+namespace {
+    bool IsRetryableHttpStatus(long status) {
+        return status == 408 || status == 429 || status >= 500;
+    }
+    
+    // Sleeps in short slices so a cancelled caller is not held for the whole backoff
+    void SleepUnlessCancelled(std::chrono::milliseconds delay, const RequestControl& control) {
+        auto wake_at = std::chrono::steady_clock::now() + delay;
+        while (std::chrono::steady_clock::now() < wake_at && !control.IsCancelled()) {
+            std::this_thread::sleep_until(std::min(wake_at, std::chrono::steady_clock::now() + std::chrono::milliseconds(20)));
+        }
+    }
+}
+
+struct ApiClient::RetryingRequest {
+    std::string url;
+    Validators validators;
+    bool stream_list;
+    RequestControl control;
+    CircuitBreaker* breaker;
+    std::function<void(std::exception_ptr, HttpResponse)> on_done;
+    int attempt = 1;
+};
+
+ApiClient::ApiClient(const std::string& base_url, const ApiClientOptions& options,
+                     std::unique_ptr<UpstreamTransport> transport)
+    : base_url_(base_url), options_(options), json_backend_(CreateJsonBackend(options.json_backend)),
+      local_reads_(0), transport_(std::move(transport)), timeout_seconds_(30) {
+    if (!options_.data_dir.empty() && !options_.data_pack.empty()) {
+        throw std::invalid_argument("Only one of data_dir and data_pack may be set");
+    }
+    if (!options_.data_dir.empty()) {
+        local_source_ = OpenDataDirectory(options_.data_dir);
+    } else if (!options_.data_pack.empty()) {
+        local_source_ = OpenDataPack(options_.data_pack);
+    }
+    
+    if (!transport_) {
+        CurlTransportOptions curl_options;
+        curl_options.http2 = options_.http2;
+        curl_options.http2_max_streams = options_.http2_max_streams;
+        curl_options.connect_timeout_ms = options_.connect_timeout_ms;
+        if (options_.pin_dns && !local_source_) {
+            curl_options.pin_dns_url = base_url_;
+            curl_options.dns_refresh_ms = options_.dns_refresh_ms;
+        }
+        transport_ = std::make_unique<CurlTransport>(curl_options);
+    }
+    
+    if (options_.hedge) {
+        hedge_policy_ = std::make_unique<HedgePolicy>(options_.hedge_percentile, options_.hedge_budget);
+    }
+    
     LoadValidEndpoints();
+    
+    for (const auto& endpoint : valid_endpoints_) {
+        circuit_breakers_.emplace(endpoint, std::make_unique<CircuitBreaker>(
+            options_.breaker_failure_threshold, std::chrono::milliseconds(options_.breaker_open_ms)));
+    }
 }
 
 ApiClient::~ApiClient() {
-    CleanupCurl();
+    // In-flight requests call back into this client, so stop the transport first
+    transport_.reset();
 }
 
-void ApiClient::InitializeCurl() {
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl_ = curl_easy_init();
+ApiClient::HttpResponse ApiClient::MakeRequest(
+    const std::string& endpoint,
+    const std::string& url,
+    const Validators& validators,
+    bool stream_list,
+    const RequestControl& control) {
     
-    if (!curl_) {
-        throw std::runtime_error("Failed to initialize cURL");
+    control.ThrowIfAborted();
+    
+    if (hedge_policy_ && !stream_list) {
+        // Hedges need the transport's timers and cancellation, so block on the async path
+        std::promise<HttpResponse> promise;
+        auto future = promise.get_future();
+        MakeRequestAsync(endpoint, url, validators, stream_list, control, [&promise](std::exception_ptr error, HttpResponse response) {
+            if (error) {
+                promise.set_exception(error);
+            } else {
+                promise.set_value(std::move(response));
+            }
+        });
+        return future.get();
     }
     
-    // Set common options
-    curl_easy_setopt(curl_, CURLOPT_USERAGENT, "D&D-5e-Backend/1.0");
-    curl_easy_setopt(curl_, CURLOPT_TIMEOUT, timeout_seconds_);
-    curl_easy_setopt(curl_, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl_, CURLOPT_SSL_VERIFYPEER, 1L);
-    curl_easy_setopt(curl_, CURLOPT_SSL_VERIFYHOST, 2L);
+    CircuitBreaker& breaker = *circuit_breakers_.at(endpoint);
+    if (!breaker.AllowRequest()) {
+        throw CircuitOpenError(endpoint);
+    }
+    
+    for (int attempt = 1; ; ++attempt) {
+        std::exception_ptr error;
+        try {
+            auto response = PerformRequest(url, validators, stream_list, control);
+            RecordAttempt(breaker, nullptr);
+            return response;
+        } catch (...) {
+            error = AttributeAbort(control, std::current_exception());
+        }
+        
+        bool retryable = RecordAttempt(breaker, error);
+        if (!retryable || attempt >= options_.max_attempts) {
+            std::rethrow_exception(error);
+        }
+        auto delay = GetRetryDelay(attempt);
+        if (IsPastDeadline(control, std::chrono::steady_clock::now() + delay)) {
+            // The retry could not finish in time anyway
+            throw DeadlineExceededError();
+        }
+        if (!breaker.AllowRequest()) {
+            std::rethrow_exception(error);
+        }
+        SleepUnlessCancelled(delay, control);
+        control.ThrowIfAborted();
+    }
 }
 
-void ApiClient::CleanupCurl() {
-    if (curl_) {
-        curl_easy_cleanup(curl_);
-        curl_ = nullptr;
+ApiClient::HttpResponse ApiClient::PerformRequest(
+    const std::string& url,
+    const Validators& validators,
+    bool stream_list,
+    const RequestControl& control) {
+    
+    HttpResponse response;
+    if (stream_list) {
+        AttachListParser(response);
     }
-    curl_global_cleanup();
+    
+    transport_->Perform(MakeUpstreamRequest(url, validators, control), response);
+    CheckStatus(response);
+    
+    return response;
 }
 
-std::string ApiClient::MakeRequest(const std::string& url) {
-    std::string response_data;
+void ApiClient::MakeRequestAsync(
+    const std::string& endpoint,
+    const std::string& url,
+    const Validators& validators,
+    bool stream_list,
+    const RequestControl& control,
+    std::function<void(std::exception_ptr, HttpResponse)> on_done) {
     
-    curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &response_data);
+    CircuitBreaker& breaker = *circuit_breakers_.at(endpoint);
+    if (!breaker.AllowRequest()) {
+        on_done(std::make_exception_ptr(CircuitOpenError(endpoint)), {});
+        return;
+    }
     
-    CURLcode res = curl_easy_perform(curl_);
+    auto request = std::make_shared<RetryingRequest>();
+    request->url = url;
+    request->validators = validators;
+    request->stream_list = stream_list;
+    request->control = control;
+    request->breaker = &breaker;
+    request->on_done = std::move(on_done);
+    StartAttempt(std::move(request));
+}
+
+void ApiClient::StartAttempt(std::shared_ptr<RetryingRequest> request) {
+    try {
+        request->control.ThrowIfAborted();
+    } catch (...) {
+        // Aborted while backing off
+        request->on_done(std::current_exception(), {});
+        return;
+    }
     
-    if (res != CURLE_OK) {
-        std::string error_msg = "cURL error: ";
-        error_msg += curl_easy_strerror(res);
-        throw std::runtime_error(error_msg);
+    auto on_attempt_done = [this, request](std::exception_ptr error, HttpResponse response) {
+        error = AttributeAbort(request->control, error);
+        bool retryable = RecordAttempt(*request->breaker, error);
+        if (retryable && request->attempt < options_.max_attempts) {
+            auto retry_at = UpstreamTransport::Clock::now() + GetRetryDelay(request->attempt);
+            if (IsPastDeadline(request->control, retry_at)) {
+                request->on_done(std::make_exception_ptr(DeadlineExceededError()), {});
+                return;
+            }
+            if (request->breaker->AllowRequest()) {
+                // Back off on the transport's callback thread instead of parking a worker
+                request->attempt++;
+                transport_->Schedule(retry_at, [this, request]() { StartAttempt(request); });
+                return;
+            }
+        }
+        request->on_done(error, std::move(response));
+    };
+    
+    // List bodies are large and refreshed in the background; only items are hedged
+    if (hedge_policy_ && !request->stream_list) {
+        MakeHedgedRequestAsync(request->url, request->validators, request->control, std::move(on_attempt_done));
+        return;
     }
+    SubmitTransfer(request->url, request->validators, request->stream_list, request->control, std::move(on_attempt_done));
+}
+
+void ApiClient::MakeHedgedRequestAsync(
+    const std::string& url,
+    const Validators& validators,
+    const RequestControl& control,
+    std::function<void(std::exception_ptr, HttpResponse)> on_done) {
     
-    long response_code;
-    curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &response_code);
+    // After the primary is submitted this is only touched on the callback thread
+    struct HedgedRequest {
+        std::function<void(std::exception_ptr, HttpResponse)> on_done;
+        UpstreamTransport::RequestId ids[2] = {0, 0};
+        UpstreamTransport::Clock::time_point started[2];
+        bool finished[2] = {false, false};
+        int outstanding = 0;
+        bool done = false;
+    };
     
-    if (response_code != 200) {
-        std::string error_msg = "HTTP error: ";
-        error_msg += std::to_string(response_code);
-        throw std::runtime_error(error_msg);
+    auto request = std::make_shared<HedgedRequest>();
+    request->on_done = std::move(on_done);
+    
+    auto on_attempt_done = [this, request](int attempt) {
+        return [this, request, attempt](std::exception_ptr error, HttpResponse response) {
+            request->finished[attempt] = true;
+            request->outstanding--;
+            if (request->done) {
+                // The other attempt already answered; this one was cancelled or lost
+                return;
+            }
+            if (error && request->outstanding > 0) {
+                // The other attempt may still succeed
+                return;
+            }
+            request->done = true;
+            
+            if (!error) {
+                hedge_policy_->RecordLatency(std::chrono::duration_cast<std::chrono::microseconds>(
+                    UpstreamTransport::Clock::now() - request->started[attempt]));
+                if (attempt == 1) {
+                    hedge_policy_->RecordHedgeWin();
+                }
+                int other = 1 - attempt;
+                if (request->ids[other] != 0 && !request->finished[other]) {
+                    transport_->Cancel(request->ids[other]);
+                }
+            }
+            request->on_done(error, std::move(response));
+        };
+    };
+    
+    auto delay = hedge_policy_->GetHedgeDelay();
+    hedge_policy_->RecordPrimary();
+    
+    request->outstanding = 1;
+    request->started[0] = UpstreamTransport::Clock::now();
+    request->ids[0] = SubmitTransfer(url, validators, false, control, on_attempt_done(0));
+    
+    if (!delay) {
+        // Not enough latency samples yet to know what "slow" means
+        return;
+    }
+    
+    transport_->Schedule(request->started[0] + *delay, [this, request, url, validators, control, on_attempt_done]() {
+        if (request->done || control.IsCancelled() || !hedge_policy_->TryAcquireHedge()) {
+            return;
+        }
+        request->outstanding++;
+        request->started[1] = UpstreamTransport::Clock::now();
+        request->ids[1] = SubmitTransfer(url, validators, false, control, on_attempt_done(1));
+    });
+}
+
+UpstreamTransport::RequestId ApiClient::SubmitTransfer(
+    const std::string& url,
+    const Validators& validators,
+    bool stream_list,
+    const RequestControl& control,
+    std::function<void(std::exception_ptr, HttpResponse)> on_done) {
+    
+    auto response = std::make_shared<HttpResponse>();
+    if (stream_list) {
+        AttachListParser(*response);
     }
     
-    return response_data;
+    return transport_->Submit(MakeUpstreamRequest(url, validators, control), response,
+        [response, on_done = std::move(on_done)](std::exception_ptr error) {
+            if (!error) {
+                try {
+                    CheckStatus(*response);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            on_done(error, std::move(*response));
+        });
+}
+
+UpstreamRequest ApiClient::MakeUpstreamRequest(
+    const std::string& url,
+    const Validators& validators,
+    const RequestControl& control) const {
+    
+    UpstreamRequest request;
+    request.url = url;
+    request.validators = validators;
+    request.timeout = std::chrono::seconds(timeout_seconds_.load());
+    request.control = control;
+    if (control.deadline) {
+        // Never spend longer upstream than the caller is willing to wait. Rounded
+        // up, so a transfer cut off by the cap ends past the deadline and is
+        // reported as DeadlineExceededError rather than a retryable timeout
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+            *control.deadline - std::chrono::steady_clock::now());
+        request.timeout = std::clamp(remaining, std::chrono::milliseconds(1), request.timeout);
+    }
+    return request;
+}
+
+std::exception_ptr ApiClient::AttributeAbort(const RequestControl& control, std::exception_ptr error) {
+    // A transfer cut short by the caller fails with a transport error; report why it stopped
+    if (error && (control.IsCancelled() || control.IsExpired())) {
+        try {
+            control.ThrowIfAborted();
+        } catch (...) {
+            return std::current_exception();
+        }
+    }
+    return error;
+}
+
+bool ApiClient::IsPastDeadline(const RequestControl& control, UpstreamTransport::Clock::time_point when) {
+    return control.deadline && when >= *control.deadline;
+}
+
+template <typename T, typename Fn>
+std::shared_ptr<const T> ApiClient::DoShared(
+    SingleFlight<T>& flights,
+    const std::string& key,
+    const RequestControl& control,
+    Fn&& fn) {
+    
+    while (true) {
+        try {
+            return flights.Do(key, fn, [&control]() { control.ThrowIfAborted(); });
+        } catch (const RequestAbortedError&) {
+            // The shared fetch belonged to a caller that gave up; only stop if we did too
+            control.ThrowIfAborted();
+        }
+    }
+}
+
+void ApiClient::AttachListParser(HttpResponse& response) {
+    auto parser = std::make_shared<ListStreamParser>();
+    response.list_parser = parser;
+    response.body_consumer = [parser](const char* data, size_t size) {
+        parser->Feed(data, size);
+    };
 }
 
-size_t ApiClient::WriteCallback(void* contents, size_t size, size_t nmemb, std::string* userp) {
-    size_t total_size = size * nmemb;
-    userp->append(static_cast<char*>(contents), total_size);
-    return total_size;
+void ApiClient::CheckStatus(const HttpResponse& response) {
+    if (response.status != 200 && response.status != 304) {
+        std::string error_msg = "HTTP error: ";
+        error_msg += std::to_string(response.status);
+        throw UpstreamError(error_msg, response.status, IsRetryableHttpStatus(response.status));
+    }
 }
 
-ApiClient::ApiResponse ApiClient::GetList(const std::string& endpoint) {
+ApiClient::ApiResponse ApiClient::GetList(const std::string& endpoint, const RequestControl& control) {
     if (!IsValidEndpoint(endpoint)) {
         throw std::invalid_argument("Invalid endpoint: " + endpoint);
     }
     
+    if (local_source_) {
+        return *ReadLocalList(endpoint, {});
+    }
+    
     std::string url = base_url_ + "/" + endpoint;
-    std::string response = MakeRequest(url);
     
-    return ParseListResponse(response);
+    // Concurrent callers for the same list share one upstream fetch and parse
+    auto response = DoShared(list_flights_, url, control, [this, &url, &endpoint, &control]() {
+        auto http_response = MakeRequest(endpoint, url, {}, true, control);
+        RecordTransfer(endpoint, http_response);
+        return FinishListResponse(http_response);
+    });
+    
+    return *response;
 }
 
-nlohmann::json ApiClient::GetItem(const std::string& endpoint, const std::string& index) {
+std::optional<ApiClient::ApiResponse> ApiClient::GetListIfModified(
+    const std::string& endpoint,
+    const Validators& validators,
+    const RequestControl& control) {
+    
     if (!IsValidEndpoint(endpoint)) {
         throw std::invalid_argument("Invalid endpoint: " + endpoint);
     }
     
+    if (local_source_) {
+        return ReadLocalList(endpoint, validators);
+    }
+    
+    std::string url = base_url_ + "/" + endpoint;
+    std::string key = url + "\n" + validators.etag + "\n" + validators.last_modified;
+    
+    auto response = DoShared(conditional_list_flights_, key, control,
+                             [this, &url, &endpoint, &validators, &control]() -> std::optional<ApiResponse> {
+        auto http_response = MakeRequest(endpoint, url, validators, true, control);
+        RecordTransfer(endpoint, http_response);
+        if (http_response.status == 304) {
+            // Unchanged upstream: the caller keeps its already parsed copy
+            return std::nullopt;
+        }
+        return FinishListResponse(http_response);
+    });
+    
+    return *response;
+}
+
+ApiClient::ItemResponse ApiClient::GetItem(
+    const std::string& endpoint,
+    const std::string& index,
+    const RequestControl& control) {
+    
+    if (!IsValidEndpoint(endpoint)) {
+        throw std::invalid_argument("Invalid endpoint: " + endpoint);
+    }
+    
+    if (local_source_) {
+        return *ReadLocalItem(endpoint, index, {});
+    }
+    
     std::string url = base_url_ + "/" + endpoint + "/" + index;
-    std::string response = MakeRequest(url);
     
-    try {
-        return nlohmann::json::parse(response);
-    } catch (const nlohmann::json::exception& e) {
-        throw std::runtime_error("Failed to parse JSON response: " + std::string(e.what()));
+    auto item = DoShared(item_flights_, url, control, [this, &url, &endpoint, &control]() {
+        auto http_response = MakeRequest(endpoint, url, {}, false, control);
+        RecordTransfer(endpoint, http_response);
+        return FinishItemResponse(http_response);
+    });
+    
+    return *item;
+}
+
+std::optional<ApiClient::ItemResponse> ApiClient::GetItemIfModified(
+    const std::string& endpoint,
+    const std::string& index,
+    const Validators& validators,
+    const RequestControl& control) {
+    
+    if (!IsValidEndpoint(endpoint)) {
+        throw std::invalid_argument("Invalid endpoint: " + endpoint);
+    }
+    
+    if (local_source_) {
+        return ReadLocalItem(endpoint, index, validators);
+    }
+    
+    std::string url = base_url_ + "/" + endpoint + "/" + index;
+    std::string key = url + "\n" + validators.etag + "\n" + validators.last_modified;
+    
+    auto item = DoShared(conditional_item_flights_, key, control,
+                         [this, &url, &endpoint, &validators, &control]() -> std::optional<ItemResponse> {
+        auto http_response = MakeRequest(endpoint, url, validators, false, control);
+        RecordTransfer(endpoint, http_response);
+        if (http_response.status == 304) {
+            return std::nullopt;
+        }
+        return FinishItemResponse(http_response);
+    });
+    
+    return *item;
+}
+
+std::future<ApiClient::ApiResponse> ApiClient::GetListAsync(const std::string& endpoint) {
+    auto promise = std::make_shared<std::promise<ApiResponse>>();
+    auto future = promise->get_future();
+    
+    GetListAsync(endpoint, [promise](std::exception_ptr error, ApiResponse response) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(std::move(response));
+        }
+    });
+    
+    return future;
+}
+
+std::future<ApiClient::ItemResponse> ApiClient::GetItemAsync(const std::string& endpoint, const std::string& index) {
+    auto promise = std::make_shared<std::promise<ItemResponse>>();
+    auto future = promise->get_future();
+    
+    GetItemAsync(endpoint, index, [promise](std::exception_ptr error, ItemResponse item) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(std::move(item));
+        }
+    });
+    
+    return future;
+}
+
+void ApiClient::GetListAsync(const std::string& endpoint, ListCallback callback) {
+    if (!IsValidEndpoint(endpoint)) {
+        callback(std::make_exception_ptr(std::invalid_argument("Invalid endpoint: " + endpoint)), {});
+        return;
     }
+    
+    if (local_source_) {
+        // A local read is cheaper than a hop to the event loop
+        ApiResponse parsed{};
+        std::exception_ptr error;
+        try {
+            parsed = *ReadLocalList(endpoint, {});
+        } catch (...) {
+            error = std::current_exception();
+        }
+        callback(error, std::move(parsed));
+        return;
+    }
+    
+    std::string url = base_url_ + "/" + endpoint;
+    
+    // Joins a sync or async fetch of the same list already in flight
+    list_flights_.DoAsync(url, [this, endpoint, url](auto complete) {
+        MakeRequestAsync(endpoint, url, {}, true, {}, [this, endpoint, complete](std::exception_ptr error, HttpResponse response) {
+            // Runs on the event-loop thread and must not unwind into it
+            std::shared_ptr<const ApiResponse> parsed;
+            if (!error) {
+                RecordTransfer(endpoint, response);
+                try {
+                    parsed = std::make_shared<const ApiResponse>(FinishListResponse(response));
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            complete(std::move(parsed), error);
+        });
+    }, [callback = std::move(callback)](std::shared_ptr<const ApiResponse> parsed, std::exception_ptr error) {
+        try {
+            callback(error, parsed ? *parsed : ApiResponse{});
+        } catch (const std::exception& e) {
+            std::cerr << "Async list callback threw: " << e.what() << std::endl;
+        }
+    });
+}
+
+void ApiClient::GetItemAsync(const std::string& endpoint, const std::string& index, ItemCallback callback) {
+    if (!IsValidEndpoint(endpoint)) {
+        callback(std::make_exception_ptr(std::invalid_argument("Invalid endpoint: " + endpoint)), {});
+        return;
+    }
+    
+    if (local_source_) {
+        ItemResponse parsed;
+        std::exception_ptr error;
+        try {
+            parsed = *ReadLocalItem(endpoint, index, {});
+        } catch (...) {
+            error = std::current_exception();
+        }
+        callback(error, std::move(parsed));
+        return;
+    }
+    
+    std::string url = base_url_ + "/" + endpoint + "/" + index;
+    
+    item_flights_.DoAsync(url, [this, endpoint, url](auto complete) {
+        MakeRequestAsync(endpoint, url, {}, false, {}, [this, endpoint, complete](std::exception_ptr error, HttpResponse response) {
+            std::shared_ptr<const ItemResponse> parsed;
+            if (!error) {
+                RecordTransfer(endpoint, response);
+                try {
+                    parsed = std::make_shared<const ItemResponse>(FinishItemResponse(response));
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            complete(std::move(parsed), error);
+        });
+    }, [callback = std::move(callback)](std::shared_ptr<const ItemResponse> parsed, std::exception_ptr error) {
+        try {
+            callback(error, parsed ? *parsed : ItemResponse{});
+        } catch (const std::exception& e) {
+            std::cerr << "Async item callback threw: " << e.what() << std::endl;
+        }
+    });
 }
 
 std::vector<std::string> ApiClient::GetEndpoints() {
@@ -112,35 +610,174 @@ const std::string& ApiClient::GetBaseUrl() const {
     return base_url_;
 }
 
+const ApiClientOptions& ApiClient::GetOptions() const {
+    return options_;
+}
+
+const char* ApiClient::GetJsonBackendName() const {
+    return json_backend_->GetName();
+}
+
+const char* ApiClient::GetTransportName() const {
+    return transport_->GetName();
+}
+
+size_t ApiClient::WarmUp(size_t connections) {
+    if (local_source_) {
+        return 0;
+    }
+    
+    // Concurrent requests each need their own connection; any answer, even a 404,
+    // leaves a handshaken connection behind for the pool
+    std::atomic<size_t> warmed{0};
+    std::vector<std::thread> threads;
+    threads.reserve(connections);
+    for (size_t i = 0; i < connections; ++i) {
+        threads.emplace_back([this, &warmed]() {
+            try {
+                HttpResponse response;
+                transport_->Perform(MakeUpstreamRequest(base_url_, {}, {}), response);
+                warmed++;
+            } catch (const std::exception& e) {
+                std::cerr << "Upstream warm-up request failed: " << e.what() << std::endl;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return warmed;
+}
+
+const LocalDataSource* ApiClient::GetLocalDataSource() const {
+    return local_source_.get();
+}
+
 void ApiClient::SetTimeout(int timeout_seconds) {
     timeout_seconds_ = timeout_seconds;
-    if (curl_) {
-        curl_easy_setopt(curl_, CURLOPT_TIMEOUT, timeout_seconds_);
-    }
 }
 
-ApiClient::ApiResponse ApiClient::ParseListResponse(const std::string& json_str) {
+std::unordered_map<std::string, size_t> ApiClient::GetRequestStats() const {
+    return {
+        {"list_requests_executed", list_flights_.GetExecutedCount()},
+        {"list_requests_coalesced", list_flights_.GetCoalescedCount()},
+        {"item_requests_executed", item_flights_.GetExecutedCount()},
+        {"item_requests_coalesced", item_flights_.GetCoalescedCount()},
+        {"local_reads", local_reads_.load()}
+    };
+}
+
+std::unordered_map<std::string, ApiClient::TransferStats> ApiClient::GetTransferStats() const {
+    std::lock_guard<std::mutex> lock(transfer_stats_mutex_);
+    return transfer_stats_;
+}
+
+HedgePolicy::Stats ApiClient::GetHedgeStats() const {
+    return hedge_policy_ ? hedge_policy_->GetStats() : HedgePolicy::Stats{};
+}
+
+const CircuitBreaker* ApiClient::GetCircuitBreaker(const std::string& endpoint) const {
+    auto it = circuit_breakers_.find(endpoint);
+    return it != circuit_breakers_.end() ? it->second.get() : nullptr;
+}
+
+void ApiClient::RecordTransfer(const std::string& endpoint, const HttpResponse& response) {
+    std::lock_guard<std::mutex> lock(transfer_stats_mutex_);
+    auto& stats = transfer_stats_[endpoint];
+    stats.requests++;
+    stats.wire_bytes += response.wire_bytes;
+    stats.decoded_bytes += response.decoded_bytes;
+}
+
+bool ApiClient::RecordAttempt(CircuitBreaker& breaker, std::exception_ptr error) {
+    if (!error) {
+        breaker.RecordSuccess();
+        return false;
+    }
+    
     try {
-        auto json = nlohmann::json::parse(json_str);
-        
-        ApiResponse response;
-        response.count = json.value("count", 0);
-        
-        if (json.contains("results") && json["results"].is_array()) {
-            for (const auto& item : json["results"]) {
-                ApiItem api_item;
-                api_item.index = item.value("index", "");
-                api_item.name = item.value("name", "");
-                api_item.url = item.value("url", "");
-                response.results.push_back(api_item);
-            }
+        std::rethrow_exception(error);
+    } catch (const UpstreamError& e) {
+        if (e.IsRetryable()) {
+            breaker.RecordFailure();
+            return true;
         }
-        
-        return response;
-        
-    } catch (const nlohmann::json::exception& e) {
-        throw std::runtime_error("Failed to parse JSON response: " + std::string(e.what()));
+        if (e.GetHttpStatus() != 0) {
+            // A 4xx still proves upstream is up and answering
+            breaker.RecordSuccess();
+        }
+    } catch (...) {
+        // Body rejected by the parser: says nothing about upstream health
     }
+    return false;
+}
+
+std::chrono::milliseconds ApiClient::GetRetryDelay(int retry) const {
+    // Full jitter: uniform over [0, min(max, base * 2^(retry-1))]
+    long ceiling = options_.retry_base_delay_ms;
+    for (int i = 1; i < retry && ceiling < options_.retry_max_delay_ms; ++i) {
+        ceiling *= 2;
+    }
+    ceiling = std::min(ceiling, options_.retry_max_delay_ms);
+    
+    thread_local std::mt19937 generator{std::random_device{}()};
+    std::uniform_int_distribution<long> distribution(0, std::max(0L, ceiling));
+    return std::chrono::milliseconds(distribution(generator));
+}
+
+ApiClient::ApiResponse ApiClient::FinishListResponse(HttpResponse& response) {
+    ApiResponse parsed = response.list_parser->Finish();
+    parsed.validators = std::move(response.validators);
+    return parsed;
+}
+
+ApiClient::ItemResponse ApiClient::FinishItemResponse(HttpResponse& response) const {
+    ItemFields fields = json_backend_->ExtractItemFields(response.body);
+    
+    ItemResponse item;
+    item.raw_json = std::move(response.body);
+    item.name = std::move(fields.name);
+    item.url = std::move(fields.url);
+    item.validators = std::move(response.validators);
+    return item;
+}
+
+std::optional<ApiClient::ApiResponse> ApiClient::ReadLocalList(const std::string& endpoint, const Validators& validators) {
+    auto entry = local_source_->ReadList(endpoint);
+    if (!entry) {
+        throw UpstreamError("Not found in local data: " + endpoint, 404, false);
+    }
+    local_reads_++;
+    if (!validators.etag.empty() && validators.etag == entry->version) {
+        return std::nullopt;
+    }
+    
+    ListStreamParser parser;
+    parser.Feed(entry->body.data(), entry->body.size());
+    ApiResponse parsed = parser.Finish();
+    parsed.validators.etag = std::move(entry->version);
+    return parsed;
+}
+
+std::optional<ApiClient::ItemResponse> ApiClient::ReadLocalItem(
+    const std::string& endpoint,
+    const std::string& index,
+    const Validators& validators) {
+    
+    auto entry = local_source_->ReadItem(endpoint, index);
+    if (!entry) {
+        throw UpstreamError("Not found in local data: " + endpoint + "/" + index, 404, false);
+    }
+    local_reads_++;
+    if (!validators.etag.empty() && validators.etag == entry->version) {
+        return std::nullopt;
+    }
+    
+    HttpResponse response;
+    response.status = 200;
+    response.body = std::move(entry->body);
+    response.validators.etag = std::move(entry->version);
+    return FinishItemResponse(response);
 }
 
 void ApiClient::LoadValidEndpoints() {
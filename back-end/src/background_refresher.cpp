@@ -0,0 +1,86 @@
+#include "background_refresher.h"
+#include <iostream>
+#include <random>
+
+namespace dnd5e {
+
+std::chrono::steady_clock::duration JitterTtl(std::chrono::steady_clock::duration ttl, double jitter) {
+    if (jitter <= 0.0) {
+        return ttl;
+    }
+    thread_local std::mt19937 generator{std::random_device{}()};
+    std::uniform_real_distribution<double> factor(1.0 - jitter, 1.0 + jitter);
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(ttl * factor(generator));
+}
+
+BackgroundRefresher::BackgroundRefresher(size_t threads, size_t max_pending)
+    : max_pending_(max_pending), stopping_(false) {
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(&BackgroundRefresher::RunWorker, this);
+    }
+}
+
+BackgroundRefresher::~BackgroundRefresher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    wakeup_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+bool BackgroundRefresher::Schedule(const std::string& key, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || workers_.empty() || queue_.size() >= max_pending_ || pending_keys_.count(key) > 0) {
+            stats_.skipped++;
+            return false;
+        }
+        pending_keys_.insert(key);
+        queue_.emplace_back(key, std::move(task));
+        stats_.scheduled++;
+    }
+    wakeup_.notify_one();
+    return true;
+}
+
+BackgroundRefresher::Stats BackgroundRefresher::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void BackgroundRefresher::RunWorker() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wakeup_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+        if (stopping_) {
+            return;
+        }
+
+        auto [key, task] = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+
+        bool ok = true;
+        try {
+            task();
+        } catch (const std::exception& e) {
+            ok = false;
+            std::cerr << "Background refresh of " << key << " failed: " << e.what() << std::endl;
+        }
+
+        lock.lock();
+        pending_keys_.erase(key);
+        if (ok) {
+            stats_.completed++;
+        } else {
+            stats_.failed++;
+        }
+    }
+}
+
+} // namespace dnd5e
@@ -0,0 +1,332 @@
+#include "cache_snapshot.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dnd5e {
+
+namespace {
+
+// Snapshot layout (host byte order):
+//   header   magic[8] "DND5SNAP", u32 format version, u32 record count,
+//            i64 saved at (unix ms), u32 base URL size, u32 reserved, base URL bytes
+//   records  u8 kind, u8[3] reserved, u32 key size, i64 freshness left at save (ms),
+//            u32 ETag size, u32 Last-Modified size, u64 payload size,
+//            then key, ETag, Last-Modified and payload bytes
+// List payload: u32 item count, then per item u32 index/name/url sizes and bytes.
+// Item payload: u32 name size, u32 url size, name, url, raw JSON to the end.
+constexpr char kSnapshotMagic[8] = {'D', 'N', 'D', '5', 'S', 'N', 'A', 'P'};
+constexpr uint32_t kSnapshotFormatVersion = 1;
+constexpr uint8_t kListRecord = 0;
+constexpr uint8_t kItemRecord = 1;
+// Fixed-size parts, which every record or list item has even when empty
+constexpr size_t kRecordHeaderSize = 32;
+constexpr size_t kListItemHeaderSize = 12;
+
+using SteadyClock = std::chrono::steady_clock;
+using SystemClock = std::chrono::system_clock;
+
+int64_t ToMillis(std::chrono::nanoseconds duration) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+}
+
+template <typename T>
+void WritePod(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void WriteBytes(std::ofstream& out, const std::string& bytes) {
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+void WriteRecord(std::ofstream& out, uint8_t kind, const std::string& key, SteadyClock::time_point fresh_until,
+                 const HttpValidators& validators, const std::string& payload) {
+    WritePod(out, kind);
+    out.write("\0\0\0", 3);
+    WritePod(out, static_cast<uint32_t>(key.size()));
+    WritePod(out, static_cast<int64_t>(ToMillis(fresh_until - SteadyClock::now())));
+    WritePod(out, static_cast<uint32_t>(validators.etag.size()));
+    WritePod(out, static_cast<uint32_t>(validators.last_modified.size()));
+    WritePod(out, static_cast<uint64_t>(payload.size()));
+    WriteBytes(out, key);
+    WriteBytes(out, validators.etag);
+    WriteBytes(out, validators.last_modified);
+    WriteBytes(out, payload);
+}
+
+void AppendPod(std::string& buffer, uint32_t value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+std::string EncodeList(const ListSnapshot& snapshot) {
+    std::string payload;
+    AppendPod(payload, static_cast<uint32_t>(snapshot.items.size()));
+    for (const auto& item : snapshot.items) {
+        AppendPod(payload, static_cast<uint32_t>(item.index.size()));
+        AppendPod(payload, static_cast<uint32_t>(item.name.size()));
+        AppendPod(payload, static_cast<uint32_t>(item.url.size()));
+        payload += item.index;
+        payload += item.name;
+        payload += item.url;
+    }
+    return payload;
+}
+
+std::string EncodeItem(const ApiClient::ItemResponse& item) {
+    std::string payload;
+    payload.reserve(8 + item.name.size() + item.url.size() + item.raw_json.size());
+    AppendPod(payload, static_cast<uint32_t>(item.name.size()));
+    AppendPod(payload, static_cast<uint32_t>(item.url.size()));
+    payload += item.name;
+    payload += item.url;
+    payload += item.raw_json;
+    return payload;
+}
+
+// Bounds-checked cursor over the mapping; any overrun means a corrupt file
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, size_t size, const std::string& path)
+        : data_(data), size_(size), position_(0), path_(path) {
+    }
+
+    template <typename T>
+    T Read() {
+        Require(sizeof(T));
+        T value;
+        std::memcpy(&value, data_ + position_, sizeof(T));
+        position_ += sizeof(T);
+        return value;
+    }
+
+    std::string_view ReadView(uint64_t size) {
+        Require(size);
+        std::string_view value(data_ + position_, size);
+        position_ += size;
+        return value;
+    }
+
+    std::string ReadString(uint64_t size) {
+        return std::string(ReadView(size));
+    }
+
+    void Skip(size_t size) {
+        Require(size);
+        position_ += size;
+    }
+
+    bool AtEnd() const {
+        return position_ == size_;
+    }
+
+    // Throws unless count entries of at least min_size bytes each could fit in
+    // what is left, so a corrupt count cannot drive a huge allocation
+    void RequireCount(uint64_t count, size_t min_size) const {
+        Require(count * min_size);
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t position_;
+    const std::string& path_;
+
+    void Require(uint64_t size) const {
+        if (size > size_ - position_) {
+            throw std::runtime_error("Corrupt cache snapshot: " + path_);
+        }
+    }
+};
+
+struct Mapping {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    ~Mapping() {
+        if (data) {
+            ::munmap(const_cast<char*>(data), size);
+        }
+    }
+};
+
+struct ParsedRecord {
+    uint8_t kind;
+    std::string key;
+    SteadyClock::time_point fresh_until;
+    HttpValidators validators;
+    std::vector<ApiClient::ApiItem> list;
+    ApiClient::ItemResponse item;
+};
+
+std::vector<ApiClient::ApiItem> DecodeList(SnapshotReader& reader) {
+    auto count = reader.Read<uint32_t>();
+    reader.RequireCount(count, kListItemHeaderSize);
+    std::vector<ApiClient::ApiItem> items;
+    items.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        auto index_size = reader.Read<uint32_t>();
+        auto name_size = reader.Read<uint32_t>();
+        auto url_size = reader.Read<uint32_t>();
+        ApiClient::ApiItem item;
+        item.index = reader.ReadString(index_size);
+        item.name = reader.ReadString(name_size);
+        item.url = reader.ReadString(url_size);
+        items.push_back(std::move(item));
+    }
+    return items;
+}
+
+} // namespace
+
+CacheSnapshotStats WriteCacheSnapshot(const std::string& path, const std::string& base_url,
+                                      const SearchEngine& lists, const ItemCache* items) {
+    std::string temp_path = path + ".tmp";
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot create cache snapshot: " + temp_path);
+    }
+
+    CacheSnapshotStats stats;
+    // Header is rewritten once the record count is known
+    out.write(kSnapshotMagic, sizeof(kSnapshotMagic));
+    WritePod(out, kSnapshotFormatVersion);
+    WritePod(out, uint32_t{0});
+    WritePod(out, static_cast<int64_t>(ToMillis(SystemClock::now().time_since_epoch())));
+    WritePod(out, static_cast<uint32_t>(base_url.size()));
+    WritePod(out, uint32_t{0});
+    WriteBytes(out, base_url);
+
+    for (const auto& list : lists.ExportLists()) {
+        WriteRecord(out, kListRecord, list.endpoint, list.fresh_until, list.validators, EncodeList(*list.snapshot));
+        stats.lists++;
+    }
+    if (items) {
+        for (const auto& item : items->Export()) {
+            WriteRecord(out, kItemRecord, item.key, item.fresh_until, item.value->validators, EncodeItem(*item.value));
+            stats.items++;
+        }
+    }
+    stats.bytes = static_cast<size_t>(out.tellp());
+
+    out.seekp(sizeof(kSnapshotMagic) + sizeof(kSnapshotFormatVersion));
+    WritePod(out, static_cast<uint32_t>(stats.lists + stats.items));
+    out.close();
+    if (!out) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Failed to write cache snapshot: " + temp_path);
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Failed to replace cache snapshot: " + path);
+    }
+    return stats;
+}
+
+std::optional<CacheSnapshotStats> LoadCacheSnapshot(const std::string& path, const std::string& base_url,
+                                                    SearchEngine& lists, ItemCache* items) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return std::nullopt;
+        }
+        throw std::runtime_error("Cannot open cache snapshot: " + path);
+    }
+
+    Mapping mapping;
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Corrupt cache snapshot (empty): " + path);
+    }
+    mapping.size = static_cast<size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, mapping.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Failed to map cache snapshot: " + path);
+    }
+    mapping.data = static_cast<const char*>(mapped);
+
+    SnapshotReader reader(mapping.data, mapping.size, path);
+    if (reader.ReadView(sizeof(kSnapshotMagic)) != std::string_view(kSnapshotMagic, sizeof(kSnapshotMagic))) {
+        throw std::runtime_error("Not a cache snapshot: " + path);
+    }
+    if (reader.Read<uint32_t>() != kSnapshotFormatVersion) {
+        throw std::runtime_error("Unsupported cache snapshot version: " + path);
+    }
+    auto record_count = reader.Read<uint32_t>();
+    auto saved_at = SystemClock::time_point(std::chrono::milliseconds(reader.Read<int64_t>()));
+    auto url_size = reader.Read<uint32_t>();
+    reader.Skip(sizeof(uint32_t));
+    if (reader.ReadView(url_size) != base_url) {
+        throw std::runtime_error("Cache snapshot was taken against a different upstream: " + path);
+    }
+
+    // Time spent on disk counts against the freshness each entry had left
+    auto now = SteadyClock::now();
+    auto age = std::max(SystemClock::duration::zero(), SystemClock::now() - saved_at);
+
+    // Parse everything before touching the caches so a bad file restores nothing
+    std::vector<ParsedRecord> records;
+    reader.RequireCount(record_count, kRecordHeaderSize);
+    records.reserve(record_count);
+    for (uint32_t i = 0; i < record_count; ++i) {
+        ParsedRecord record;
+        record.kind = reader.Read<uint8_t>();
+        reader.Skip(3);
+        auto key_size = reader.Read<uint32_t>();
+        auto fresh_for = std::chrono::milliseconds(reader.Read<int64_t>());
+        auto etag_size = reader.Read<uint32_t>();
+        auto last_modified_size = reader.Read<uint32_t>();
+        auto payload_size = reader.Read<uint64_t>();
+        record.key = reader.ReadString(key_size);
+        record.fresh_until = now + std::chrono::duration_cast<SteadyClock::duration>(fresh_for - age);
+        record.validators.etag = reader.ReadString(etag_size);
+        record.validators.last_modified = reader.ReadString(last_modified_size);
+
+        std::string_view payload = reader.ReadView(payload_size);
+        SnapshotReader payload_reader(payload.data(), payload.size(), path);
+        if (record.kind == kListRecord) {
+            record.list = DecodeList(payload_reader);
+        } else if (record.kind == kItemRecord) {
+            auto name_size = payload_reader.Read<uint32_t>();
+            auto url_size = payload_reader.Read<uint32_t>();
+            record.item.name = payload_reader.ReadString(name_size);
+            record.item.url = payload_reader.ReadString(url_size);
+            record.item.raw_json = std::string(payload.substr(2 * sizeof(uint32_t) + name_size + url_size));
+            record.item.validators = record.validators;
+        } else {
+            throw std::runtime_error("Corrupt cache snapshot record: " + path);
+        }
+        records.push_back(std::move(record));
+    }
+    if (!reader.AtEnd()) {
+        throw std::runtime_error("Corrupt cache snapshot (trailing bytes): " + path);
+    }
+
+    CacheSnapshotStats stats;
+    stats.bytes = mapping.size;
+    for (auto& record : records) {
+        if (record.kind == kListRecord) {
+            lists.RestoreList(record.key, std::move(record.list), std::move(record.validators), record.fresh_until);
+            stats.lists++;
+        } else if (items) {
+            items->Put(record.key, std::make_shared<const ApiClient::ItemResponse>(std::move(record.item)),
+                       record.fresh_until);
+            stats.items++;
+        }
+    }
+    return stats;
+}
+
+} // namespace dnd5e
@@ -0,0 +1,214 @@
+#include "cached_response_service.h"
+#include <stdexcept>
+
+namespace dnd5e {
+
+namespace {
+    // Cache key: a method tag followed by the request exactly as it came off the wire
+    std::string MakeRequestKey(char method, const grpc::ByteBuffer& request) {
+        std::string key(1, method);
+        std::vector<grpc::Slice> slices;
+        if (request.Dump(&slices).ok()) {
+            key.reserve(1 + request.Length());
+            for (const auto& slice : slices) {
+                key.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+            }
+        }
+        return key;
+    }
+
+    const grpc::Status kMissQueueFull(grpc::StatusCode::RESOURCE_EXHAUSTED, "Server busy: response cache miss queue full");
+
+    template <typename Message>
+    grpc::Status SerializeResponse(const Message& message, grpc::ByteBuffer* buffer) {
+        bool own_buffer = false;
+        return grpc::SerializationTraits<Message>::Serialize(message, buffer, &own_buffer);
+    }
+}
+
+CachedResponseService::CachedResponseService(Dnd5eServiceImpl& service, size_t capacity_bytes, size_t miss_threads,
+                                             size_t miss_queue_capacity)
+    : service_(service), cache_(capacity_bytes), miss_queue_capacity_(miss_queue_capacity), rejected_misses_(0),
+      stopping_(false) {
+    if (miss_threads == 0 || miss_queue_capacity == 0) {
+        throw std::invalid_argument("Response cache needs at least one miss thread and queue slot");
+    }
+    miss_workers_.reserve(miss_threads);
+    for (size_t i = 0; i < miss_threads; ++i) {
+        miss_workers_.emplace_back(&CachedResponseService::MissWorkerLoop, this);
+    }
+}
+
+CachedResponseService::~CachedResponseService() {
+    {
+        std::lock_guard<std::mutex> lock(miss_mutex_);
+        stopping_ = true;
+    }
+    miss_cv_.notify_all();
+    for (auto& worker : miss_workers_) {
+        worker.join();
+    }
+}
+
+grpc::ServerUnaryReactor* CachedResponseService::GetList(
+    grpc::CallbackServerContext* context,
+    const grpc::ByteBuffer* request,
+    grpc::ByteBuffer* response) {
+    auto* reactor = context->DefaultReactor();
+    std::string key = MakeRequestKey('L', *request);
+    if (ServeCached(key, response)) {
+        reactor->Finish(grpc::Status::OK);
+        return reactor;
+    }
+    bool queued = RunMiss([this, context, key = std::move(key), response, reactor]() mutable {
+        ServeList(context, std::move(key), response, reactor);
+    });
+    if (!queued) {
+        reactor->Finish(kMissQueueFull);
+    }
+    return reactor;
+}
+
+grpc::ServerUnaryReactor* CachedResponseService::GetItem(
+    grpc::CallbackServerContext* context,
+    const grpc::ByteBuffer* request,
+    grpc::ByteBuffer* response) {
+    auto* reactor = context->DefaultReactor();
+    std::string key = MakeRequestKey('I', *request);
+    // Without an item cache no item response can be validated, so none is kept
+    if (service_.GetItemCache() && ServeCached(key, response)) {
+        reactor->Finish(grpc::Status::OK);
+        return reactor;
+    }
+    bool queued = RunMiss([this, context, key = std::move(key), response, reactor]() mutable {
+        ServeItem(context, std::move(key), response, reactor);
+    });
+    if (!queued) {
+        reactor->Finish(kMissQueueFull);
+    }
+    return reactor;
+}
+
+grpc::Status CachedResponseService::GetEndpoints(
+    grpc::ServerContext* context,
+    const GetEndpointsRequest* request,
+    GetEndpointsResponse* response) {
+    return service_.GetEndpoints(context, request, response);
+}
+
+grpc::Status CachedResponseService::SearchItems(
+    grpc::ServerContext* context,
+    const SearchItemsRequest* request,
+    SearchItemsResponse* response) {
+    return service_.SearchItems(context, request, response);
+}
+
+grpc::Status CachedResponseService::HealthCheck(
+    grpc::ServerContext* context,
+    const HealthCheckRequest* request,
+    HealthCheckResponse* response) {
+    return service_.HealthCheck(context, request, response);
+}
+
+ResponseCache::Stats CachedResponseService::GetStats() const {
+    return cache_.GetStats();
+}
+
+size_t CachedResponseService::GetRejectedMisses() const {
+    return rejected_misses_.load();
+}
+
+bool CachedResponseService::ServeCached(const std::string& key, grpc::ByteBuffer* response) {
+    auto entry = cache_.Get(key);
+    if (!entry) {
+        return false;
+    }
+    bool current = entry->index.empty()
+        ? service_.IsCurrentList(entry->endpoint, static_cast<const ListSnapshot*>(entry->source.get()))
+        : service_.IsCurrentItem(entry->endpoint, entry->index,
+                                 static_cast<const ApiClient::ItemResponse*>(entry->source.get()));
+    if (!current) {
+        cache_.RecordInvalidated(key);
+        return false;
+    }
+    cache_.RecordHit();
+    *response = std::move(entry->response);
+    return true;
+}
+
+void CachedResponseService::ServeList(
+    grpc::CallbackServerContext* context,
+    std::string key,
+    grpc::ByteBuffer* response,
+    grpc::ServerUnaryReactor* reactor) {
+    GetListRequest request;
+    if (!request.ParseFromArray(key.data() + 1, static_cast<int>(key.size() - 1))) {
+        reactor->Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Malformed GetList request"));
+        return;
+    }
+    GetListResponse message;
+    std::shared_ptr<const ListSnapshot> source;
+    grpc::Status status = service_.ServeList(context, &request, &message, &source);
+    if (status.ok()) {
+        status = SerializeResponse(message, response);
+    }
+    if (status.ok() && source) {
+        cache_.Put(key, {*response, request.endpoint(), std::string(), std::move(source)});
+    }
+    reactor->Finish(status);
+}
+
+void CachedResponseService::ServeItem(
+    grpc::CallbackServerContext* context,
+    std::string key,
+    grpc::ByteBuffer* response,
+    grpc::ServerUnaryReactor* reactor) {
+    GetItemRequest request;
+    if (!request.ParseFromArray(key.data() + 1, static_cast<int>(key.size() - 1))) {
+        reactor->Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Malformed GetItem request"));
+        return;
+    }
+    GetItemResponse message;
+    ItemCache::Value source;
+    grpc::Status status = service_.ServeItem(context, &request, &message, &source);
+    if (status.ok()) {
+        status = SerializeResponse(message, response);
+    }
+    // An empty index would read as a list entry; such items are simply not cached
+    if (status.ok() && source && service_.GetItemCache() && !request.index().empty()) {
+        cache_.Put(key, {*response, request.endpoint(), request.index(), std::move(source)});
+    }
+    reactor->Finish(status);
+}
+
+bool CachedResponseService::RunMiss(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(miss_mutex_);
+        if (misses_.size() >= miss_queue_capacity_) {
+            rejected_misses_++;
+            return false;
+        }
+        misses_.push_back(std::move(task));
+    }
+    miss_cv_.notify_one();
+    return true;
+}
+
+void CachedResponseService::MissWorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(miss_mutex_);
+            miss_cv_.wait(lock, [this]() { return stopping_ || !misses_.empty(); });
+            // Drain before exiting: every queued RPC still needs its Finish
+            if (misses_.empty()) {
+                return;
+            }
+            task = std::move(misses_.front());
+            misses_.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace dnd5e
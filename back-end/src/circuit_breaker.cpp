@@ -0,0 +1,67 @@
+#include "circuit_breaker.h"
+#include <stdexcept>
+
+namespace dnd5e {
+
+CircuitBreaker::CircuitBreaker(size_t failure_threshold, std::chrono::milliseconds open_duration)
+    : failure_threshold_(failure_threshold), open_duration_(open_duration),
+      state_(State::Closed), consecutive_failures_(0), trip_count_(0), rejected_count_(0) {
+    if (failure_threshold == 0) {
+        throw std::invalid_argument("Circuit breaker failure threshold must be positive");
+    }
+}
+
+bool CircuitBreaker::AllowRequest() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ == State::Closed) {
+            return true;
+        }
+
+        auto now = Clock::now();
+        if (now >= next_probe_at_) {
+            // Exactly one caller per window gets to find out whether upstream recovered
+            state_ = State::HalfOpen;
+            next_probe_at_ = now + open_duration_;
+            return true;
+        }
+    }
+
+    rejected_count_++;
+    return false;
+}
+
+void CircuitBreaker::RecordSuccess() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_ = State::Closed;
+    consecutive_failures_ = 0;
+}
+
+void CircuitBreaker::RecordFailure() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    consecutive_failures_++;
+    if (state_ == State::HalfOpen || (state_ == State::Closed && consecutive_failures_ >= failure_threshold_)) {
+        Trip();
+    }
+}
+
+CircuitBreaker::State CircuitBreaker::GetState() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_;
+}
+
+size_t CircuitBreaker::GetTripCount() const {
+    return trip_count_;
+}
+
+size_t CircuitBreaker::GetRejectedCount() const {
+    return rejected_count_;
+}
+
+void CircuitBreaker::Trip() {
+    state_ = State::Open;
+    next_probe_at_ = Clock::now() + open_duration_;
+    trip_count_++;
+}
+
+} // namespace dnd5e
@@ -0,0 +1,123 @@
+#include "curl_handle_pool.h"
+#include <stdexcept>
+#include <utility>
+
+namespace dnd5e {
+
+CurlHandlePool::Lease::Lease(CurlHandlePool* pool, CURL* handle)
+    : pool_(pool), handle_(handle) {
+}
+
+CurlHandlePool::Lease::~Lease() {
+    if (pool_ && handle_) {
+        pool_->Release(handle_);
+    }
+}
+
+CurlHandlePool::Lease::Lease(Lease&& other) noexcept
+    : pool_(std::exchange(other.pool_, nullptr)),
+      handle_(std::exchange(other.handle_, nullptr)) {
+}
+
+CurlHandlePool::Lease& CurlHandlePool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (pool_ && handle_) {
+            pool_->Release(handle_);
+        }
+        pool_ = std::exchange(other.pool_, nullptr);
+        handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+}
+
+CurlHandlePool::CurlHandlePool(HandleInitializer initializer, size_t max_idle_handles)
+    : initializer_(std::move(initializer)), max_idle_handles_(max_idle_handles), share_(nullptr) {
+    share_ = curl_share_init();
+    if (!share_) {
+        throw std::runtime_error("Failed to initialize cURL share handle");
+    }
+
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, LockCallback);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, UnlockCallback);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+
+    // Connection caches are not safe to share between concurrent threads in
+    // libcurl, so each pooled handle keeps its own and only DNS/TLS are shared
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+CurlHandlePool::~CurlHandlePool() {
+    for (CURL* handle : idle_handles_) {
+        curl_easy_cleanup(handle);
+    }
+    idle_handles_.clear();
+
+    if (share_) {
+        curl_share_cleanup(share_);
+        share_ = nullptr;
+    }
+}
+
+CurlHandlePool::Lease CurlHandlePool::Acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_handles_.empty()) {
+            CURL* handle = idle_handles_.back();
+            idle_handles_.pop_back();
+            return Lease(this, handle);
+        }
+    }
+
+    return Lease(this, CreateHandle());
+}
+
+CURLSH* CurlHandlePool::GetShare() const {
+    return share_;
+}
+
+size_t CurlHandlePool::GetIdleCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_handles_.size();
+}
+
+CURL* CurlHandlePool::CreateHandle() {
+    CURL* handle = curl_easy_init();
+    if (!handle) {
+        throw std::runtime_error("Failed to initialize cURL");
+    }
+
+    curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+    if (initializer_) {
+        initializer_(handle);
+    }
+
+    return handle;
+}
+
+void CurlHandlePool::Release(CURL* handle) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_handles_.size() < max_idle_handles_) {
+            idle_handles_.push_back(handle);
+            return;
+        }
+    }
+
+    curl_easy_cleanup(handle);
+}
+
+void CurlHandlePool::LockCallback(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr) {
+    (void)handle;
+    (void)access;
+    auto* pool = static_cast<CurlHandlePool*>(userptr);
+    pool->share_locks_[static_cast<size_t>(data)].lock();
+}
+
+void CurlHandlePool::UnlockCallback(CURL* handle, curl_lock_data data, void* userptr) {
+    (void)handle;
+    auto* pool = static_cast<CurlHandlePool*>(userptr);
+    pool->share_locks_[static_cast<size_t>(data)].unlock();
+}
+
+} // namespace dnd5e
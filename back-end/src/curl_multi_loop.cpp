@@ -0,0 +1,200 @@
+#include "curl_multi_loop.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace dnd5e {
+
+CurlMultiLoop::CurlMultiLoop(long max_host_connections, long max_concurrent_streams)
+    : multi_(nullptr), stopping_(false), active_count_(0) {
+    multi_ = curl_multi_init();
+    if (!multi_) {
+        throw std::runtime_error("Failed to initialize cURL multi handle");
+    }
+
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    if (max_host_connections > 0) {
+        curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+    }
+    if (max_concurrent_streams > 0) {
+        curl_multi_setopt(multi_, CURLMOPT_MAX_CONCURRENT_STREAMS, max_concurrent_streams);
+    }
+
+    thread_ = std::thread(&CurlMultiLoop::Run, this);
+}
+
+CurlMultiLoop::~CurlMultiLoop() {
+    stopping_ = true;
+    curl_multi_wakeup(multi_);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    AbortAll();
+    curl_multi_cleanup(multi_);
+}
+
+void CurlMultiLoop::Submit(CURL* handle, Completion on_complete) {
+    if (stopping_) {
+        on_complete(handle, CURLE_ABORTED_BY_CALLBACK);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.emplace_back(handle, std::move(on_complete));
+    }
+    active_count_++;
+    curl_multi_wakeup(multi_);
+}
+
+void CurlMultiLoop::Schedule(Clock::time_point when, std::function<void()> fn) {
+    // Kept while stopping too: AbortAll() runs it so its request still completes
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        timers_.emplace(when, std::move(fn));
+    }
+    curl_multi_wakeup(multi_);
+}
+
+void CurlMultiLoop::Cancel(CURL* handle) {
+    Completion on_complete;
+
+    auto it = active_.find(handle);
+    if (it != active_.end()) {
+        curl_multi_remove_handle(multi_, handle);
+        on_complete = std::move(it->second);
+        active_.erase(it);
+    } else {
+        // Submitted from this iteration's callbacks but not added to the multi handle yet
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto pending = std::find_if(pending_.begin(), pending_.end(),
+            [handle](const auto& entry) { return entry.first == handle; });
+        if (pending == pending_.end()) {
+            return;
+        }
+        on_complete = std::move(pending->second);
+        pending_.erase(pending);
+    }
+
+    active_count_--;
+    on_complete(handle, CURLE_ABORTED_BY_CALLBACK);
+}
+
+size_t CurlMultiLoop::GetActiveCount() const {
+    return active_count_;
+}
+
+void CurlMultiLoop::Run() {
+    while (!stopping_) {
+        AddPending();
+
+        int running = 0;
+        curl_multi_perform(multi_, &running);
+        DrainCompleted();
+        RunDueTimers();
+
+        // Sleeps until socket activity, the next timer or a Submit() wakeup
+        curl_multi_poll(multi_, nullptr, 0, GetPollTimeout(), nullptr);
+    }
+}
+
+void CurlMultiLoop::AddPending() {
+    std::vector<std::pair<CURL*, Completion>> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending.swap(pending_);
+    }
+
+    for (auto& [handle, on_complete] : pending) {
+        CURLMcode code = curl_multi_add_handle(multi_, handle);
+        if (code != CURLM_OK) {
+            active_count_--;
+            on_complete(handle, CURLE_FAILED_INIT);
+            continue;
+        }
+        active_.emplace(handle, std::move(on_complete));
+    }
+}
+
+void CurlMultiLoop::RunDueTimers() {
+    std::vector<std::function<void()>> due;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = Clock::now();
+        auto end = timers_.upper_bound(now);
+        for (auto it = timers_.begin(); it != end; ++it) {
+            due.push_back(std::move(it->second));
+        }
+        timers_.erase(timers_.begin(), end);
+    }
+
+    for (auto& fn : due) {
+        fn();
+    }
+}
+
+int CurlMultiLoop::GetPollTimeout() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (timers_.empty()) {
+        return 1000;
+    }
+
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(timers_.begin()->first - Clock::now());
+    // Round up so a timer is never polled for before it is due
+    return static_cast<int>(std::clamp<long long>(wait.count() + 1, 0, 1000));
+}
+
+void CurlMultiLoop::DrainCompleted() {
+    int remaining = 0;
+    while (CURLMsg* message = curl_multi_info_read(multi_, &remaining)) {
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+
+        CURL* handle = message->easy_handle;
+        CURLcode result = message->data.result;
+        curl_multi_remove_handle(multi_, handle);
+
+        auto it = active_.find(handle);
+        if (it == active_.end()) {
+            continue;
+        }
+        Completion on_complete = std::move(it->second);
+        active_.erase(it);
+        active_count_--;
+
+        on_complete(handle, result);
+    }
+}
+
+void CurlMultiLoop::AbortAll() {
+    AddPending();
+
+    // Callbacks may call Cancel(), so never iterate the live map
+    std::unordered_map<CURL*, Completion> active;
+    active.swap(active_);
+    for (auto& [handle, on_complete] : active) {
+        curl_multi_remove_handle(multi_, handle);
+        on_complete(handle, CURLE_ABORTED_BY_CALLBACK);
+    }
+    active_count_ = 0;
+
+    // Retry and hedge timers own requests someone may be waiting on. Run them
+    // now rather than drop them: with stopping_ set, whatever they submit
+    // fails at once, and the abort is not retried.
+    while (true) {
+        std::multimap<Clock::time_point, std::function<void()>> timers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            timers.swap(timers_);
+        }
+        if (timers.empty()) {
+            break;
+        }
+        for (auto& [when, fn] : timers) {
+            fn();
+        }
+    }
+}
+
+} // namespace dnd5e
@@ -0,0 +1,289 @@
+#include "curl_transport.h"
+#include "upstream_error.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <future>
+
+namespace dnd5e {
+
+namespace {
+    bool IsRetryableCurlError(CURLcode code) {
+        switch (code) {
+            case CURLE_ABORTED_BY_CALLBACK:  // cancelled hedge or shutdown
+            case CURLE_WRITE_ERROR:          // we rejected the body
+            case CURLE_FAILED_INIT:
+            case CURLE_URL_MALFORMAT:
+            case CURLE_UNSUPPORTED_PROTOCOL:
+                return false;
+            default:
+                return true;
+        }
+    }
+}
+
+CurlTransport::CurlTransport(const CurlTransportOptions& options)
+    : options_(options), next_request_id_(1) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    handle_pool_ = std::make_unique<CurlHandlePool>([this](CURL* handle) { ConfigureHandle(handle); });
+
+    if (options_.http2) {
+        // A single connection per host carries every request as an HTTP/2 stream
+        multi_loop_ = std::make_unique<CurlMultiLoop>(1L, options_.http2_max_streams);
+    } else {
+        multi_loop_ = std::make_unique<CurlMultiLoop>();
+    }
+
+    if (!options_.pin_dns_url.empty()) {
+        dns_pinner_ = std::make_unique<DnsPinner>(options_.pin_dns_url, std::chrono::milliseconds(options_.dns_refresh_ms));
+    }
+}
+
+CurlTransport::~CurlTransport() {
+    // In-flight async transfers hold pooled handles, so stop the loop first
+    multi_loop_.reset();
+    handle_pool_.reset();
+    curl_global_cleanup();
+}
+
+const char* CurlTransport::GetName() const {
+    return "curl";
+}
+
+void CurlTransport::ConfigureHandle(CURL* handle) const {
+    // Set common options
+    curl_easy_setopt(handle, CURLOPT_USERAGENT, "D&D-5e-Backend/1.0");
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 1L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 2L);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, options_.connect_timeout_ms);
+    // Empty string advertises every encoding libcurl was built with (gzip, br, zstd)
+    curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, HeaderCallback);
+
+    if (options_.http2) {
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        // Wait for the existing connection to accept another stream instead of opening a new one
+        curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+    }
+}
+
+void CurlTransport::Perform(const UpstreamRequest& request, UpstreamResponse& response) {
+    if (options_.http2) {
+        // Streams can only be multiplexed inside the multi handle, so block on the event loop
+        std::promise<void> done;
+        auto future = done.get_future();
+        // The caller's response outlives the wait, so lend it without taking ownership
+        std::shared_ptr<UpstreamResponse> borrowed(&response, [](UpstreamResponse*) {});
+        Submit(request, borrowed, [&done](std::exception_ptr error) {
+            if (error) {
+                done.set_exception(error);
+            } else {
+                done.set_value();
+            }
+        });
+        future.get();
+        return;
+    }
+
+    // Each caller checks out its own handle, so concurrent RPCs never share one
+    auto lease = handle_pool_->Acquire();
+    CURL* curl = lease.get();
+
+    DnsPinner::ResolveList resolve = dns_pinner_ ? dns_pinner_->GetResolveList() : nullptr;
+    curl_slist* headers = PrepareTransfer(curl, request, &response, resolve.get());
+    CURLcode res = curl_easy_perform(curl);
+    FinishTransfer(curl, headers);
+    CheckResult(curl, res, &response);
+}
+
+UpstreamTransport::RequestId CurlTransport::Submit(
+    const UpstreamRequest& request,
+    std::shared_ptr<UpstreamResponse> response,
+    Completion on_done) {
+
+    // The handle points into request.control until the transfer finishes
+    struct AsyncTransfer {
+        CurlHandlePool::Lease lease;
+        UpstreamRequest request;
+        std::shared_ptr<UpstreamResponse> response;
+        DnsPinner::ResolveList resolve;
+        curl_slist* headers;
+    };
+
+    auto transfer = std::make_shared<AsyncTransfer>(AsyncTransfer{
+        handle_pool_->Acquire(), request, std::move(response),
+        dns_pinner_ ? dns_pinner_->GetResolveList() : nullptr, nullptr});
+    CURL* curl = transfer->lease.get();
+    transfer->headers = PrepareTransfer(curl, transfer->request, transfer->response.get(), transfer->resolve.get());
+
+    RequestId id = next_request_id_++;
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        in_flight_.emplace(id, curl);
+    }
+
+    multi_loop_->Submit(curl, [this, id, transfer, on_done = std::move(on_done)](CURL* handle, CURLcode result) {
+        {
+            std::lock_guard<std::mutex> lock(in_flight_mutex_);
+            in_flight_.erase(id);
+        }
+        FinishTransfer(handle, transfer->headers);
+        transfer->headers = nullptr;
+
+        std::exception_ptr error;
+        try {
+            CheckResult(handle, result, transfer->response.get());
+        } catch (...) {
+            error = std::current_exception();
+        }
+        on_done(error);
+    });
+
+    return id;
+}
+
+void CurlTransport::Cancel(RequestId id) {
+    CURL* handle = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        auto it = in_flight_.find(id);
+        if (it == in_flight_.end()) {
+            return;
+        }
+        handle = it->second;
+    }
+    multi_loop_->Cancel(handle);
+}
+
+void CurlTransport::Schedule(Clock::time_point when, std::function<void()> fn) {
+    multi_loop_->Schedule(when, std::move(fn));
+}
+
+curl_slist* CurlTransport::PrepareTransfer(
+    CURL* handle,
+    const UpstreamRequest& request,
+    UpstreamResponse* response,
+    curl_slist* resolve) {
+
+    curl_easy_setopt(handle, CURLOPT_URL, request.url.c_str());
+    // Re-applied on every transfer so a refreshed address set takes effect
+    curl_easy_setopt(handle, CURLOPT_RESOLVE, resolve);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, static_cast<long>(request.timeout.count()));
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, response);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, response);
+
+    if (request.control.is_cancelled) {
+        // libcurl calls this at least once a second, even while the transfer is idle
+        curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, ProgressCallback);
+        curl_easy_setopt(handle, CURLOPT_XFERINFODATA, &request.control);
+    }
+
+    // Conditional request: upstream answers 304 with no body if nothing changed
+    curl_slist* headers = nullptr;
+    if (!request.validators.etag.empty()) {
+        headers = curl_slist_append(headers, ("If-None-Match: " + request.validators.etag).c_str());
+    }
+    if (!request.validators.last_modified.empty()) {
+        headers = curl_slist_append(headers, ("If-Modified-Since: " + request.validators.last_modified).c_str());
+    }
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
+
+    return headers;
+}
+
+void CurlTransport::FinishTransfer(CURL* handle, curl_slist* headers) {
+    // Pooled handles outlive the request, so drop pointers into its state
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, nullptr);
+    curl_easy_setopt(handle, CURLOPT_RESOLVE, nullptr);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, nullptr);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, nullptr);
+    curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 1L);
+    curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, nullptr);
+    curl_easy_setopt(handle, CURLOPT_XFERINFODATA, nullptr);
+    curl_slist_free_all(headers);
+}
+
+void CurlTransport::CheckResult(CURL* handle, CURLcode result, UpstreamResponse* response) {
+    if (result == CURLE_WRITE_ERROR && response->body_error) {
+        // The body consumer rejected the body and aborted the transfer
+        std::rethrow_exception(response->body_error);
+    }
+
+    if (result != CURLE_OK) {
+        std::string error_msg = "cURL error: ";
+        error_msg += curl_easy_strerror(result);
+        throw UpstreamError(error_msg, 0, IsRetryableCurlError(result));
+    }
+
+    long response_code;
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response_code);
+    response->status = response_code;
+
+    // Counts body bytes before content decoding, i.e. what crossed the wire
+    curl_off_t wire_bytes = 0;
+    curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &wire_bytes);
+    response->wire_bytes = static_cast<size_t>(wire_bytes);
+}
+
+size_t CurlTransport::WriteCallback(void* contents, size_t size, size_t nmemb, UpstreamResponse* response) {
+    size_t total_size = size * nmemb;
+    if (!response) {
+        return total_size;
+    }
+
+    // Never unwind through libcurl; returning short aborts the transfer
+    return response->AppendBody(static_cast<const char*>(contents), total_size) ? total_size : 0;
+}
+
+int CurlTransport::ProgressCallback(void* control, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    // Non-zero aborts the transfer with CURLE_ABORTED_BY_CALLBACK
+    return static_cast<const RequestControl*>(control)->IsCancelled() ? 1 : 0;
+}
+
+size_t CurlTransport::HeaderCallback(char* buffer, size_t size, size_t nitems, UpstreamResponse* response) {
+    size_t total_size = size * nitems;
+    if (!response) {
+        return total_size;
+    }
+
+    std::string line(buffer, total_size);
+
+    // A new status line means a redirect hop; only the final response counts
+    if (line.rfind("HTTP/", 0) == 0) {
+        response->validators = HttpValidators{};
+        size_t space = line.find(' ');
+        response->status = space != std::string::npos ? std::strtol(line.c_str() + space + 1, nullptr, 10) : 0;
+        return total_size;
+    }
+
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+        return total_size;
+    }
+
+    std::string name = line.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(),
+        [](unsigned char c) { return std::tolower(c); });
+
+    size_t value_start = line.find_first_not_of(" \t", colon + 1);
+    size_t value_end = line.find_last_not_of(" \t\r\n");
+    if (value_start == std::string::npos || value_end < value_start) {
+        return total_size;
+    }
+    std::string value = line.substr(value_start, value_end - value_start + 1);
+
+    if (name == "etag") {
+        response->validators.etag = value;
+    } else if (name == "last-modified") {
+        response->validators.last_modified = value;
+    }
+
+    return total_size;
+}
+
+} // namespace dnd5e
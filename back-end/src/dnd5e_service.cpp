@@ -2,13 +2,95 @@
 #include <grpcpp/grpcpp.h>
 #include <chrono>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <sstream>
 
 namespace dnd5e {
 
-Dnd5eServiceImpl::Dnd5eServiceImpl(std::shared_ptr<ApiClient> api_client)
-    : api_client_(api_client) {
-    search_engine_ = std::make_unique<SearchEngine>(api_client_);
+namespace {
+    // Upstream work for an RPC stops when its client gives up or runs out of time
+    RequestControl MakeRequestControl(grpc::ServerContextBase* context) {
+        RequestControl control;
+        if (!context) {
+            return control;
+        }
+        
+        auto deadline = context->deadline();
+        if (deadline != std::chrono::system_clock::time_point::max()) {
+            auto remaining = deadline - std::chrono::system_clock::now();
+            control.deadline = std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(remaining);
+        }
+        control.is_cancelled = [context]() { return context->IsCancelled(); };
+        return control;
+    }
+    
+    const char kCursorAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+    
+    // Cursors name the last item served rather than an offset, so they keep their
+    // place when the list is refreshed. Unpadded base64url of "<endpoint>\n<index>"
+    std::string EncodeCursor(const std::string& endpoint, const std::string& last_index) {
+        std::string plain = endpoint + "\n" + last_index;
+        std::string cursor;
+        uint32_t bits = 0;
+        int bit_count = 0;
+        for (unsigned char c : plain) {
+            bits = (bits << 8) | c;
+            bit_count += 8;
+            while (bit_count >= 6) {
+                bit_count -= 6;
+                cursor += kCursorAlphabet[(bits >> bit_count) & 0x3F];
+            }
+        }
+        if (bit_count > 0) {
+            cursor += kCursorAlphabet[(bits << (6 - bit_count)) & 0x3F];
+        }
+        return cursor;
+    }
+    
+    bool DecodeCursor(const std::string& cursor, const std::string& endpoint, std::string& last_index) {
+        std::string plain;
+        uint32_t bits = 0;
+        int bit_count = 0;
+        for (char c : cursor) {
+            const char* pos = std::strchr(kCursorAlphabet, c);
+            if (!pos || c == '\0') {
+                return false;
+            }
+            bits = (bits << 6) | static_cast<uint32_t>(pos - kCursorAlphabet);
+            bit_count += 6;
+            if (bit_count >= 8) {
+                bit_count -= 8;
+                plain += static_cast<char>((bits >> bit_count) & 0xFF);
+            }
+        }
+        
+        std::string prefix = endpoint + "\n";
+        if (plain.compare(0, prefix.size(), prefix) != 0 || plain.size() == prefix.size()) {
+            return false;
+        }
+        last_index = plain.substr(prefix.size());
+        return true;
+    }
+}
+
+Dnd5eServiceImpl::Dnd5eServiceImpl(std::shared_ptr<ApiClient> api_client, const ServiceOptions& options,
+                                   std::shared_ptr<L2Cache> l2_cache)
+    : api_client_(api_client), options_(options), l2_cache_(std::move(l2_cache)),
+      rejected_by_list_(0), negative_hits_(0), upstream_not_found_(0) {
+    if (options_.refresh_threads > 0) {
+        refresher_ = std::make_unique<BackgroundRefresher>(options_.refresh_threads);
+    }
+    search_engine_ = std::make_unique<SearchEngine>(api_client_, refresher_.get(), l2_cache_.get());
+    search_engine_->SetRefreshInterval(options_.cache_ttl, options_.cache_ttl_jitter);
+    search_engine_->SetResultCacheSize(options_.search_cache_entries);
+    if (options_.item_cache_bytes > 0) {
+        item_cache_ = std::make_unique<ItemCache>(options_.item_cache_bytes, 16, options_.item_cache_policy);
+    }
+    if (options_.negative_ttl.count() > 0) {
+        negative_cache_ = std::make_unique<NegativeCache>(options_.negative_ttl, options_.negative_cache_entries);
+    }
 }
 
 grpc::Status Dnd5eServiceImpl::GetEndpoints(
@@ -38,8 +120,15 @@ grpc::Status Dnd5eServiceImpl::GetList(
     grpc::ServerContext* context,
     const GetListRequest* request,
     GetListResponse* response) {
+    return ServeList(context, request, response, nullptr);
+}
+
+grpc::Status Dnd5eServiceImpl::ServeList(
+    grpc::ServerContextBase* context,
+    const GetListRequest* request,
+    GetListResponse* response,
+    std::shared_ptr<const ListSnapshot>* source) {
     
-    (void)context;
     try {
         const std::string& endpoint = request->endpoint();
         
@@ -48,29 +137,60 @@ grpc::Status Dnd5eServiceImpl::GetList(
                                "Invalid endpoint: " + endpoint);
         }
         
-        auto api_response = api_client_->GetList(endpoint);
+        if (request->page() < 0 || request->page_size() < 0) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                               "page and page_size must not be negative");
+        }
+        
+        std::string last_index;
+        if (!request->cursor().empty() && !DecodeCursor(request->cursor(), endpoint, last_index)) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid cursor");
+        }
+        
+        // Parsed once per refresh; every page is a slice of the same snapshot
+        auto snapshot = search_engine_->GetList(endpoint, MakeRequestControl(context));
+        if (source) {
+            *source = snapshot;
+        }
+        const auto& items = snapshot->items;
+        size_t page_size = static_cast<size_t>(request->page_size());
+        
+        size_t start_idx;
+        if (!last_index.empty()) {
+            auto position = snapshot->positions.find(last_index);
+            if (position == snapshot->positions.end()) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                   "Cursor item no longer in list: " + last_index);
+            }
+            start_idx = position->second + 1;
+        } else {
+            start_idx = static_cast<size_t>(request->page()) * page_size;
+        }
+        start_idx = std::min(start_idx, items.size());
+        size_t end_idx = std::min(start_idx + page_size, items.size());
         
         response->set_endpoint(endpoint);
-        response->set_total_count(api_response.count);
-        response->set_page(request->page());
+        response->set_total_count(static_cast<int32_t>(items.size()));
+        response->set_page(request->cursor().empty() || page_size == 0
+            ? request->page() : static_cast<int32_t>(start_idx / page_size));
         response->set_page_size(request->page_size());
         
-        // Apply pagination
-        int start_idx = request->page() * request->page_size();
-        int end_idx = std::min(start_idx + request->page_size(), 
-                              static_cast<int>(api_response.results.size()));
-        
-        bool has_more = end_idx < static_cast<int>(api_response.results.size());
+        bool has_more = end_idx < items.size();
         response->set_has_more(has_more);
+        if (has_more && end_idx > start_idx) {
+            response->set_next_cursor(EncodeCursor(endpoint, items[end_idx - 1].index));
+        }
         
         // Add items for current page
-        for (int i = start_idx; i < end_idx; ++i) {
-            auto* item = response->add_items();
-            *item = ConvertToProtoItem(api_response.results[i], endpoint);
+        response->mutable_items()->Reserve(static_cast<int>(end_idx - start_idx));
+        for (size_t i = start_idx; i < end_idx; ++i) {
+            *response->add_items() = ConvertToProtoItem(items[i], endpoint);
         }
         
         return grpc::Status::OK;
         
+    } catch (const UpstreamError& e) {
+        return UpstreamErrorStatus(e, "Failed to get list: ");
     } catch (const std::exception& e) {
         return grpc::Status(grpc::StatusCode::INTERNAL,
                            "Failed to get list: " + std::string(e.what()));
@@ -81,8 +201,15 @@ grpc::Status Dnd5eServiceImpl::GetItem(
     grpc::ServerContext* context,
     const GetItemRequest* request,
     GetItemResponse* response) {
+    return ServeItem(context, request, response, nullptr);
+}
+
+grpc::Status Dnd5eServiceImpl::ServeItem(
+    grpc::ServerContextBase* context,
+    const GetItemRequest* request,
+    GetItemResponse* response,
+    ItemCache::Value* source) {
     
-    (void)context;
     try {
         const std::string& endpoint = request->endpoint();
         const std::string& index = request->index();
@@ -92,25 +219,84 @@ grpc::Status Dnd5eServiceImpl::GetItem(
                                "Invalid endpoint: " + endpoint);
         }
         
-        auto item_data = api_client_->GetItem(endpoint, index);
+        // Scraped or typo'd indexes are answered here instead of costing an upstream 404
+        auto known = search_engine_->ContainsIndex(endpoint, index);
+        if (known.has_value() && !*known) {
+            rejected_by_list_++;
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, "Unknown item: " + endpoint + "/" + index);
+        }
+        std::string cache_key = ItemCache::MakeKey(endpoint, index);
+        if (negative_cache_ && negative_cache_->Contains(cache_key)) {
+            negative_hits_++;
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, "Unknown item: " + endpoint + "/" + index);
+        }
         
         // Create basic item info
-        ApiItem item;
-        item.set_index(index);
-        item.set_endpoint(endpoint);
+        ApiItem* item = response->mutable_item();
+        item->set_index(index);
+        item->set_endpoint(endpoint);
         
-        if (item_data.contains("name")) {
-            item.set_name(item_data["name"]);
-        }
-        if (item_data.contains("url")) {
-            item.set_url(item_data["url"]);
+        if (!item_cache_) {
+            auto item_data = api_client_->GetItem(endpoint, index, MakeRequestControl(context));
+            item->set_name(std::move(item_data.name));
+            item->set_url(std::move(item_data.url));
+            // Upstream bytes go out as-is; no parse/dump round trip
+            response->set_raw_data(std::move(item_data.raw_json));
+            return grpc::Status::OK;
         }
         
-        response->mutable_item()->CopyFrom(item);
-        response->set_raw_data(item_data.dump());
+        auto [cached, stale] = item_cache_->Get(cache_key);
+        if (!cached && l2_cache_) {
+            auto loaded = LoadItemFromL2(endpoint, index);
+            cached = std::move(loaded.value);
+            stale = loaded.stale;
+        }
+        if (cached && stale) {
+            if (refresher_) {
+                refresher_->Schedule("item:" + cache_key, [this, endpoint, index, cached = cached]() {
+                    try {
+                        RefreshItem(endpoint, index, cached, {});
+                    } catch (const UpstreamError& e) {
+                        if (e.GetHttpStatus() == 404) {
+                            RecordNotFound(endpoint, index);
+                        }
+                        throw;
+                    }
+                });
+            } else {
+                try {
+                    cached = RefreshItem(endpoint, index, cached, MakeRequestControl(context));
+                } catch (const UpstreamError& e) {
+                    // Upstream is struggling: a stale item beats no item
+                    if (!e.IsRetryable()) {
+                        throw;
+                    }
+                }
+            }
+        }
+        if (!cached) {
+            cached = std::make_shared<const ApiClient::ItemResponse>(
+                api_client_->GetItem(endpoint, index, MakeRequestControl(context)));
+            item_cache_->Put(cache_key, cached,
+                             std::chrono::steady_clock::now() + JitterTtl(options_.cache_ttl, options_.cache_ttl_jitter));
+            if (l2_cache_) {
+                l2_cache_->PutItem(endpoint, index, cached);
+            }
+        }
+        item->set_name(cached->name);
+        item->set_url(cached->url);
+        response->set_raw_data(cached->raw_json);
+        if (source) {
+            *source = std::move(cached);
+        }
         
         return grpc::Status::OK;
         
+    } catch (const UpstreamError& e) {
+        if (e.GetHttpStatus() == 404) {
+            RecordNotFound(request->endpoint(), request->index());
+        }
+        return UpstreamErrorStatus(e, "Failed to get item: ");
     } catch (const std::exception& e) {
         return grpc::Status(grpc::StatusCode::INTERNAL,
                            "Failed to get item: " + std::string(e.what()));
@@ -122,7 +308,6 @@ grpc::Status Dnd5eServiceImpl::SearchItems(
     const SearchItemsRequest* request,
     SearchItemsResponse* response) {
     
-    (void)context;
     try {
         const std::string& query = request->query();
         
@@ -136,12 +321,13 @@ grpc::Status Dnd5eServiceImpl::SearchItems(
             endpoints.push_back(request->endpoints(i));
         }
         
-        auto results = search_engine_->Search(query, endpoints, request->max_results());
+        // Shared with every repeat of the same search until its lists change
+        auto results = search_engine_->CachedSearch(query, endpoints, request->max_results(), MakeRequestControl(context));
         
         response->set_query(query);
-        response->set_total_found(static_cast<int32_t>(results.size()));
+        response->set_total_found(static_cast<int32_t>(results->size()));
         
-        for (const auto& result : results) {
+        for (const auto& result : *results) {
             auto* search_result = response->add_results();
             search_result->mutable_item()->CopyFrom(ConvertToProtoItem(result.item, result.endpoint));
             search_result->set_matched_field(result.matched_field);
@@ -150,6 +336,8 @@ grpc::Status Dnd5eServiceImpl::SearchItems(
         
         return grpc::Status::OK;
         
+    } catch (const UpstreamError& e) {
+        return UpstreamErrorStatus(e, "Failed to search items: ");
     } catch (const std::exception& e) {
         return grpc::Status(grpc::StatusCode::INTERNAL,
                            "Failed to search items: " + std::string(e.what()));
@@ -189,6 +377,109 @@ grpc::Status Dnd5eServiceImpl::HealthCheck(
     }
 }
 
+grpc::Status Dnd5eServiceImpl::UpstreamErrorStatus(const UpstreamError& error, const std::string& prefix) const {
+    if (dynamic_cast<const DeadlineExceededError*>(&error)) {
+        return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, prefix + error.what());
+    }
+    if (dynamic_cast<const RequestCancelledError*>(&error)) {
+        return grpc::Status(grpc::StatusCode::CANCELLED, prefix + error.what());
+    }
+    if (error.GetHttpStatus() == 404) {
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, prefix + error.what());
+    }
+    // UNAVAILABLE tells clients the failure is transient and worth retrying later
+    grpc::StatusCode code = error.IsRetryable() ? grpc::StatusCode::UNAVAILABLE : grpc::StatusCode::INTERNAL;
+    return grpc::Status(code, prefix + error.what());
+}
+
+bool Dnd5eServiceImpl::IsCurrentList(const std::string& endpoint, const ListSnapshot* source) const {
+    return source && search_engine_->GetFreshList(endpoint).get() == source;
+}
+
+bool Dnd5eServiceImpl::IsCurrentItem(const std::string& endpoint, const std::string& index,
+                                     const ApiClient::ItemResponse* source) const {
+    if (!source || !item_cache_ || search_engine_->ContainsIndex(endpoint, index) == false) {
+        return false;
+    }
+    auto [cached, stale] = item_cache_->Peek(ItemCache::MakeKey(endpoint, index));
+    return !stale && cached.get() == source;
+}
+
+const ItemCache* Dnd5eServiceImpl::GetItemCache() const {
+    return item_cache_.get();
+}
+
+const SearchEngine& Dnd5eServiceImpl::GetSearchEngine() const {
+    return *search_engine_;
+}
+
+const L2Cache* Dnd5eServiceImpl::GetL2Cache() const {
+    return l2_cache_.get();
+}
+
+NotFoundStats Dnd5eServiceImpl::GetNotFoundStats() const {
+    NotFoundStats stats;
+    stats.rejected_by_list = rejected_by_list_.load();
+    stats.negative_hits = negative_hits_.load();
+    stats.upstream_not_found = upstream_not_found_.load();
+    return stats;
+}
+
+const BackgroundRefresher* Dnd5eServiceImpl::GetRefresher() const {
+    return refresher_.get();
+}
+
+CacheSnapshotStats Dnd5eServiceImpl::SaveCacheSnapshot(const std::string& path) const {
+    return WriteCacheSnapshot(path, api_client_->GetBaseUrl(), *search_engine_, item_cache_.get());
+}
+
+std::optional<CacheSnapshotStats> Dnd5eServiceImpl::LoadCacheSnapshot(const std::string& path) {
+    return dnd5e::LoadCacheSnapshot(path, api_client_->GetBaseUrl(), *search_engine_, item_cache_.get());
+}
+
+ItemCache::Value Dnd5eServiceImpl::RefreshItem(const std::string& endpoint, const std::string& index,
+                                               const ItemCache::Value& current, const RequestControl& control) {
+    std::string cache_key = ItemCache::MakeKey(endpoint, index);
+    auto fresh_until = std::chrono::steady_clock::now() + JitterTtl(options_.cache_ttl, options_.cache_ttl_jitter);
+    auto item = api_client_->GetItemIfModified(endpoint, index, current->validators, control);
+    if (!item.has_value()) {
+        item_cache_->Touch(cache_key, fresh_until);
+        // Restarts the stored copy's age too
+        if (l2_cache_) {
+            l2_cache_->PutItem(endpoint, index, current);
+        }
+        return current;
+    }
+    auto refreshed = std::make_shared<const ApiClient::ItemResponse>(std::move(*item));
+    item_cache_->Put(cache_key, refreshed, fresh_until);
+    if (l2_cache_) {
+        l2_cache_->PutItem(endpoint, index, refreshed);
+    }
+    return refreshed;
+}
+
+void Dnd5eServiceImpl::RecordNotFound(const std::string& endpoint, const std::string& index) {
+    upstream_not_found_++;
+    std::string cache_key = ItemCache::MakeKey(endpoint, index);
+    if (item_cache_) {
+        item_cache_->Erase(cache_key);
+    }
+    if (negative_cache_) {
+        negative_cache_->Add(cache_key);
+    }
+}
+
+ItemCache::Lookup Dnd5eServiceImpl::LoadItemFromL2(const std::string& endpoint, const std::string& index) {
+    auto stored = l2_cache_->GetItem(endpoint, index);
+    if (!stored) {
+        return {};
+    }
+    auto fresh_until = L2Cache::FreshUntil(stored->stored_at, JitterTtl(options_.cache_ttl, options_.cache_ttl_jitter));
+    auto value = std::make_shared<const ApiClient::ItemResponse>(std::move(stored->item));
+    item_cache_->Put(ItemCache::MakeKey(endpoint, index), value, fresh_until);
+    return {value, std::chrono::steady_clock::now() >= fresh_until};
+}
+
 bool Dnd5eServiceImpl::IsValidEndpoint(const std::string& endpoint) const {
     return api_client_->IsValidEndpoint(endpoint);
 }
@@ -0,0 +1,154 @@
+#include "dns_pinner.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+namespace dnd5e {
+
+namespace {
+    std::string JoinAddresses(const std::vector<std::string>& addresses) {
+        std::string joined;
+        for (const auto& address : addresses) {
+            if (!joined.empty()) {
+                joined += ",";
+            }
+            joined += address;
+        }
+        return joined;
+    }
+}
+
+DnsPinner::DnsPinner(const std::string& url, std::chrono::milliseconds refresh_interval)
+    : port_(0), refresh_interval_(refresh_interval), stopping_(false), refresh_count_(0) {
+    CURLU* parsed = curl_url();
+    char* host = nullptr;
+    char* port = nullptr;
+    bool ok = parsed &&
+        curl_url_set(parsed, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK &&
+        curl_url_get(parsed, CURLUPART_HOST, &host, 0) == CURLUE_OK &&
+        curl_url_get(parsed, CURLUPART_PORT, &port, CURLU_DEFAULT_PORT) == CURLUE_OK;
+    if (ok) {
+        host_ = host;
+        port_ = std::strtol(port, nullptr, 10);
+    }
+    curl_free(host);
+    curl_free(port);
+    curl_url_cleanup(parsed);
+    if (!ok || host_.empty() || port_ <= 0) {
+        throw std::invalid_argument("Cannot pin DNS for URL: " + url);
+    }
+
+    // Startup pays for the first lookup so the first request does not
+    Refresh();
+    if (refresh_interval_.count() > 0) {
+        refresher_ = std::thread(&DnsPinner::RunRefresher, this);
+    }
+}
+
+DnsPinner::~DnsPinner() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stop_cv_.notify_all();
+    if (refresher_.joinable()) {
+        refresher_.join();
+    }
+}
+
+DnsPinner::ResolveList DnsPinner::GetResolveList() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return resolve_list_;
+}
+
+std::vector<std::string> DnsPinner::GetAddresses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return addresses_;
+}
+
+size_t DnsPinner::GetRefreshCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return refresh_count_;
+}
+
+void DnsPinner::Refresh() {
+    auto addresses = Resolve();
+    std::string target = host_ + ":" + std::to_string(port_);
+    if (addresses.empty()) {
+        std::cerr << "DNS lookup for " << target << " failed; keeping previous addresses" << std::endl;
+        return;
+    }
+
+    std::vector<std::string> previous;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refresh_count_++;
+        if (addresses == addresses_) {
+            return;
+        }
+        previous = addresses_;
+    }
+
+    // Pinned entries never expire from libcurl's DNS cache, so drop the old one first
+    curl_slist* list = curl_slist_append(nullptr, ("-" + target).c_str());
+    list = curl_slist_append(list, (target + ":" + JoinAddresses(addresses)).c_str());
+    ResolveList resolve_list(list, curl_slist_free_all);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        addresses_ = addresses;
+        resolve_list_ = std::move(resolve_list);
+    }
+
+    if (previous.empty()) {
+        std::cout << "Pinned upstream " << target << " to " << JoinAddresses(addresses) << std::endl;
+    } else {
+        std::cout << "Upstream " << target << " moved from " << JoinAddresses(previous)
+                  << " to " << JoinAddresses(addresses) << std::endl;
+    }
+}
+
+void DnsPinner::RunRefresher() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_cv_.wait_for(lock, refresh_interval_, [this]() { return stopping_; })) {
+        lock.unlock();
+        Refresh();
+        lock.lock();
+    }
+}
+
+std::vector<std::string> DnsPinner::Resolve() const {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* results = nullptr;
+    if (getaddrinfo(host_.c_str(), nullptr, &hints, &results) != 0) {
+        return {};
+    }
+
+    std::vector<std::string> addresses;
+    for (addrinfo* entry = results; entry; entry = entry->ai_next) {
+        char buffer[INET6_ADDRSTRLEN] = {};
+        std::string address;
+        if (entry->ai_family == AF_INET) {
+            inet_ntop(AF_INET, &reinterpret_cast<sockaddr_in*>(entry->ai_addr)->sin_addr, buffer, sizeof(buffer));
+            address = buffer;
+        } else if (entry->ai_family == AF_INET6) {
+            inet_ntop(AF_INET6, &reinterpret_cast<sockaddr_in6*>(entry->ai_addr)->sin6_addr, buffer, sizeof(buffer));
+            // CURLOPT_RESOLVE wants IPv6 literals bracketed
+            address = "[" + std::string(buffer) + "]";
+        }
+        if (!address.empty() && std::find(addresses.begin(), addresses.end(), address) == addresses.end()) {
+            addresses.push_back(address);
+        }
+    }
+    freeaddrinfo(results);
+    return addresses;
+}
+
+} // namespace dnd5e
@@ -0,0 +1,312 @@
+#include "fake_transport.h"
+#include "local_data_source.h"
+#include "upstream_error.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+namespace dnd5e {
+
+FakeTransport::FakeTransport(const FakeTransportOptions& options)
+    : options_(options), stopping_(false), generator_(options.seed), next_request_id_(1) {
+    if (options_.chunk_size == 0) {
+        throw std::invalid_argument("Fake upstream chunk size must be positive");
+    }
+    LoadEntries();
+    worker_ = std::thread(&FakeTransport::Run, this);
+}
+
+FakeTransport::~FakeTransport() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    worker_.join();
+
+    // Like an aborted transfer: everything still in flight fails once
+    for (auto& [id, on_done] : pending_) {
+        on_done(std::make_exception_ptr(UpstreamError("Fake upstream shut down", 0, false)));
+    }
+}
+
+const char* FakeTransport::GetName() const {
+    return "fake";
+}
+
+size_t FakeTransport::GetEntryCount() const {
+    return entries_.size();
+}
+
+void FakeTransport::LoadEntries() {
+    // The directory source already knows how to synthesize missing list files
+    auto source = OpenDataDirectory(options_.data_dir);
+    std::filesystem::path root(options_.data_dir);
+
+    std::set<std::string> endpoints;
+    for (const auto& file : std::filesystem::directory_iterator(root)) {
+        if (file.is_directory()) {
+            endpoints.insert(file.path().filename().string());
+        } else if (file.is_regular_file() && file.path().extension() == ".json") {
+            endpoints.insert(file.path().stem().string());
+        }
+    }
+
+    for (const auto& endpoint : endpoints) {
+        if (auto list = source->ReadList(endpoint)) {
+            entries_.emplace(endpoint, Entry{ScalePayload(endpoint, list->body), list->version});
+        }
+
+        std::error_code ec;
+        for (const auto& file : std::filesystem::directory_iterator(root / endpoint, ec)) {
+            if (!file.is_regular_file() || file.path().extension() != ".json") {
+                continue;
+            }
+            std::string key = endpoint + "/" + file.path().stem().string();
+            if (auto item = source->ReadItem(endpoint, file.path().stem().string())) {
+                entries_.emplace(key, Entry{ScalePayload(key, item->body), item->version});
+            }
+        }
+    }
+
+    if (entries_.empty()) {
+        throw std::invalid_argument("Fake upstream found no data in: " + options_.data_dir);
+    }
+}
+
+std::string FakeTransport::ScalePayload(const std::string& key, const std::string& body) const {
+    if (options_.payload_scale <= 1) {
+        return body;
+    }
+
+    auto json = nlohmann::json::parse(body, nullptr, false);
+    if (json.is_discarded() || !json.is_object()) {
+        return body;
+    }
+
+    if (key.find('/') == std::string::npos && json.contains("results") && json["results"].is_array()) {
+        // Lists grow by repeating their entries under distinct indexes
+        auto original = json["results"];
+        for (size_t copy = 1; copy < options_.payload_scale; ++copy) {
+            for (auto item : original) {
+                std::string suffix = "-" + std::to_string(copy);
+                item["index"] = item.value("index", "") + suffix;
+                item["url"] = item.value("url", "") + suffix;
+                json["results"].push_back(std::move(item));
+            }
+        }
+        json["count"] = json["results"].size();
+    } else {
+        // Items keep their fields and carry dead weight the parser has to skip
+        json["_padding"] = std::string(body.size() * (options_.payload_scale - 1), 'x');
+    }
+    return json.dump();
+}
+
+FakeTransport::Reply FakeTransport::Plan(const UpstreamRequest& request) {
+    std::string key = request.url;
+    if (!options_.base_url.empty() && key.compare(0, options_.base_url.size(), options_.base_url) == 0) {
+        key.erase(0, options_.base_url.size());
+    }
+    while (!key.empty() && key.front() == '/') {
+        key.erase(0, 1);
+    }
+    while (!key.empty() && key.back() == '/') {
+        key.pop_back();
+    }
+
+    auto it = entries_.find(key);
+    const Entry* entry = it != entries_.end() ? &it->second : nullptr;
+
+    double latency_ms;
+    double failure_draw;
+    {
+        // Draw order is fixed so a seed replays the same sequence of replies
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::lognormal_distribution<double> latency(std::log(std::max(options_.latency_median_ms, 0.001)),
+                                                    options_.latency_sigma);
+        latency_ms = latency(generator_);
+        if (uniform(generator_) < options_.tail_probability) {
+            latency_ms += options_.tail_latency_ms;
+        }
+        failure_draw = uniform(generator_);
+    }
+
+    Reply reply{Outcome::Ok, entry, std::chrono::microseconds(static_cast<long long>(latency_ms * 1000.0))};
+    if (failure_draw < options_.drop_rate) {
+        reply.outcome = Outcome::Dropped;
+    } else if (failure_draw < options_.drop_rate + options_.error_rate) {
+        reply.outcome = Outcome::ServerError;
+    } else if (!entry) {
+        reply.outcome = Outcome::NotFound;
+    } else if (!request.validators.etag.empty() && request.validators.etag == entry->etag) {
+        reply.outcome = Outcome::NotModified;
+    }
+
+    if (reply.delay > request.timeout) {
+        reply.outcome = Outcome::TimedOut;
+        reply.delay = request.timeout;
+    }
+    return reply;
+}
+
+void FakeTransport::Deliver(const Reply& reply, UpstreamResponse& response) const {
+    switch (reply.outcome) {
+        case Outcome::Dropped:
+            throw UpstreamError("Fake upstream dropped the connection", 0, true);
+        case Outcome::TimedOut:
+            throw UpstreamError("Fake upstream timed out", 0, true);
+        case Outcome::ServerError:
+            response.status = 503;
+            response.AppendBody("{\"error\":\"Service Unavailable\"}", 31);
+            break;
+        case Outcome::NotFound:
+            response.status = 404;
+            response.AppendBody("{\"error\":\"Not found\"}", 21);
+            break;
+        case Outcome::NotModified:
+            response.status = 304;
+            response.validators.etag = reply.entry->etag;
+            break;
+        case Outcome::Ok: {
+            response.status = 200;
+            response.validators.etag = reply.entry->etag;
+            const std::string& body = reply.entry->body;
+            for (size_t offset = 0; offset < body.size(); offset += options_.chunk_size) {
+                size_t size = std::min(options_.chunk_size, body.size() - offset);
+                if (!response.AppendBody(body.data() + offset, size)) {
+                    std::rethrow_exception(response.body_error);
+                }
+            }
+            break;
+        }
+    }
+    // Nothing is compressed in-process
+    response.wire_bytes = response.decoded_bytes;
+}
+
+void FakeTransport::Perform(const UpstreamRequest& request, UpstreamResponse& response) {
+    Reply reply = Plan(request);
+    auto due = Clock::now() + reply.delay;
+    while (Clock::now() < due) {
+        if (request.control.IsCancelled()) {
+            throw UpstreamError("Fake upstream request aborted", 0, false);
+        }
+        std::this_thread::sleep_until(std::min(due, Clock::now() + std::chrono::milliseconds(10)));
+    }
+    Deliver(reply, response);
+}
+
+UpstreamTransport::RequestId FakeTransport::Submit(
+    const UpstreamRequest& request,
+    std::shared_ptr<UpstreamResponse> response,
+    Completion on_done) {
+
+    Reply reply = Plan(request);
+    auto due = Clock::now() + reply.delay;
+
+    RequestId id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = next_request_id_++;
+        pending_.emplace(id, std::move(on_done));
+        timers_.emplace(due, [this, id, reply, response = std::move(response)]() {
+            Completion done;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = pending_.find(id);
+                if (it == pending_.end()) {
+                    // Cancelled while "on the wire"
+                    return;
+                }
+                done = std::move(it->second);
+                pending_.erase(it);
+            }
+
+            std::exception_ptr error;
+            try {
+                Deliver(reply, *response);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            done(error);
+        });
+    }
+    wakeup_.notify_one();
+
+    if (request.control.is_cancelled) {
+        PollCancellation(id, request.control);
+    }
+    return id;
+}
+
+void FakeTransport::PollCancellation(RequestId id, RequestControl control) {
+    Schedule(Clock::now() + std::chrono::milliseconds(10), [this, id, control = std::move(control)]() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_.find(id) == pending_.end()) {
+                return;
+            }
+        }
+        if (control.IsCancelled()) {
+            Cancel(id);
+        } else {
+            PollCancellation(id, control);
+        }
+    });
+}
+
+void FakeTransport::Cancel(RequestId id) {
+    Completion done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_.find(id);
+        if (it == pending_.end()) {
+            return;
+        }
+        done = std::move(it->second);
+        pending_.erase(it);
+    }
+    done(std::make_exception_ptr(UpstreamError("Fake upstream request cancelled", 0, false)));
+}
+
+void FakeTransport::Schedule(Clock::time_point when, std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        timers_.emplace(when, std::move(fn));
+    }
+    wakeup_.notify_one();
+}
+
+void FakeTransport::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (timers_.empty()) {
+            wakeup_.wait(lock);
+            continue;
+        }
+
+        auto next = timers_.begin();
+        if (next->first > Clock::now()) {
+            wakeup_.wait_until(lock, next->first);
+            continue;
+        }
+
+        auto fn = std::move(next->second);
+        timers_.erase(next);
+        lock.unlock();
+        try {
+            fn();
+        } catch (const std::exception& e) {
+            std::cerr << "Fake upstream callback threw: " << e.what() << std::endl;
+        }
+        lock.lock();
+    }
+}
+
+} // namespace dnd5e
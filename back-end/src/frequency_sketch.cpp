@@ -0,0 +1,64 @@
+#include "frequency_sketch.h"
+#include <algorithm>
+
+namespace dnd5e {
+
+namespace {
+    constexpr uint64_t kRowSeeds[] = {0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull,
+                                      0x85EBCA77C2B2AE63ull};
+    constexpr size_t kCountersPerWord = 16;
+}
+
+FrequencySketch::FrequencySketch(size_t width)
+    : words_per_row_(0), counter_mask_(0), additions_(0), sample_size_(0) {
+    size_t counters = kCountersPerWord;
+    while (counters < width) {
+        counters <<= 1;
+    }
+    words_per_row_ = counters / kCountersPerWord;
+    counter_mask_ = counters - 1;
+    table_.assign(kRows * words_per_row_, 0);
+    // TinyLFU's sample size: ten increments per counter before ageing
+    sample_size_ = 10 * counters;
+}
+
+size_t FrequencySketch::CounterIndex(uint64_t hash, size_t row) const {
+    uint64_t mixed = (hash + kRowSeeds[row]) * kRowSeeds[(row + 1) % kRows];
+    mixed ^= mixed >> 32;
+    return static_cast<size_t>(mixed) & counter_mask_;
+}
+
+void FrequencySketch::Increment(uint64_t hash) {
+    bool added = false;
+    for (size_t row = 0; row < kRows; ++row) {
+        size_t index = CounterIndex(hash, row);
+        uint64_t& word = table_[row * words_per_row_ + index / kCountersPerWord];
+        size_t shift = (index % kCountersPerWord) * 4;
+        if (((word >> shift) & 0xF) < 0xF) {
+            word += uint64_t{1} << shift;
+            added = true;
+        }
+    }
+    if (added && ++additions_ >= sample_size_) {
+        Halve();
+    }
+}
+
+uint32_t FrequencySketch::Estimate(uint64_t hash) const {
+    uint32_t estimate = 0xF;
+    for (size_t row = 0; row < kRows; ++row) {
+        size_t index = CounterIndex(hash, row);
+        uint64_t word = table_[row * words_per_row_ + index / kCountersPerWord];
+        estimate = std::min(estimate, static_cast<uint32_t>((word >> ((index % kCountersPerWord) * 4)) & 0xF));
+    }
+    return estimate;
+}
+
+void FrequencySketch::Halve() {
+    for (uint64_t& word : table_) {
+        word = (word >> 1) & 0x7777777777777777ull;
+    }
+    additions_ /= 2;
+}
+
+} // namespace dnd5e
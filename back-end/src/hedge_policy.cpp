@@ -0,0 +1,88 @@
+#include "hedge_policy.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace dnd5e {
+
+namespace {
+    // Re-sorting the window on every sample is wasted work; the tail moves slowly
+    constexpr size_t kRecomputeInterval = 16;
+}
+
+HedgePolicy::HedgePolicy(double percentile, double budget_ratio, size_t window_size, size_t min_samples)
+    : percentile_(percentile), budget_ratio_(budget_ratio), min_samples_(min_samples),
+      samples_(window_size), next_sample_(0), sample_count_(0), hedge_delay_(0),
+      tokens_(kMaxTokens), primary_requests_(0), hedges_sent_(0), hedges_won_(0), hedges_throttled_(0) {
+    if (percentile <= 0.0 || percentile >= 1.0) {
+        throw std::invalid_argument("Hedge percentile must be between 0 and 1");
+    }
+    if (budget_ratio < 0.0) {
+        throw std::invalid_argument("Hedge budget must not be negative");
+    }
+    if (window_size == 0) {
+        throw std::invalid_argument("Hedge latency window must not be empty");
+    }
+}
+
+std::optional<std::chrono::microseconds> HedgePolicy::GetHedgeDelay() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sample_count_ < min_samples_) {
+        return std::nullopt;
+    }
+    return hedge_delay_;
+}
+
+void HedgePolicy::RecordPrimary() {
+    primary_requests_++;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    tokens_ = std::min(kMaxTokens, tokens_ + budget_ratio_);
+}
+
+void HedgePolicy::RecordLatency(std::chrono::microseconds latency) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_[next_sample_] = latency;
+    next_sample_ = (next_sample_ + 1) % samples_.size();
+    sample_count_++;
+
+    if (sample_count_ == min_samples_ || sample_count_ % kRecomputeInterval == 0) {
+        RecomputeDelay();
+    }
+}
+
+bool HedgePolicy::TryAcquireHedge() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (tokens_ >= 1.0) {
+            tokens_ -= 1.0;
+            hedges_sent_++;
+            return true;
+        }
+    }
+    hedges_throttled_++;
+    return false;
+}
+
+void HedgePolicy::RecordHedgeWin() {
+    hedges_won_++;
+}
+
+HedgePolicy::Stats HedgePolicy::GetStats() const {
+    Stats stats;
+    stats.primary_requests = primary_requests_;
+    stats.hedges_sent = hedges_sent_;
+    stats.hedges_won = hedges_won_;
+    stats.hedges_throttled = hedges_throttled_;
+    return stats;
+}
+
+void HedgePolicy::RecomputeDelay() {
+    size_t filled = std::min(sample_count_, samples_.size());
+    std::vector<std::chrono::microseconds> window(samples_.begin(), samples_.begin() + filled);
+
+    size_t rank = std::min(filled - 1, static_cast<size_t>(percentile_ * static_cast<double>(filled)));
+    std::nth_element(window.begin(), window.begin() + rank, window.end());
+    hedge_delay_ = window[rank];
+}
+
+} // namespace dnd5e
@@ -0,0 +1,285 @@
+#include "item_cache.h"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+
+namespace dnd5e {
+
+namespace {
+    // Rough per-entry bookkeeping (list node, hash node, control block)
+    constexpr size_t kEntryOverhead = 160;
+    // Typical entry size, for sizing the frequency sketch to the entry count
+    constexpr size_t kTypicalEntryBytes = 2048;
+}
+
+ItemCache::ItemCache(size_t capacity_bytes, size_t shard_count, CachePolicy policy)
+    : capacity_bytes_(capacity_bytes), shard_capacity_(0), policy_(policy), window_capacity_(0),
+      main_capacity_(0), protected_capacity_(0) {
+    if (shard_count == 0) {
+        throw std::invalid_argument("Item cache needs at least one shard");
+    }
+    shard_capacity_ = capacity_bytes_ / shard_count;
+    size_t sketch_width = 0;
+    if (policy_ == CachePolicy::TinyLfu) {
+        // W-TinyLFU's split: 1% window, main 20% probation / 80% protected
+        window_capacity_ = std::max<size_t>(shard_capacity_ / 100, 1);
+        main_capacity_ = shard_capacity_ - window_capacity_;
+        protected_capacity_ = main_capacity_ / 10 * 8;
+        sketch_width = std::max<size_t>(shard_capacity_ / kTypicalEntryBytes, 64);
+    } else {
+        window_capacity_ = shard_capacity_;
+    }
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>(sketch_width));
+    }
+}
+
+std::string ItemCache::MakeKey(const std::string& endpoint, const std::string& index) {
+    return endpoint + "/" + index;
+}
+
+ItemCache::Lookup ItemCache::Get(const std::string& key) {
+    auto now = Clock::now();
+    size_t hash = std::hash<std::string>{}(key);
+    Shard& shard = GetShard(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // Misses count too: they are the candidates admission will judge
+    if (policy_ == CachePolicy::TinyLfu) {
+        shard.sketch.Increment(hash);
+    }
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        shard.misses++;
+        return {};
+    }
+
+    auto entry = it->second;
+    if (entry->segment == Segment::Probation) {
+        // A second hit earns protection; overflow falls back to probation
+        MoveTo(shard, entry, Segment::Protected);
+        while (shard.protected_bytes > protected_capacity_) {
+            MoveTo(shard, std::prev(shard.protected_main.end()), Segment::Probation);
+        }
+    } else {
+        MoveTo(shard, entry, entry->segment);
+    }
+    Lookup lookup{entry->value, now >= entry->fresh_until};
+    if (lookup.stale) {
+        shard.stale_hits++;
+    } else {
+        shard.fresh_hits++;
+    }
+    return lookup;
+}
+
+ItemCache::Lookup ItemCache::Peek(const std::string& key) const {
+    auto now = Clock::now();
+    Shard& shard = GetShard(std::hash<std::string>{}(key));
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        return {};
+    }
+    return {it->second->value, now >= it->second->fresh_until};
+}
+
+void ItemCache::Put(const std::string& key, Value value, Clock::time_point fresh_until) {
+    if (!value) {
+        return;
+    }
+    size_t charge = GetCharge(key, *value);
+    if (charge > shard_capacity_) {
+        return;
+    }
+
+    size_t hash = std::hash<std::string>{}(key);
+    Shard& shard = GetShard(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        auto entry = it->second;
+        size_t& bytes = GetBytes(shard, entry->segment);
+        bytes = bytes - entry->charge + charge;
+        entry->value = std::move(value);
+        entry->charge = charge;
+        entry->fresh_until = fresh_until;
+        MoveTo(shard, entry, entry->segment);
+    } else {
+        shard.window.push_front(Entry{key, hash, std::move(value), charge, fresh_until, Segment::Window});
+        shard.window_bytes += charge;
+        shard.index.emplace(key, shard.window.begin());
+        shard.insertions++;
+    }
+    Rebalance(shard);
+}
+
+void ItemCache::Rebalance(Shard& shard) {
+    while (shard.window_bytes > window_capacity_) {
+        auto candidate = std::prev(shard.window.end());
+        if (policy_ == CachePolicy::TinyLfu) {
+            Admit(shard, candidate);
+        } else {
+            Remove(shard, candidate);
+            shard.evictions++;
+        }
+    }
+    // Only reached when an entry in main grew
+    while (shard.probation_bytes + shard.protected_bytes > main_capacity_) {
+        auto& victims = shard.probation.empty() ? shard.protected_main : shard.probation;
+        Remove(shard, std::prev(victims.end()));
+        shard.evictions++;
+    }
+}
+
+void ItemCache::Admit(Shard& shard, EntryList::iterator candidate) {
+    uint32_t frequency = shard.sketch.Estimate(candidate->hash);
+    size_t used = shard.probation_bytes + shard.protected_bytes;
+
+    // Judge every victim the candidate would displace, in eviction order,
+    // before evicting any: a rejected candidate must leave main untouched
+    size_t victim_count = 0;
+    for (auto* victims : {&shard.probation, &shard.protected_main}) {
+        for (auto it = victims->rbegin(); it != victims->rend() && used + candidate->charge > main_capacity_; ++it) {
+            // Ties go to the incumbent, so a one-hit wonder never displaces anything
+            if (frequency <= shard.sketch.Estimate(it->hash)) {
+                Remove(shard, candidate);
+                shard.rejections++;
+                return;
+            }
+            used -= it->charge;
+            victim_count++;
+        }
+    }
+    if (used + candidate->charge > main_capacity_) {
+        Remove(shard, candidate);
+        shard.rejections++;
+        return;
+    }
+
+    for (size_t i = 0; i < victim_count; ++i) {
+        auto& victims = shard.probation.empty() ? shard.protected_main : shard.probation;
+        Remove(shard, std::prev(victims.end()));
+        shard.evictions++;
+    }
+    MoveTo(shard, candidate, Segment::Probation);
+}
+
+ItemCache::EntryList& ItemCache::GetList(Shard& shard, Segment segment) {
+    switch (segment) {
+        case Segment::Window:
+            return shard.window;
+        case Segment::Probation:
+            return shard.probation;
+        case Segment::Protected:
+            break;
+    }
+    return shard.protected_main;
+}
+
+size_t& ItemCache::GetBytes(Shard& shard, Segment segment) {
+    switch (segment) {
+        case Segment::Window:
+            return shard.window_bytes;
+        case Segment::Probation:
+            return shard.probation_bytes;
+        case Segment::Protected:
+            break;
+    }
+    return shard.protected_bytes;
+}
+
+void ItemCache::MoveTo(Shard& shard, EntryList::iterator entry, Segment segment) {
+    if (entry->segment != segment) {
+        GetBytes(shard, entry->segment) -= entry->charge;
+        GetBytes(shard, segment) += entry->charge;
+    }
+    // splice keeps the iterator in index valid
+    GetList(shard, segment).splice(GetList(shard, segment).begin(), GetList(shard, entry->segment), entry);
+    entry->segment = segment;
+}
+
+void ItemCache::Remove(Shard& shard, EntryList::iterator entry) {
+    GetBytes(shard, entry->segment) -= entry->charge;
+    shard.index.erase(entry->key);
+    GetList(shard, entry->segment).erase(entry);
+}
+
+void ItemCache::Touch(const std::string& key, Clock::time_point fresh_until) {
+    Shard& shard = GetShard(std::hash<std::string>{}(key));
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        it->second->fresh_until = fresh_until;
+    }
+}
+
+void ItemCache::Erase(const std::string& key) {
+    Shard& shard = GetShard(std::hash<std::string>{}(key));
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        Remove(shard, it->second);
+    }
+}
+
+void ItemCache::Clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->window.clear();
+        shard->probation.clear();
+        shard->protected_main.clear();
+        shard->index.clear();
+        shard->window_bytes = 0;
+        shard->probation_bytes = 0;
+        shard->protected_bytes = 0;
+    }
+}
+
+std::vector<ItemCache::Exported> ItemCache::Export() const {
+    std::vector<Exported> exported;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        exported.reserve(exported.size() + shard->index.size());
+        for (const EntryList* entries : {&shard->probation, &shard->protected_main, &shard->window}) {
+            for (auto it = entries->rbegin(); it != entries->rend(); ++it) {
+                exported.push_back({it->key, it->value, it->fresh_until});
+            }
+        }
+    }
+    return exported;
+}
+
+ItemCache::Stats ItemCache::GetStats() const {
+    Stats stats;
+    stats.capacity_bytes = capacity_bytes_;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.fresh_hits += shard->fresh_hits;
+        stats.stale_hits += shard->stale_hits;
+        stats.misses += shard->misses;
+        stats.insertions += shard->insertions;
+        stats.evictions += shard->evictions;
+        stats.rejections += shard->rejections;
+        stats.entries += shard->index.size();
+        stats.bytes += shard->window_bytes + shard->probation_bytes + shard->protected_bytes;
+    }
+    return stats;
+}
+
+ItemCache::Shard& ItemCache::GetShard(size_t hash) const {
+    return *shards_[hash % shards_.size()];
+}
+
+size_t ItemCache::GetCharge(const std::string& key, const ApiClient::ItemResponse& item) {
+    // The key is stored twice: in the entry and in the lookup map
+    return 2 * key.size() + item.raw_json.size() + item.name.size() + item.url.size() +
+           item.validators.etag.size() + item.validators.last_modified.size() + kEntryOverhead;
+}
+
+} // namespace dnd5e
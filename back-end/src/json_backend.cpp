@@ -0,0 +1,118 @@
+#include "json_backend.h"
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+#ifdef DND5E_HAVE_SIMDJSON
+#include <simdjson.h>
+#endif
+
+namespace dnd5e {
+
+namespace {
+
+class NlohmannJsonBackend final : public JsonBackend {
+public:
+    const char* GetName() const override {
+        return "nlohmann";
+    }
+
+    ItemFields ExtractItemFields(const std::string& body) const override {
+        try {
+            auto json = nlohmann::json::parse(body);
+            if (!json.is_object()) {
+                throw std::runtime_error("Failed to parse JSON response: expected an object");
+            }
+
+            ItemFields fields;
+            auto name = json.find("name");
+            if (name != json.end() && name->is_string()) {
+                fields.name = name->get<std::string>();
+            }
+            auto url = json.find("url");
+            if (url != json.end() && url->is_string()) {
+                fields.url = url->get<std::string>();
+            }
+            return fields;
+        } catch (const nlohmann::json::exception& e) {
+            throw std::runtime_error("Failed to parse JSON response: " + std::string(e.what()));
+        }
+    }
+};
+
+#ifdef DND5E_HAVE_SIMDJSON
+class SimdjsonJsonBackend final : public JsonBackend {
+public:
+    const char* GetName() const override {
+        return "simdjson";
+    }
+
+    ItemFields ExtractItemFields(const std::string& body) const override {
+        // On-demand parsers hold per-document buffers and are not thread-safe
+        thread_local simdjson::ondemand::parser parser;
+
+        // Only copy when the string lacks the padding simdjson reads past the end
+        simdjson::padded_string padded_copy;
+        simdjson::padded_string_view view;
+        if (body.capacity() - body.size() >= simdjson::SIMDJSON_PADDING) {
+            view = simdjson::padded_string_view(body.data(), body.size(), body.capacity());
+        } else {
+            padded_copy = simdjson::padded_string(body);
+            view = padded_copy;
+        }
+
+        simdjson::ondemand::document doc;
+        simdjson::ondemand::object object;
+        auto error = parser.iterate(view).get(doc);
+        if (!error) {
+            error = doc.get_object().get(object);
+        }
+        if (error) {
+            throw std::runtime_error("Failed to parse JSON response: " + std::string(simdjson::error_message(error)));
+        }
+
+        ItemFields fields;
+        fields.name = ExtractString(object, "name");
+        fields.url = ExtractString(object, "url");
+        return fields;
+    }
+
+private:
+    static std::string ExtractString(simdjson::ondemand::object& object, const char* key) {
+        std::string_view value;
+        // Unordered lookup: "url" usually sits after every nested block
+        auto error = object.find_field_unordered(key).get_string().get(value);
+        if (error == simdjson::NO_SUCH_FIELD || error == simdjson::INCORRECT_TYPE) {
+            return {};
+        }
+        if (error) {
+            throw std::runtime_error("Failed to parse JSON response: " + std::string(simdjson::error_message(error)));
+        }
+        return std::string(value);
+    }
+};
+#endif
+
+} // namespace
+
+std::unique_ptr<JsonBackend> CreateJsonBackend(const std::string& name) {
+#ifdef DND5E_HAVE_SIMDJSON
+    if (name.empty() || name == "simdjson") {
+        return std::make_unique<SimdjsonJsonBackend>();
+    }
+#endif
+    if (name.empty() || name == "nlohmann") {
+        return std::make_unique<NlohmannJsonBackend>();
+    }
+    throw std::invalid_argument("Unknown or unavailable JSON backend: " + name);
+}
+
+std::vector<std::string> GetAvailableJsonBackends() {
+    std::vector<std::string> backends;
+#ifdef DND5E_HAVE_SIMDJSON
+    backends.push_back("simdjson");
+#endif
+    backends.push_back("nlohmann");
+    return backends;
+}
+
+} // namespace dnd5e
@@ -0,0 +1,622 @@
+#include "kv_store_cache.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bounded_queue.h"
+#include "search_engine.h"
+
+namespace dnd5e {
+
+namespace {
+
+// Log layout (host byte order):
+//   header   magic[8] "DND5KVLG", u32 format version, u32 reserved
+//   records  u32 checksum, u32 key size, u32 value size, u32 reserved,
+//            i64 stored at (unix ms), key bytes, value bytes
+// The checksum is FNV-1a over the rest of the record. A later record for the
+// same key replaces the earlier one.
+// Keys: "i:<endpoint>/<index>" for items, "l:<endpoint>" for lists.
+// Item value: u32 ETag, Last-Modified, name and url sizes, those bytes, raw JSON to the end.
+// List value: u32 ETag and Last-Modified sizes, u32 item count, those bytes,
+//             then per item u32 index/name/url sizes and bytes.
+constexpr char kLogMagic[8] = {'D', 'N', 'D', '5', 'K', 'V', 'L', 'G'};
+constexpr uint32_t kLogFormatVersion = 1;
+constexpr size_t kLogHeaderSize = sizeof(kLogMagic) + 2 * sizeof(uint32_t);
+// A compaction rewrites every live record. One that reclaims less than this
+// share of max_bytes is run at most once per kCompactionBackoff, so a store
+// full of live records does not rewrite itself for every batch
+constexpr size_t kMinCompactionGainShare = 8;
+constexpr auto kCompactionBackoff = std::chrono::seconds(10);
+
+struct RecordHeader {
+    uint32_t checksum;
+    uint32_t key_size;
+    uint32_t value_size;
+    uint32_t reserved;
+    int64_t stored_at_ms;
+};
+static_assert(sizeof(RecordHeader) == 24, "RecordHeader must have no padding");
+
+uint32_t Fnv1a(uint32_t hash, const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t RecordChecksum(const RecordHeader& header, std::string_view key, std::string_view value) {
+    uint32_t hash = 2166136261u;
+    hash = Fnv1a(hash, reinterpret_cast<const char*>(&header) + sizeof(header.checksum),
+                 sizeof(header) - sizeof(header.checksum));
+    hash = Fnv1a(hash, key.data(), key.size());
+    return Fnv1a(hash, value.data(), value.size());
+}
+
+void AppendU32(std::string& buffer, size_t value) {
+    auto narrowed = static_cast<uint32_t>(value);
+    buffer.append(reinterpret_cast<const char*>(&narrowed), sizeof(narrowed));
+}
+
+std::string EncodeItem(const ApiClient::ItemResponse& item) {
+    std::string value;
+    value.reserve(16 + item.validators.etag.size() + item.validators.last_modified.size() + item.name.size() +
+                  item.url.size() + item.raw_json.size());
+    AppendU32(value, item.validators.etag.size());
+    AppendU32(value, item.validators.last_modified.size());
+    AppendU32(value, item.name.size());
+    AppendU32(value, item.url.size());
+    value += item.validators.etag;
+    value += item.validators.last_modified;
+    value += item.name;
+    value += item.url;
+    value += item.raw_json;
+    return value;
+}
+
+std::string EncodeList(const ListSnapshot& list, const ApiClient::Validators& validators) {
+    std::string value;
+    AppendU32(value, validators.etag.size());
+    AppendU32(value, validators.last_modified.size());
+    AppendU32(value, list.items.size());
+    value += validators.etag;
+    value += validators.last_modified;
+    for (const auto& item : list.items) {
+        AppendU32(value, item.index.size());
+        AppendU32(value, item.name.size());
+        AppendU32(value, item.url.size());
+        value += item.index;
+        value += item.name;
+        value += item.url;
+    }
+    return value;
+}
+
+// Bounds-checked cursor over a value in the mapping
+class ValueReader {
+public:
+    explicit ValueReader(std::string_view data) : data_(data) {
+    }
+
+    uint32_t ReadU32() {
+        Require(sizeof(uint32_t));
+        uint32_t value;
+        std::memcpy(&value, data_.data(), sizeof(value));
+        data_.remove_prefix(sizeof(value));
+        return value;
+    }
+
+    std::string ReadString(uint32_t size) {
+        Require(size);
+        std::string value(data_.substr(0, size));
+        data_.remove_prefix(size);
+        return value;
+    }
+
+    std::string ReadRest() {
+        std::string value(data_);
+        data_ = {};
+        return value;
+    }
+
+private:
+    std::string_view data_;
+
+    void Require(size_t size) const {
+        if (size > data_.size()) {
+            throw std::runtime_error("Corrupt KV store value");
+        }
+    }
+};
+
+ApiClient::ItemResponse DecodeItem(std::string_view value) {
+    ValueReader reader(value);
+    auto etag_size = reader.ReadU32();
+    auto last_modified_size = reader.ReadU32();
+    auto name_size = reader.ReadU32();
+    auto url_size = reader.ReadU32();
+    ApiClient::ItemResponse item;
+    item.validators.etag = reader.ReadString(etag_size);
+    item.validators.last_modified = reader.ReadString(last_modified_size);
+    item.name = reader.ReadString(name_size);
+    item.url = reader.ReadString(url_size);
+    item.raw_json = reader.ReadRest();
+    return item;
+}
+
+L2Cache::StoredList DecodeList(std::string_view value) {
+    ValueReader reader(value);
+    auto etag_size = reader.ReadU32();
+    auto last_modified_size = reader.ReadU32();
+    auto count = reader.ReadU32();
+    L2Cache::StoredList list;
+    list.validators.etag = reader.ReadString(etag_size);
+    list.validators.last_modified = reader.ReadString(last_modified_size);
+    // Each item needs at least its three sizes; caps the reserve on a corrupt count
+    list.items.reserve(std::min<size_t>(count, value.size() / (3 * sizeof(uint32_t))));
+    for (uint32_t i = 0; i < count; ++i) {
+        auto index_size = reader.ReadU32();
+        auto name_size = reader.ReadU32();
+        auto url_size = reader.ReadU32();
+        ApiClient::ApiItem item;
+        item.index = reader.ReadString(index_size);
+        item.name = reader.ReadString(name_size);
+        item.url = reader.ReadString(url_size);
+        list.items.push_back(std::move(item));
+    }
+    return list;
+}
+
+void WriteAll(int fd, const char* data, size_t size, size_t offset) {
+    while (size > 0) {
+        ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("KV store write failed: ") + std::strerror(errno));
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<size_t>(written);
+    }
+}
+
+int64_t NowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+class KvStoreCache final : public L2Cache {
+public:
+    explicit KvStoreCache(const KvStoreOptions& options)
+        : options_(options),
+          fd_(-1),
+          mapping_(nullptr),
+          mapping_size_(0),
+          end_(0),
+          live_bytes_(0),
+          queue_(options.queue_capacity),
+          stopping_(false),
+          hits_(0), misses_(0), errors_(0), writes_queued_(0), writes_stored_(0), writes_dropped_(0),
+          compactions_(0) {
+        fd_ = OpenLog(options_.path);
+        try {
+            Load();
+        } catch (...) {
+            if (mapping_) {
+                ::munmap(const_cast<char*>(mapping_), mapping_size_);
+            }
+            ::close(fd_);
+            throw;
+        }
+        writer_ = std::thread(&KvStoreCache::RunWriter, this);
+    }
+
+    ~KvStoreCache() override {
+        stopping_ = true;
+        writer_.join();
+        ::munmap(const_cast<char*>(mapping_), mapping_size_);
+        ::close(fd_);
+    }
+
+    KvStoreCache(const KvStoreCache&) = delete;
+    KvStoreCache& operator=(const KvStoreCache&) = delete;
+    KvStoreCache(KvStoreCache&&) = delete;
+    KvStoreCache& operator=(KvStoreCache&&) = delete;
+
+    const char* GetName() const override {
+        return "kv-store";
+    }
+
+    std::optional<StoredItem> GetItem(const std::string& endpoint, const std::string& index) override {
+        std::string key = ItemKey(endpoint, index);
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            misses_++;
+            return std::nullopt;
+        }
+        try {
+            StoredItem stored;
+            stored.item = DecodeItem(ValueAt(it->second));
+            stored.stored_at = SystemClock::time_point(std::chrono::milliseconds(it->second.stored_at_ms));
+            hits_++;
+            return stored;
+        } catch (const std::exception& e) {
+            errors_++;
+            misses_++;
+            std::cerr << "KV store cache error for " << key << ": " << e.what() << std::endl;
+            return std::nullopt;
+        }
+    }
+
+    std::optional<StoredList> GetList(const std::string& endpoint) override {
+        std::string key = ListKey(endpoint);
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            misses_++;
+            return std::nullopt;
+        }
+        try {
+            StoredList stored = DecodeList(ValueAt(it->second));
+            stored.stored_at = SystemClock::time_point(std::chrono::milliseconds(it->second.stored_at_ms));
+            hits_++;
+            return stored;
+        } catch (const std::exception& e) {
+            errors_++;
+            misses_++;
+            std::cerr << "KV store cache error for " << key << ": " << e.what() << std::endl;
+            return std::nullopt;
+        }
+    }
+
+    void PutItem(const std::string& endpoint, const std::string& index,
+                 std::shared_ptr<const ApiClient::ItemResponse> item) override {
+        Write write;
+        write.key = ItemKey(endpoint, index);
+        write.item = std::move(item);
+        Enqueue(std::move(write));
+    }
+
+    void PutList(const std::string& endpoint, std::shared_ptr<const ListSnapshot> list,
+                 const ApiClient::Validators& validators) override {
+        Write write;
+        write.key = ListKey(endpoint);
+        write.list = std::move(list);
+        write.validators = validators;
+        Enqueue(std::move(write));
+    }
+
+    L2CacheStats GetStats() const override {
+        L2CacheStats stats;
+        stats.hits = hits_.load();
+        stats.misses = misses_.load();
+        stats.errors = errors_.load();
+        stats.writes_queued = writes_queued_.load();
+        stats.writes_stored = writes_stored_.load();
+        stats.writes_dropped = writes_dropped_.load();
+        stats.compactions = compactions_.load();
+        return stats;
+    }
+
+private:
+    // Exactly one of item or list is set; encoded on the writer thread
+    struct Write {
+        std::string key;
+        std::shared_ptr<const ApiClient::ItemResponse> item;
+        std::shared_ptr<const ListSnapshot> list;
+        ApiClient::Validators validators;
+    };
+
+    struct Location {
+        size_t offset;
+        uint32_t key_size;
+        uint32_t value_size;
+        int64_t stored_at_ms;
+
+        size_t RecordSize() const {
+            return sizeof(RecordHeader) + key_size + value_size;
+        }
+    };
+
+    KvStoreOptions options_;
+    int fd_;
+    // Read-only view of the whole reserved range; only [0, end_) is backed by the file
+    const char* mapping_;
+    size_t mapping_size_;
+    size_t end_;
+    // Bytes of records still in index_; the rest is garbage for compaction
+    size_t live_bytes_;
+    std::unordered_map<std::string, Location> index_;
+    // Guards mapping_, end_ and index_. Only the writer thread changes them
+    mutable std::shared_mutex mutex_;
+    BoundedMpmcQueue<Write> queue_;
+    std::atomic<bool> stopping_;
+    std::atomic<size_t> hits_;
+    std::atomic<size_t> misses_;
+    std::atomic<size_t> errors_;
+    std::atomic<size_t> writes_queued_;
+    std::atomic<size_t> writes_stored_;
+    std::atomic<size_t> writes_dropped_;
+    std::atomic<size_t> compactions_;
+    // Writer thread only
+    std::chrono::steady_clock::time_point last_compaction_;
+    std::thread writer_;
+
+    static std::string ItemKey(const std::string& endpoint, const std::string& index) {
+        return "i:" + endpoint + "/" + index;
+    }
+
+    static std::string ListKey(const std::string& endpoint) {
+        return "l:" + endpoint;
+    }
+
+    static int OpenLog(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open KV store " + path + ": " + std::strerror(errno));
+        }
+        // Two writers appending to one log would corrupt it
+        if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+            ::close(fd);
+            throw std::runtime_error("KV store is in use by another process: " + path);
+        }
+        return fd;
+    }
+
+    static std::string LogHeader() {
+        std::string header(kLogMagic, sizeof(kLogMagic));
+        AppendU32(header, kLogFormatVersion);
+        AppendU32(header, 0);
+        return header;
+    }
+
+    void Map() {
+        void* mapped = ::mmap(nullptr, mapping_size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("Failed to map KV store " + options_.path + ": " + std::strerror(errno));
+        }
+        mapping_ = static_cast<const char*>(mapped);
+    }
+
+    void Load() {
+        struct stat info;
+        if (::fstat(fd_, &info) != 0) {
+            throw std::runtime_error("Cannot stat KV store: " + options_.path);
+        }
+        auto size = static_cast<size_t>(info.st_size);
+        if (size == 0) {
+            std::string header = LogHeader();
+            WriteAll(fd_, header.data(), header.size(), 0);
+            size = header.size();
+        }
+        mapping_size_ = std::max(options_.max_bytes, size);
+        Map();
+
+        if (size < kLogHeaderSize || std::memcmp(mapping_, kLogMagic, sizeof(kLogMagic)) != 0) {
+            throw std::runtime_error("Not a KV store log: " + options_.path);
+        }
+        uint32_t version;
+        std::memcpy(&version, mapping_ + sizeof(kLogMagic), sizeof(version));
+        if (version != kLogFormatVersion) {
+            throw std::runtime_error("Unsupported KV store version: " + options_.path);
+        }
+
+        size_t offset = kLogHeaderSize;
+        while (size - offset >= sizeof(RecordHeader)) {
+            RecordHeader header;
+            std::memcpy(&header, mapping_ + offset, sizeof(header));
+            size_t body_size = size_t{header.key_size} + header.value_size;
+            if (body_size > size - offset - sizeof(header)) {
+                break;
+            }
+            std::string_view key(mapping_ + offset + sizeof(header), header.key_size);
+            std::string_view value(key.data() + key.size(), header.value_size);
+            if (RecordChecksum(header, key, value) != header.checksum) {
+                break;
+            }
+            Index(std::string(key), Location{offset, header.key_size, header.value_size, header.stored_at_ms});
+            offset += sizeof(header) + body_size;
+        }
+        if (offset < size) {
+            // Torn or corrupt tail, e.g. from a crash mid-append; later appends overwrite it
+            std::cerr << "KV store " << options_.path << ": dropping " << size - offset
+                      << " bytes of incomplete records" << std::endl;
+            if (::ftruncate(fd_, static_cast<off_t>(offset)) != 0) {
+                throw std::runtime_error("Cannot truncate KV store: " + options_.path);
+            }
+        }
+        end_ = offset;
+        std::cout << "KV store " << options_.path << ": " << index_.size() << " entries, " << live_bytes_
+                  << " live of " << end_ << " bytes" << std::endl;
+    }
+
+    void Index(std::string key, const Location& location) {
+        auto [it, inserted] = index_.try_emplace(std::move(key), location);
+        if (!inserted) {
+            live_bytes_ -= it->second.RecordSize();
+            it->second = location;
+        }
+        live_bytes_ += location.RecordSize();
+    }
+
+    std::string_view ValueAt(const Location& location) const {
+        return std::string_view(mapping_ + location.offset + sizeof(RecordHeader) + location.key_size,
+                                location.value_size);
+    }
+
+    void Enqueue(Write write) {
+        if (queue_.TryPush(std::move(write))) {
+            writes_queued_++;
+        } else {
+            writes_dropped_++;
+        }
+    }
+
+    void RunWriter() {
+        std::vector<Write> batch;
+        batch.reserve(options_.batch_size);
+        while (true) {
+            // Read before draining so everything queued before shutdown is written
+            bool stopping = stopping_.load();
+            Write write;
+            while (batch.size() < options_.batch_size && queue_.TryPop(write)) {
+                batch.push_back(std::move(write));
+            }
+            if (!batch.empty()) {
+                Flush(batch);
+                batch.clear();
+            } else if (stopping) {
+                return;
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(options_.flush_interval_ms));
+            }
+        }
+    }
+
+    void Flush(const std::vector<Write>& batch) {
+        std::string buffer;
+        std::vector<std::pair<std::string, Location>> appended;
+        appended.reserve(batch.size());
+        int64_t now_ms = NowMillis();
+        for (const auto& write : batch) {
+            std::string value = write.item ? EncodeItem(*write.item) : EncodeList(*write.list, write.validators);
+            RecordHeader header{};
+            header.key_size = static_cast<uint32_t>(write.key.size());
+            header.value_size = static_cast<uint32_t>(value.size());
+            header.stored_at_ms = now_ms;
+            header.checksum = RecordChecksum(header, write.key, value);
+            // Offsets are relative to the batch until its place in the file is known
+            appended.emplace_back(write.key, Location{buffer.size(), header.key_size, header.value_size, now_ms});
+            buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+            buffer += write.key;
+            buffer += value;
+        }
+
+        size_t size = buffer.size();
+        try {
+            if (size > mapping_size_ - end_ && ShouldCompact()) {
+                Compact();
+            }
+            // Still full: keep the records that fit and drop the rest
+            while (size > mapping_size_ - end_) {
+                size = appended.back().second.offset;
+                appended.pop_back();
+            }
+            WriteAll(fd_, buffer.data(), size, end_);
+        } catch (const std::exception& e) {
+            errors_++;
+            writes_dropped_ += batch.size();
+            std::cerr << "KV store cache error: " << e.what() << std::endl;
+            return;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for (auto& [key, location] : appended) {
+            location.offset += end_;
+            Index(std::move(key), location);
+        }
+        end_ += size;
+        writes_stored_ += appended.size();
+        writes_dropped_ += batch.size() - appended.size();
+    }
+
+    bool ShouldCompact() const {
+        size_t garbage = end_ - kLogHeaderSize - live_bytes_;
+        if (garbage == 0) {
+            return false;
+        }
+        return garbage >= mapping_size_ / kMinCompactionGainShare ||
+               std::chrono::steady_clock::now() - last_compaction_ >= kCompactionBackoff;
+    }
+
+    // Rewrites the live records into a fresh log and swaps it in. Runs on the
+    // writer thread, so reading index_ and the mapping needs no lock
+    void Compact() {
+        std::string temp_path = options_.path + ".compact";
+        int temp_fd = ::open(temp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (temp_fd < 0) {
+            throw std::runtime_error("Cannot create " + temp_path + ": " + std::strerror(errno));
+        }
+
+        std::vector<std::pair<const std::string*, Location>> live;
+        live.reserve(index_.size());
+        for (const auto& [key, location] : index_) {
+            live.emplace_back(&key, location);
+        }
+        std::sort(live.begin(), live.end(),
+                  [](const auto& a, const auto& b) { return a.second.offset < b.second.offset; });
+
+        std::unordered_map<std::string, Location> compacted;
+        compacted.reserve(live.size());
+        size_t new_end = 0;
+        try {
+            std::string header = LogHeader();
+            WriteAll(temp_fd, header.data(), header.size(), 0);
+            new_end = header.size();
+            for (const auto& [key, location] : live) {
+                WriteAll(temp_fd, mapping_ + location.offset, location.RecordSize(), new_end);
+                Location moved = location;
+                moved.offset = new_end;
+                compacted.emplace(*key, moved);
+                new_end += location.RecordSize();
+            }
+            if (::flock(temp_fd, LOCK_EX | LOCK_NB) != 0 || ::fdatasync(temp_fd) != 0) {
+                throw std::runtime_error("Cannot sync " + temp_path);
+            }
+        } catch (...) {
+            ::close(temp_fd);
+            std::remove(temp_path.c_str());
+            throw;
+        }
+
+        // Mapped before the rename so a failure leaves the old log in charge
+        void* mapped = ::mmap(nullptr, mapping_size_, PROT_READ, MAP_SHARED, temp_fd, 0);
+        if (mapped == MAP_FAILED || std::rename(temp_path.c_str(), options_.path.c_str()) != 0) {
+            if (mapped != MAP_FAILED) {
+                ::munmap(mapped, mapping_size_);
+            }
+            ::close(temp_fd);
+            std::remove(temp_path.c_str());
+            throw std::runtime_error("Cannot replace KV store with " + temp_path);
+        }
+
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            ::munmap(const_cast<char*>(mapping_), mapping_size_);
+            ::close(fd_);
+            fd_ = temp_fd;
+            mapping_ = static_cast<const char*>(mapped);
+            index_ = std::move(compacted);
+            end_ = new_end;
+        }
+        compactions_++;
+        last_compaction_ = std::chrono::steady_clock::now();
+    }
+};
+
+} // namespace
+
+std::unique_ptr<L2Cache> OpenKvStoreCache(const KvStoreOptions& options) {
+    return std::make_unique<KvStoreCache>(options);
+}
+
+} // namespace dnd5e
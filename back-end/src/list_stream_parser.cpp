@@ -0,0 +1,365 @@
+#include "list_stream_parser.h"
+#include <charconv>
+#include <stdexcept>
+#include <utility>
+
+namespace dnd5e {
+
+namespace {
+    constexpr uint32_t kReplacementCharacter = 0xFFFD;
+
+    bool IsWhitespace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    bool IsNumberChar(char c) {
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    bool IsLiteralChar(char c) {
+        return c >= 'a' && c <= 'z';
+    }
+
+    int HexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+}
+
+ListStreamParser::ListStreamParser()
+    : lex_state_(LexState::Value),
+      unicode_value_(0),
+      unicode_digits_(0),
+      pending_high_surrogate_(0),
+      done_(false),
+      offset_(0),
+      in_results_(false) {
+    response_.count = 0;
+    stack_.reserve(8);
+}
+
+void ListStreamParser::Feed(const char* data, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        // Copy plain string content in bulk instead of one character at a time
+        if (lex_state_ == LexState::String && pending_high_surrogate_ == 0) {
+            size_t start = i;
+            while (i < size && data[i] != '"' && data[i] != '\\' &&
+                   static_cast<unsigned char>(data[i]) >= 0x20) {
+                ++i;
+            }
+            token_.append(data + start, i - start);
+            offset_ += i - start;
+            if (i == size) {
+                break;
+            }
+        }
+
+        ProcessChar(data[i]);
+        offset_++;
+        ++i;
+    }
+}
+
+ApiClient::ApiResponse ListStreamParser::Finish() {
+    if (lex_state_ != LexState::Value || !done_ || !stack_.empty()) {
+        Fail("unexpected end of input");
+    }
+    return std::move(response_);
+}
+
+void ListStreamParser::ProcessChar(char c) {
+    switch (lex_state_) {
+        case LexState::Value:
+            if (IsWhitespace(c)) {
+                return;
+            }
+            switch (c) {
+                case '"':
+                    lex_state_ = LexState::String;
+                    token_.clear();
+                    return;
+                case '{':
+                    OnBeginContainer(true);
+                    return;
+                case '[':
+                    OnBeginContainer(false);
+                    return;
+                case '}':
+                    OnEndContainer(true);
+                    return;
+                case ']':
+                    OnEndContainer(false);
+                    return;
+                case ',':
+                    OnComma();
+                    return;
+                case ':':
+                    OnColon();
+                    return;
+                default:
+                    break;
+            }
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                lex_state_ = LexState::Number;
+                token_.assign(1, c);
+                return;
+            }
+            if (c == 't' || c == 'f' || c == 'n') {
+                lex_state_ = LexState::Literal;
+                token_.assign(1, c);
+                return;
+            }
+            Fail(std::string("unexpected character '") + c + "'");
+
+        case LexState::String:
+            if (c == '\\') {
+                lex_state_ = LexState::StringEscape;
+                return;
+            }
+            if (pending_high_surrogate_ != 0) {
+                pending_high_surrogate_ = 0;
+                AppendCodePoint(kReplacementCharacter);
+            }
+            if (c == '"') {
+                lex_state_ = LexState::Value;
+                OnString(std::move(token_));
+                token_.clear();
+                return;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                Fail("control character in string");
+            }
+            token_ += c;
+            return;
+
+        case LexState::StringEscape: {
+            if (c == 'u') {
+                lex_state_ = LexState::StringUnicode;
+                unicode_value_ = 0;
+                unicode_digits_ = 0;
+                return;
+            }
+
+            char unescaped;
+            switch (c) {
+                case '"': unescaped = '"'; break;
+                case '\\': unescaped = '\\'; break;
+                case '/': unescaped = '/'; break;
+                case 'b': unescaped = '\b'; break;
+                case 'f': unescaped = '\f'; break;
+                case 'n': unescaped = '\n'; break;
+                case 'r': unescaped = '\r'; break;
+                case 't': unescaped = '\t'; break;
+                default:
+                    Fail(std::string("invalid escape '\\") + c + "'");
+            }
+            if (pending_high_surrogate_ != 0) {
+                pending_high_surrogate_ = 0;
+                AppendCodePoint(kReplacementCharacter);
+            }
+            token_ += unescaped;
+            lex_state_ = LexState::String;
+            return;
+        }
+
+        case LexState::StringUnicode: {
+            int digit = HexValue(c);
+            if (digit < 0) {
+                Fail("invalid unicode escape");
+            }
+            unicode_value_ = (unicode_value_ << 4) | static_cast<uint32_t>(digit);
+            if (++unicode_digits_ == 4) {
+                AppendCodePoint(unicode_value_);
+                lex_state_ = LexState::String;
+            }
+            return;
+        }
+
+        case LexState::Number:
+            if (IsNumberChar(c)) {
+                token_ += c;
+                return;
+            }
+            lex_state_ = LexState::Value;
+            OnScalar(token_, true);
+            ProcessChar(c);
+            return;
+
+        case LexState::Literal:
+            if (IsLiteralChar(c)) {
+                token_ += c;
+                return;
+            }
+            lex_state_ = LexState::Value;
+            OnScalar(token_, false);
+            ProcessChar(c);
+            return;
+    }
+}
+
+void ListStreamParser::BeginValue(bool is_object) {
+    if (stack_.empty()) {
+        if (done_) {
+            Fail("trailing data after top-level value");
+        }
+        if (!is_object) {
+            Fail("expected a top-level object");
+        }
+        return;
+    }
+
+    Frame& top = stack_.back();
+    bool accepts_value = top.is_object
+        ? top.expect == Expect::Value
+        : (top.expect == Expect::Value || top.expect == Expect::ValueOrEnd);
+    if (!accepts_value) {
+        Fail("unexpected value");
+    }
+}
+
+void ListStreamParser::EndValue() {
+    if (stack_.empty()) {
+        done_ = true;
+    } else {
+        stack_.back().expect = Expect::CommaOrEnd;
+    }
+}
+
+void ListStreamParser::OnString(std::string value) {
+    if (!stack_.empty() && stack_.back().is_object &&
+        (stack_.back().expect == Expect::KeyOrEnd || stack_.back().expect == Expect::Key)) {
+        if (stack_.size() == 1) {
+            top_level_key_ = std::move(value);
+        } else if (in_results_ && stack_.size() == 3) {
+            item_key_ = std::move(value);
+        }
+        stack_.back().expect = Expect::Colon;
+        return;
+    }
+
+    BeginValue(false);
+    if (in_results_ && stack_.size() == 3 && stack_.back().is_object) {
+        if (item_key_ == "index") {
+            current_item_.index = std::move(value);
+        } else if (item_key_ == "name") {
+            current_item_.name = std::move(value);
+        } else if (item_key_ == "url") {
+            current_item_.url = std::move(value);
+        }
+    }
+    EndValue();
+}
+
+void ListStreamParser::OnScalar(const std::string& text, bool is_number) {
+    if (!is_number && text != "true" && text != "false" && text != "null") {
+        Fail("invalid literal '" + text + "'");
+    }
+
+    BeginValue(false);
+    if (is_number && stack_.size() == 1 && top_level_key_ == "count") {
+        int count = 0;
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), count);
+        if (ec != std::errc() || ptr != text.data() + text.size()) {
+            Fail("invalid count '" + text + "'");
+        }
+        response_.count = count;
+    }
+    EndValue();
+}
+
+void ListStreamParser::OnBeginContainer(bool is_object) {
+    BeginValue(is_object);
+
+    if (!is_object && stack_.size() == 1 && top_level_key_ == "results") {
+        in_results_ = true;
+    } else if (is_object && in_results_ && stack_.size() == 2) {
+        current_item_ = ApiClient::ApiItem{};
+        item_key_.clear();
+    }
+
+    stack_.push_back(Frame{is_object, is_object ? Expect::KeyOrEnd : Expect::ValueOrEnd});
+}
+
+void ListStreamParser::OnEndContainer(bool is_object) {
+    if (stack_.empty() || stack_.back().is_object != is_object) {
+        Fail("mismatched closing bracket");
+    }
+
+    Expect expect = stack_.back().expect;
+    bool can_close = expect == Expect::CommaOrEnd ||
+        (is_object ? expect == Expect::KeyOrEnd : expect == Expect::ValueOrEnd);
+    if (!can_close) {
+        Fail("unexpected closing bracket");
+    }
+    stack_.pop_back();
+
+    if (is_object && in_results_ && stack_.size() == 2) {
+        response_.results.push_back(std::move(current_item_));
+    } else if (!is_object && in_results_ && stack_.size() == 1) {
+        in_results_ = false;
+    }
+
+    EndValue();
+}
+
+void ListStreamParser::OnComma() {
+    if (stack_.empty() || stack_.back().expect != Expect::CommaOrEnd) {
+        Fail("unexpected ','");
+    }
+    stack_.back().expect = stack_.back().is_object ? Expect::Key : Expect::Value;
+}
+
+void ListStreamParser::OnColon() {
+    if (stack_.empty() || !stack_.back().is_object || stack_.back().expect != Expect::Colon) {
+        Fail("unexpected ':'");
+    }
+    stack_.back().expect = Expect::Value;
+}
+
+void ListStreamParser::AppendCodePoint(uint32_t code_point) {
+    if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+        if (pending_high_surrogate_ != 0) {
+            AppendCodePoint(kReplacementCharacter);
+        }
+        pending_high_surrogate_ = code_point;
+        return;
+    }
+
+    if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+        if (pending_high_surrogate_ == 0) {
+            code_point = kReplacementCharacter;
+        } else {
+            code_point = 0x10000 + ((pending_high_surrogate_ - 0xD800) << 10) + (code_point - 0xDC00);
+            pending_high_surrogate_ = 0;
+        }
+    } else if (pending_high_surrogate_ != 0) {
+        pending_high_surrogate_ = 0;
+        AppendCodePoint(kReplacementCharacter);
+    }
+
+    if (code_point < 0x80) {
+        token_ += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        token_ += static_cast<char>(0xC0 | (code_point >> 6));
+        token_ += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        token_ += static_cast<char>(0xE0 | (code_point >> 12));
+        token_ += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        token_ += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        token_ += static_cast<char>(0xF0 | (code_point >> 18));
+        token_ += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        token_ += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        token_ += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+void ListStreamParser::Fail(const std::string& reason) const {
+    throw std::runtime_error("Failed to parse JSON response: " + reason +
+                             " at byte " + std::to_string(offset_));
+}
+
+} // namespace dnd5e
@@ -0,0 +1,314 @@
+#include "local_data_source.h"
+#include "json_backend.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+namespace dnd5e {
+
+namespace {
+
+// Pack layout (host byte order):
+//   header   magic[8] "DND5PACK", u32 format version, u32 entry count, u64 index offset
+//   bodies   raw JSON bodies, back to back
+//   index    per entry: u32 key size, u32 reserved, u64 body offset, u64 body size, key bytes
+// Keys are "<endpoint>" for lists and "<endpoint>/<index>" for items.
+constexpr char kPackMagic[8] = {'D', 'N', 'D', '5', 'P', 'A', 'C', 'K'};
+constexpr uint32_t kPackFormatVersion = 1;
+constexpr size_t kPackHeaderSize = 24;
+constexpr size_t kPackIndexEntrySize = 24;
+
+std::string MakeVersion(std::filesystem::file_time_type modified, uintmax_t size) {
+    return "\"" + std::to_string(modified.time_since_epoch().count()) + "-" + std::to_string(size) + "\"";
+}
+
+template <typename T>
+T ReadPod(const char* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void WritePod(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+class DirectoryDataSource final : public LocalDataSource {
+public:
+    explicit DirectoryDataSource(const std::string& path) : path_(path), root_(path) {
+        if (!std::filesystem::is_directory(root_)) {
+            throw std::invalid_argument("Data directory does not exist: " + path);
+        }
+    }
+
+    const std::string& GetPath() const override {
+        return path_;
+    }
+
+    std::optional<LocalEntry> ReadList(const std::string& endpoint) const override {
+        if (!IsSafeDataName(endpoint)) {
+            return std::nullopt;
+        }
+        if (auto entry = ReadEntry(root_ / (endpoint + ".json"))) {
+            return entry;
+        }
+        return SynthesizeList(endpoint);
+    }
+
+    std::optional<LocalEntry> ReadItem(const std::string& endpoint, const std::string& index) const override {
+        if (!IsSafeDataName(endpoint) || !IsSafeDataName(index)) {
+            return std::nullopt;
+        }
+        return ReadEntry(root_ / endpoint / (index + ".json"));
+    }
+
+    std::vector<std::string> GetItemIndexes(const std::string& endpoint) const {
+        std::vector<std::string> indexes;
+        std::error_code ec;
+        for (const auto& file : std::filesystem::directory_iterator(root_ / endpoint, ec)) {
+            if (file.is_regular_file() && file.path().extension() == ".json") {
+                indexes.push_back(file.path().stem().string());
+            }
+        }
+        std::sort(indexes.begin(), indexes.end());
+        return indexes;
+    }
+
+private:
+    std::string path_;
+    std::filesystem::path root_;
+
+    static std::optional<LocalEntry> ReadEntry(const std::filesystem::path& file) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(file, ec);
+        if (ec) {
+            return std::nullopt;
+        }
+        auto modified = std::filesystem::last_write_time(file, ec);
+
+        std::ifstream input(file, std::ios::binary);
+        if (!input) {
+            return std::nullopt;
+        }
+
+        LocalEntry entry;
+        entry.body.resize(size);
+        input.read(entry.body.data(), static_cast<std::streamsize>(size));
+        entry.body.resize(static_cast<size_t>(input.gcount()));
+        entry.version = MakeVersion(modified, size);
+        return entry;
+    }
+
+    // Item-only dumps (e.g. the repository fixtures) still get a browsable list
+    std::optional<LocalEntry> SynthesizeList(const std::string& endpoint) const {
+        auto indexes = GetItemIndexes(endpoint);
+        if (indexes.empty()) {
+            return std::nullopt;
+        }
+
+        auto backend = CreateJsonBackend();
+        auto results = nlohmann::json::array();
+        std::filesystem::file_time_type newest{};
+        for (const auto& index : indexes) {
+            auto file = root_ / endpoint / (index + ".json");
+            auto item = ReadEntry(file);
+            if (!item) {
+                continue;
+            }
+            newest = std::max(newest, std::filesystem::last_write_time(file));
+
+            ItemFields fields = backend->ExtractItemFields(item->body);
+            results.push_back({{"index", index}, {"name", fields.name}, {"url", fields.url}});
+        }
+
+        LocalEntry entry;
+        entry.body = nlohmann::json{{"count", results.size()}, {"results", std::move(results)}}.dump();
+        entry.version = MakeVersion(newest, indexes.size());
+        return entry;
+    }
+};
+
+class PackDataSource final : public LocalDataSource {
+public:
+    explicit PackDataSource(const std::string& path) : path_(path), data_(nullptr), size_(0) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::invalid_argument("Cannot open data pack: " + path);
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(kPackHeaderSize)) {
+            ::close(fd);
+            throw std::runtime_error("Corrupt data pack (too small): " + path);
+        }
+        size_ = static_cast<size_t>(info.st_size);
+
+        void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("Failed to map data pack: " + path);
+        }
+        data_ = static_cast<const char*>(mapped);
+        version_ = "\"pack-" + std::to_string(info.st_mtime) + "-" + std::to_string(info.st_size) + "\"";
+
+        try {
+            LoadIndex();
+        } catch (...) {
+            ::munmap(const_cast<char*>(data_), size_);
+            throw;
+        }
+    }
+
+    ~PackDataSource() override {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+
+    PackDataSource(const PackDataSource&) = delete;
+    PackDataSource& operator=(const PackDataSource&) = delete;
+    PackDataSource(PackDataSource&&) = delete;
+    PackDataSource& operator=(PackDataSource&&) = delete;
+
+    const std::string& GetPath() const override {
+        return path_;
+    }
+
+    std::optional<LocalEntry> ReadList(const std::string& endpoint) const override {
+        return Find(endpoint);
+    }
+
+    std::optional<LocalEntry> ReadItem(const std::string& endpoint, const std::string& index) const override {
+        return Find(endpoint + "/" + index);
+    }
+
+private:
+    std::string path_;
+    const char* data_;
+    size_t size_;
+    std::string version_;
+    // Views point into the mapping, so lookups never touch the file system
+    std::unordered_map<std::string_view, std::string_view> entries_;
+
+    void LoadIndex() {
+        if (std::memcmp(data_, kPackMagic, sizeof(kPackMagic)) != 0) {
+            throw std::runtime_error("Not a data pack: " + path_);
+        }
+        if (ReadPod<uint32_t>(data_ + 8) != kPackFormatVersion) {
+            throw std::runtime_error("Unsupported data pack version: " + path_);
+        }
+        auto entry_count = ReadPod<uint32_t>(data_ + 12);
+        auto position = ReadPod<uint64_t>(data_ + 16);
+
+        entries_.reserve(entry_count);
+        for (uint32_t i = 0; i < entry_count; ++i) {
+            if (position > size_ || size_ - position < kPackIndexEntrySize) {
+                throw std::runtime_error("Corrupt data pack index: " + path_);
+            }
+            auto key_size = ReadPod<uint32_t>(data_ + position);
+            auto body_offset = ReadPod<uint64_t>(data_ + position + 8);
+            auto body_size = ReadPod<uint64_t>(data_ + position + 16);
+            position += kPackIndexEntrySize;
+
+            if (size_ - position < key_size || body_offset > size_ || size_ - body_offset < body_size) {
+                throw std::runtime_error("Corrupt data pack entry: " + path_);
+            }
+            std::string_view key(data_ + position, key_size);
+            position += key_size;
+            entries_.emplace(key, std::string_view(data_ + body_offset, body_size));
+        }
+    }
+
+    std::optional<LocalEntry> Find(const std::string& key) const {
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            return std::nullopt;
+        }
+        return LocalEntry{std::string(it->second), version_};
+    }
+};
+
+} // namespace
+
+// Names come straight from RPC requests and must never escape the data root
+bool IsSafeDataName(const std::string& name) {
+    return !name.empty() && name[0] != '.' &&
+           name.find_first_of("/\\", 0) == std::string::npos &&
+           name.find('\0') == std::string::npos;
+}
+
+std::unique_ptr<LocalDataSource> OpenDataDirectory(const std::string& path) {
+    return std::make_unique<DirectoryDataSource>(path);
+}
+
+std::unique_ptr<LocalDataSource> OpenDataPack(const std::string& path) {
+    return std::make_unique<PackDataSource>(path);
+}
+
+size_t WriteDataPack(const std::string& data_dir, const std::string& pack_path,
+                     const std::vector<std::string>& endpoints) {
+    DirectoryDataSource source(data_dir);
+
+    std::ofstream out(pack_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot create data pack: " + pack_path);
+    }
+
+    struct IndexEntry {
+        std::string key;
+        uint64_t offset;
+        uint64_t size;
+    };
+    std::vector<IndexEntry> index;
+
+    // Header is rewritten once the index position is known
+    out.write(std::string(kPackHeaderSize, '\0').data(), kPackHeaderSize);
+
+    auto append = [&out, &index](std::string key, const std::string& body) {
+        index.push_back({std::move(key), static_cast<uint64_t>(out.tellp()), body.size()});
+        out.write(body.data(), static_cast<std::streamsize>(body.size()));
+    };
+
+    for (const auto& endpoint : endpoints) {
+        if (auto list = source.ReadList(endpoint)) {
+            append(endpoint, list->body);
+        }
+        for (const auto& item_index : source.GetItemIndexes(endpoint)) {
+            if (auto item = source.ReadItem(endpoint, item_index)) {
+                append(endpoint + "/" + item_index, item->body);
+            }
+        }
+    }
+
+    auto index_offset = static_cast<uint64_t>(out.tellp());
+    for (const auto& entry : index) {
+        WritePod(out, static_cast<uint32_t>(entry.key.size()));
+        WritePod(out, uint32_t{0});
+        WritePod(out, entry.offset);
+        WritePod(out, entry.size);
+        out.write(entry.key.data(), static_cast<std::streamsize>(entry.key.size()));
+    }
+
+    out.seekp(0);
+    out.write(kPackMagic, sizeof(kPackMagic));
+    WritePod(out, kPackFormatVersion);
+    WritePod(out, static_cast<uint32_t>(index.size()));
+    WritePod(out, index_offset);
+
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Failed to write data pack: " + pack_path);
+    }
+    return index.size();
+}
+
+} // namespace dnd5e
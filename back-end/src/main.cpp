@@ -1,18 +1,26 @@
 #include <iostream>
 #include <string>
+#include <chrono>
 #include <csignal>
+#include <cstdlib>
 #include <memory>
+#include <optional>
+#include <thread>
 #include <grpcpp/grpcpp.h>
 
+#include "mirror_crawler.h"
 #include "server.h"
 
 namespace {
     std::unique_ptr<dnd5e::Server> g_server;
+    dnd5e::MirrorCrawler* g_crawler = nullptr;
+    volatile std::sig_atomic_t g_stop_signal = 0;
     
+    // Only async-signal-safe work here; the server is stopped from main()
     void SignalHandler(int signal) {
-        std::cout << "\nReceived signal " << signal << ". Shutting down gracefully...\n";
-        if (g_server) {
-            g_server->Stop();
+        g_stop_signal = signal;
+        if (g_crawler) {
+            g_crawler->Stop();
         }
     }
 }
@@ -20,12 +28,126 @@ namespace {
 int main(int argc, char* argv[]) {
     // Parse command line arguments
     std::string server_address = "0.0.0.0:50051";
+    dnd5e::ServerOptions options;
     bool test_mode = false;
+    std::string write_pack;
+    dnd5e::MirrorOptions mirror;
+    std::optional<double> fake_latency_ms;
+    std::optional<double> fake_error_rate;
+    std::optional<size_t> fake_payload_scale;
+    
+    if (const char* base_url = std::getenv("DND5E_API_BASE_URL")) {
+        options.api_base_url = base_url;
+    }
+    if (const char* cache_limit = std::getenv("CACHE_SIZE_LIMIT")) {
+        options.service.item_cache_bytes = std::stoull(cache_limit);
+    }
     
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--address" && i + 1 < argc) {
             server_address = argv[++i];
+        } else if (arg == "--http2") {
+            options.api_client.http2 = true;
+        } else if (arg == "--http2-max-streams" && i + 1 < argc) {
+            options.api_client.http2_max_streams = std::stol(argv[++i]);
+        } else if (arg == "--hedge") {
+            options.api_client.hedge = true;
+        } else if (arg == "--hedge-percentile" && i + 1 < argc) {
+            options.api_client.hedge_percentile = std::stod(argv[++i]);
+        } else if (arg == "--hedge-budget" && i + 1 < argc) {
+            options.api_client.hedge_budget = std::stod(argv[++i]);
+        } else if (arg == "--warm-connections" && i + 1 < argc) {
+            options.warm_connections = std::stoul(argv[++i]);
+        } else if (arg == "--warm-interval-s" && i + 1 < argc) {
+            options.warm_interval = std::chrono::seconds(std::stol(argv[++i]));
+        } else if (arg == "--pin-dns") {
+            options.api_client.pin_dns = true;
+        } else if (arg == "--dns-refresh-s" && i + 1 < argc) {
+            options.api_client.dns_refresh_ms = std::stol(argv[++i]) * 1000;
+        } else if (arg == "--item-cache-bytes" && i + 1 < argc) {
+            options.service.item_cache_bytes = std::stoull(argv[++i]);
+        } else if (arg == "--item-cache-policy" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            if (policy == "lru") {
+                options.service.item_cache_policy = dnd5e::CachePolicy::Lru;
+            } else if (policy == "tinylfu") {
+                options.service.item_cache_policy = dnd5e::CachePolicy::TinyLfu;
+            } else {
+                std::cerr << "--item-cache-policy must be lru or tinylfu\n";
+                return 1;
+            }
+        } else if (arg == "--response-cache-bytes" && i + 1 < argc) {
+            options.response_cache_bytes = std::stoull(argv[++i]);
+        } else if (arg == "--response-miss-threads" && i + 1 < argc) {
+            options.response_miss_threads = std::stoul(argv[++i]);
+        } else if (arg == "--response-miss-queue" && i + 1 < argc) {
+            options.response_miss_queue = std::stoul(argv[++i]);
+        } else if (arg == "--cache-snapshot" && i + 1 < argc) {
+            options.snapshot_path = argv[++i];
+        } else if (arg == "--snapshot-interval-s" && i + 1 < argc) {
+            options.snapshot_interval = std::chrono::seconds(std::stol(argv[++i]));
+        } else if (arg == "--cache-ttl-s" && i + 1 < argc) {
+            options.service.cache_ttl = std::chrono::seconds(std::stol(argv[++i]));
+        } else if (arg == "--cache-ttl-jitter" && i + 1 < argc) {
+            options.service.cache_ttl_jitter = std::stod(argv[++i]);
+        } else if (arg == "--refresh-threads" && i + 1 < argc) {
+            options.service.refresh_threads = std::stoul(argv[++i]);
+        } else if (arg == "--negative-ttl-s" && i + 1 < argc) {
+            options.service.negative_ttl = std::chrono::seconds(std::stol(argv[++i]));
+        } else if (arg == "--search-cache-entries" && i + 1 < argc) {
+            options.service.search_cache_entries = std::stoul(argv[++i]);
+        } else if (arg == "--mariadb") {
+            // Same DB_* variables docker-compose.yml passes to the backend
+            dnd5e::MariaDbOptions mariadb;
+            if (const char* host = std::getenv("DB_HOST")) {
+                mariadb.host = host;
+            }
+            if (const char* port = std::getenv("DB_PORT")) {
+                mariadb.port = static_cast<unsigned int>(std::stoul(port));
+            }
+            if (const char* name = std::getenv("DB_NAME")) {
+                mariadb.database = name;
+            }
+            if (const char* user = std::getenv("DB_USER")) {
+                mariadb.user = user;
+            }
+            if (const char* password = std::getenv("DB_PASSWORD")) {
+                mariadb.password = password;
+            }
+            options.mariadb = mariadb;
+        } else if (arg == "--kv-store" && i + 1 < argc) {
+            if (!options.kv_store) {
+                options.kv_store.emplace();
+            }
+            options.kv_store->path = argv[++i];
+        } else if (arg == "--kv-store-max-bytes" && i + 1 < argc) {
+            if (!options.kv_store) {
+                options.kv_store.emplace();
+            }
+            options.kv_store->max_bytes = std::stoull(argv[++i]);
+        } else if (arg == "--json-backend" && i + 1 < argc) {
+            options.api_client.json_backend = argv[++i];
+        } else if (arg == "--data-dir" && i + 1 < argc) {
+            options.api_client.data_dir = argv[++i];
+        } else if (arg == "--data-pack" && i + 1 < argc) {
+            options.api_client.data_pack = argv[++i];
+        } else if (arg == "--fake-upstream" && i + 1 < argc) {
+            options.fake_upstream.emplace().data_dir = argv[++i];
+        } else if (arg == "--fake-latency-ms" && i + 1 < argc) {
+            fake_latency_ms = std::stod(argv[++i]);
+        } else if (arg == "--fake-error-rate" && i + 1 < argc) {
+            fake_error_rate = std::stod(argv[++i]);
+        } else if (arg == "--fake-payload-scale" && i + 1 < argc) {
+            fake_payload_scale = std::stoul(argv[++i]);
+        } else if (arg == "--mirror" && i + 1 < argc) {
+            mirror.output_dir = argv[++i];
+        } else if (arg == "--mirror-concurrency" && i + 1 < argc) {
+            mirror.concurrency = std::stoul(argv[++i]);
+        } else if (arg == "--mirror-rate" && i + 1 < argc) {
+            mirror.requests_per_second = std::stod(argv[++i]);
+        } else if (arg == "--write-pack" && i + 1 < argc) {
+            write_pack = argv[++i];
         } else if (arg == "--test") {
             test_mode = true;
         } else if (arg == "--help") {
@@ -33,12 +155,102 @@ int main(int argc, char* argv[]) {
             std::cout << "Usage: " << argv[0] << " [options]\n";
             std::cout << "Options:\n";
             std::cout << "  --address <addr>    Server address (default: 0.0.0.0:50051)\n";
+            std::cout << "  --http2             Multiplex upstream requests over HTTP/2\n";
+            std::cout << "  --http2-max-streams <n>  Max concurrent HTTP/2 streams (default: 100)\n";
+            std::cout << "  --hedge             Duplicate slow upstream item requests\n";
+            std::cout << "  --hedge-percentile <p>  Latency percentile that triggers a hedge (default: 0.95)\n";
+            std::cout << "  --hedge-budget <ratio>  Max hedges per primary request (default: 0.05)\n";
+            std::cout << "  --warm-connections <n>  Open n upstream connections before serving (default: 0)\n";
+            std::cout << "  --warm-interval-s <s>  Re-open warm connections every s seconds, 0 to disable (default: 60)\n";
+            std::cout << "  --pin-dns           Resolve the upstream host at startup and pin it\n";
+            std::cout << "  --dns-refresh-s <s> Re-resolve the pinned host every s seconds (default: 60)\n";
+            std::cout << "  --item-cache-bytes <n>  GetItem cache budget in bytes, 0 to disable (default: 64 MiB)\n";
+            std::cout << "  --item-cache-policy <p>  Item cache eviction: tinylfu or lru (default: tinylfu)\n";
+            std::cout << "  --response-cache-bytes <n>  Serialized GetList/GetItem response budget, 0 to disable (default: 0)\n";
+            std::cout << "  --response-miss-threads <n>  Workers building responses on a response cache miss (default: 16)\n";
+            std::cout << "  --response-miss-queue <n>    Misses waiting for a worker before RESOURCE_EXHAUSTED (default: 1024)\n";
+            std::cout << "  --cache-snapshot <file>  Restore caches from <file> at startup, save them on shutdown\n";
+            std::cout << "  --snapshot-interval-s <s>  Also save the snapshot every s seconds, 0 to disable (default: 300)\n";
+            std::cout << "  --cache-ttl-s <s>   Seconds cached lists and items stay fresh (default: 3600)\n";
+            std::cout << "  --cache-ttl-jitter <ratio>  Random +/- spread of the TTL (default: 0.1)\n";
+            std::cout << "  --refresh-threads <n>  Background refreshers for stale entries, 0 to refresh inline (default: 2)\n";
+            std::cout << "  --negative-ttl-s <s>  Answer items upstream 404'd NOT_FOUND locally for s seconds, 0 to disable (default: 60)\n";
+            std::cout << "  --search-cache-entries <n>  SearchItems results kept for repeat queries, 0 to disable (default: 1024)\n";
+            std::cout << "  --mariadb           Share an L2 cache in MariaDB (DB_HOST, DB_PORT, DB_NAME, DB_USER, DB_PASSWORD)\n";
+            std::cout << "  --kv-store <file>   Embedded on-disk L2 cache in <file>, for deployments without MariaDB\n";
+            std::cout << "  --kv-store-max-bytes <n>  Size the KV store log may grow to before compaction (default: 1 GiB)\n";
+            std::cout << "  --json-backend <name>  Item JSON parser: simdjson or nlohmann (default: fastest built)\n";
+            std::cout << "  --data-dir <dir>    Serve from a local SRD JSON tree, no upstream traffic\n";
+            std::cout << "  --data-pack <file>  Serve from a memory-mapped data pack, no upstream traffic\n";
+            std::cout << "  --fake-upstream <dir>  Answer upstream requests in-process from <dir> (benchmarking)\n";
+            std::cout << "  --fake-latency-ms <ms>  Median fake upstream latency (default: 20)\n";
+            std::cout << "  --fake-error-rate <ratio>  Fraction of fake upstream 503s (default: 0)\n";
+            std::cout << "  --fake-payload-scale <n>  Inflate fake upstream bodies n times (default: 1)\n";
+            std::cout << "  --write-pack <file> Pack the --data-dir tree into <file> and exit\n";
+            std::cout << "  --mirror <dir>      Copy every list and item into <dir> for --data-dir, then exit;\n";
+            std::cout << "                      rerun to resume an interrupted mirror\n";
+            std::cout << "  --mirror-concurrency <n>  Parallel mirror requests (default: 8)\n";
+            std::cout << "  --mirror-rate <rps> Max mirror requests per second, 0 for unlimited (default: 20)\n";
             std::cout << "  --test              Run in test mode\n";
             std::cout << "  --help              Show this help message\n";
             return 0;
         }
     }
     
+    if (fake_latency_ms || fake_error_rate || fake_payload_scale) {
+        if (!options.fake_upstream) {
+            std::cerr << "--fake-* options require --fake-upstream\n";
+            return 1;
+        }
+        options.fake_upstream->latency_median_ms = fake_latency_ms.value_or(options.fake_upstream->latency_median_ms);
+        options.fake_upstream->error_rate = fake_error_rate.value_or(options.fake_upstream->error_rate);
+        options.fake_upstream->payload_scale = fake_payload_scale.value_or(options.fake_upstream->payload_scale);
+    }
+    
+    if (!mirror.output_dir.empty()) {
+        if (!options.api_client.data_dir.empty() || !options.api_client.data_pack.empty()) {
+            std::cerr << "--mirror fetches from upstream and cannot be combined with --data-dir or --data-pack\n";
+            return 1;
+        }
+        std::signal(SIGINT, SignalHandler);
+        std::signal(SIGTERM, SignalHandler);
+        try {
+            auto client = std::make_shared<dnd5e::ApiClient>(options.api_base_url, options.api_client);
+            dnd5e::MirrorCrawler crawler(client, mirror);
+            g_crawler = &crawler;
+            auto start = std::chrono::steady_clock::now();
+            auto stats = crawler.Run();
+            g_crawler = nullptr;
+            auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            
+            std::cout << "Mirror " << (stats.stopped ? "interrupted" : "finished") << " in " << elapsed << "s: "
+                      << stats.lists_fetched << " lists and " << stats.items_fetched << " items fetched, "
+                      << stats.lists_skipped << " lists and " << stats.items_skipped << " items already present, "
+                      << stats.failures << " failed\n";
+            return (stats.stopped || stats.failures > 0) ? 1 : 0;
+        } catch (const std::exception& e) {
+            g_crawler = nullptr;
+            std::cerr << "Failed to mirror: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    
+    if (!write_pack.empty()) {
+        if (options.api_client.data_dir.empty()) {
+            std::cerr << "--write-pack requires --data-dir\n";
+            return 1;
+        }
+        try {
+            dnd5e::ApiClient client(options.api_base_url, options.api_client);
+            size_t entries = dnd5e::WriteDataPack(options.api_client.data_dir, write_pack, client.GetEndpoints());
+            std::cout << "Wrote " << entries << " entries to " << write_pack << "\n";
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to write data pack: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    
     if (test_mode) {
         std::cout << "Running in test mode - exiting immediately\n";
         return 0;
@@ -50,7 +262,7 @@ int main(int argc, char* argv[]) {
     
     try {
         // Create and initialize server
-        g_server = std::make_unique<dnd5e::Server>(server_address);
+        g_server = std::make_unique<dnd5e::Server>(server_address, options);
         
         if (!g_server->Initialize()) {
             std::cerr << "Failed to initialize server\n";
@@ -65,7 +277,11 @@ int main(int argc, char* argv[]) {
             return 1;
         }
         
-        // Wait for server to finish
+        while (g_stop_signal == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        std::cout << "\nReceived signal " << g_stop_signal << ". Shutting down gracefully...\n";
+        g_server->Stop();
         g_server->Wait();
         
     } catch (const std::exception& e) {
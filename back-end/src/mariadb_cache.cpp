@@ -0,0 +1,528 @@
+#include "mariadb_cache.h"
+#include <stdexcept>
+
+#ifdef DND5E_HAVE_MARIADB
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <mysql.h>
+#include <nlohmann/json.hpp>
+#include "bounded_queue.h"
+#include "circuit_breaker.h"
+#include "json_backend.h"
+#include "search_engine.h"
+#endif
+
+namespace dnd5e {
+
+#ifdef DND5E_HAVE_MARIADB
+namespace {
+
+// Match the etag and search_cache.query columns in sql/init/001_init.sql
+constexpr size_t kMaxEtagSize = 128;
+constexpr size_t kMaxSearchQuerySize = 256;
+
+class MariaDbCache final : public L2Cache {
+public:
+    explicit MariaDbCache(const MariaDbOptions& options)
+        : options_(options),
+          json_backend_(CreateJsonBackend()),
+          breaker_(5, std::chrono::milliseconds(10000)),
+          queue_(options.queue_capacity),
+          stopping_(false),
+          hits_(0), misses_(0), errors_(0), writes_queued_(0), writes_stored_(0), writes_dropped_(0) {
+        static std::once_flag library_init;
+        std::call_once(library_init, []() { mysql_library_init(0, nullptr, nullptr); });
+
+        // Only a warning: the server works without its L2 and reconnects later
+        try {
+            Release(Connect(), true);
+        } catch (const std::exception& e) {
+            std::cerr << "MariaDB L2 cache unavailable for now: " << e.what() << std::endl;
+        }
+        writer_ = std::thread(&MariaDbCache::RunWriter, this);
+    }
+
+    ~MariaDbCache() override {
+        stopping_ = true;
+        writer_.join();
+        for (MYSQL* connection : idle_connections_) {
+            mysql_close(connection);
+        }
+    }
+
+    MariaDbCache(const MariaDbCache&) = delete;
+    MariaDbCache& operator=(const MariaDbCache&) = delete;
+    MariaDbCache(MariaDbCache&&) = delete;
+    MariaDbCache& operator=(MariaDbCache&&) = delete;
+
+    const char* GetName() const override {
+        return "mariadb";
+    }
+
+    std::optional<StoredItem> GetItem(const std::string& endpoint, const std::string& index) override {
+        std::optional<StoredItem> stored;
+        bool ok = WithConnection([&](MYSQL* connection) {
+            Query(connection, "SELECT raw_json, etag, UNIX_TIMESTAMP(updated_at) FROM api_cache WHERE " +
+                              Equals(connection, "endpoint", endpoint) + " AND " +
+                              Equals(connection, "item_index", index));
+            Result result(connection);
+            MYSQL_ROW row = mysql_fetch_row(result.get());
+            if (!row) {
+                return;
+            }
+            unsigned long* lengths = mysql_fetch_lengths(result.get());
+            stored.emplace();
+            stored->item.raw_json.assign(row[0], lengths[0]);
+            if (row[1]) {
+                stored->item.validators.etag.assign(row[1], lengths[1]);
+            }
+            stored->stored_at = ParseTimestamp(row[2]);
+        });
+        if (!ok || !stored) {
+            misses_++;
+            return std::nullopt;
+        }
+
+        auto fields = json_backend_->ExtractItemFields(stored->item.raw_json);
+        stored->item.name = std::move(fields.name);
+        stored->item.url = std::move(fields.url);
+        hits_++;
+        return stored;
+    }
+
+    std::optional<StoredList> GetList(const std::string& endpoint) override {
+        std::string body;
+        SystemClock::time_point stored_at;
+        bool ok = WithConnection([&](MYSQL* connection) {
+            Query(connection, "SELECT raw_json, UNIX_TIMESTAMP(updated_at) FROM api_list_cache WHERE " +
+                              Equals(connection, "endpoint", endpoint) + " AND page = 0 AND page_size = 0");
+            Result result(connection);
+            MYSQL_ROW row = mysql_fetch_row(result.get());
+            if (row) {
+                body.assign(row[0], mysql_fetch_lengths(result.get())[0]);
+                stored_at = ParseTimestamp(row[1]);
+            }
+        });
+        // A row we cannot read is a miss, not a connection failure
+        auto items = ok && !body.empty() ? DecodeList(body) : std::nullopt;
+        if (!items) {
+            misses_++;
+            return std::nullopt;
+        }
+        hits_++;
+        StoredList stored;
+        stored.items = std::move(*items);
+        stored.stored_at = stored_at;
+        return stored;
+    }
+
+    void PutItem(const std::string& endpoint, const std::string& index,
+                 std::shared_ptr<const ApiClient::ItemResponse> item) override {
+        Write write;
+        write.endpoint = endpoint;
+        write.index = index;
+        write.item = std::move(item);
+        Enqueue(std::move(write));
+    }
+
+    void PutList(const std::string& endpoint, std::shared_ptr<const ListSnapshot> list,
+                 const ApiClient::Validators& validators) override {
+        // api_list_cache has no validator columns; a restored list is refetched in full
+        (void)validators;
+        Write write;
+        write.endpoint = endpoint;
+        write.list = std::move(list);
+        Enqueue(std::move(write));
+    }
+
+    std::shared_ptr<const std::vector<SearchHit>> GetSearch(const std::string& query,
+                                                           const std::vector<std::string>& endpoints,
+                                                           int max_results, uint64_t dataset_version) override {
+        if (query.size() > kMaxSearchQuerySize || max_results <= 0) {
+            return nullptr;
+        }
+        std::string body;
+        bool ok = WithConnection([&](MYSQL* connection) {
+            Query(connection, "SELECT results FROM search_cache WHERE " + Equals(connection, "query", query) +
+                              " AND BINARY endpoints = " + Quote(connection, JoinEndpoints(endpoints)) +
+                              " ORDER BY id DESC LIMIT 1");
+            Result result(connection);
+            MYSQL_ROW row = mysql_fetch_row(result.get());
+            if (row) {
+                body.assign(row[0], mysql_fetch_lengths(result.get())[0]);
+            }
+        });
+        auto hits = ok && !body.empty() ? DecodeSearch(body, query, max_results, dataset_version) : nullptr;
+        if (!hits) {
+            misses_++;
+            return nullptr;
+        }
+        hits_++;
+        return hits;
+    }
+
+    void PutSearch(const std::string& query, const std::vector<std::string>& endpoints, int max_results,
+                   uint64_t dataset_version, std::shared_ptr<const std::vector<SearchHit>> hits) override {
+        if (query.size() > kMaxSearchQuerySize || max_results <= 0) {
+            return;
+        }
+        Write write;
+        write.endpoint = JoinEndpoints(endpoints);
+        write.index = query;
+        write.search = std::move(hits);
+        write.max_results = max_results;
+        write.dataset_version = dataset_version;
+        Enqueue(std::move(write));
+    }
+
+    L2CacheStats GetStats() const override {
+        L2CacheStats stats;
+        stats.hits = hits_.load();
+        stats.misses = misses_.load();
+        stats.errors = errors_.load();
+        stats.writes_queued = writes_queued_.load();
+        stats.writes_stored = writes_stored_.load();
+        stats.writes_dropped = writes_dropped_.load();
+        return stats;
+    }
+
+private:
+    // Exactly one of item, list or search is set. A search's endpoint set is
+    // in endpoint and its query in index
+    struct Write {
+        std::string endpoint;
+        std::string index;
+        std::shared_ptr<const ApiClient::ItemResponse> item;
+        std::shared_ptr<const ListSnapshot> list;
+        std::shared_ptr<const std::vector<SearchHit>> search;
+        int max_results = 0;
+        uint64_t dataset_version = 0;
+    };
+
+    class Result {
+    public:
+        explicit Result(MYSQL* connection) : result_(mysql_store_result(connection)) {
+            if (!result_) {
+                throw std::runtime_error(mysql_error(connection));
+            }
+        }
+        ~Result() {
+            mysql_free_result(result_);
+        }
+        Result(const Result&) = delete;
+        Result& operator=(const Result&) = delete;
+        MYSQL_RES* get() const { return result_; }
+
+    private:
+        MYSQL_RES* result_;
+    };
+
+    MariaDbOptions options_;
+    std::unique_ptr<JsonBackend> json_backend_;
+    CircuitBreaker breaker_;
+    std::mutex pool_mutex_;
+    std::vector<MYSQL*> idle_connections_;
+    BoundedMpmcQueue<Write> queue_;
+    std::atomic<bool> stopping_;
+    std::atomic<size_t> hits_;
+    std::atomic<size_t> misses_;
+    std::atomic<size_t> errors_;
+    std::atomic<size_t> writes_queued_;
+    std::atomic<size_t> writes_stored_;
+    std::atomic<size_t> writes_dropped_;
+    std::thread writer_;
+
+    MYSQL* Connect() {
+        MYSQL* connection = mysql_init(nullptr);
+        if (!connection) {
+            throw std::runtime_error("mysql_init failed");
+        }
+        mysql_options(connection, MYSQL_OPT_CONNECT_TIMEOUT, &options_.connect_timeout_s);
+        mysql_options(connection, MYSQL_OPT_READ_TIMEOUT, &options_.io_timeout_s);
+        mysql_options(connection, MYSQL_OPT_WRITE_TIMEOUT, &options_.io_timeout_s);
+        mysql_options(connection, MYSQL_SET_CHARSET_NAME, "utf8mb4");
+        if (!mysql_real_connect(connection, options_.host.c_str(), options_.user.c_str(), options_.password.c_str(),
+                                options_.database.c_str(), options_.port, nullptr, 0)) {
+            std::string error = mysql_error(connection);
+            mysql_close(connection);
+            throw std::runtime_error(error);
+        }
+        return connection;
+    }
+
+    MYSQL* Acquire() {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            if (!idle_connections_.empty()) {
+                MYSQL* connection = idle_connections_.back();
+                idle_connections_.pop_back();
+                return connection;
+            }
+        }
+        return Connect();
+    }
+
+    void Release(MYSQL* connection, bool healthy) {
+        if (healthy) {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            if (idle_connections_.size() < options_.max_idle_connections) {
+                idle_connections_.push_back(connection);
+                return;
+            }
+        }
+        mysql_close(connection);
+    }
+
+    // Runs fn on a pooled connection behind the breaker; false if skipped or failed
+    template <typename Fn>
+    bool WithConnection(Fn&& fn) {
+        if (!breaker_.AllowRequest()) {
+            return false;
+        }
+        MYSQL* connection = nullptr;
+        try {
+            connection = Acquire();
+            fn(connection);
+            Release(connection, true);
+            breaker_.RecordSuccess();
+            return true;
+        } catch (const std::exception& e) {
+            // The connection may be mid-result or dead; never reuse it
+            if (connection) {
+                Release(connection, false);
+            }
+            breaker_.RecordFailure();
+            errors_++;
+            std::cerr << "MariaDB L2 cache error: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    static void Query(MYSQL* connection, const std::string& sql) {
+        if (mysql_real_query(connection, sql.data(), sql.size()) != 0) {
+            throw std::runtime_error(mysql_error(connection));
+        }
+    }
+
+    static std::string Quote(MYSQL* connection, const std::string& value) {
+        std::string escaped(value.size() * 2 + 1, '\0');
+        unsigned long length = mysql_real_escape_string(connection, escaped.data(), value.data(), value.size());
+        escaped.resize(length);
+        return "'" + escaped + "'";
+    }
+
+    // Tables created before the key columns became utf8mb4_bin compare them under
+    // unicode_ci, where "Fireball" matches "fireball". The plain comparison keeps
+    // the index usable and BINARY makes the match exact either way
+    static std::string Equals(MYSQL* connection, const char* column, const std::string& value) {
+        std::string quoted = Quote(connection, value);
+        return std::string(column) + " = " + quoted + " AND BINARY " + column + " = " + quoted;
+    }
+
+    static SystemClock::time_point ParseTimestamp(const char* value) {
+        return SystemClock::from_time_t(value ? static_cast<std::time_t>(std::strtoll(value, nullptr, 10)) : 0);
+    }
+
+    static std::string EncodeList(const ListSnapshot& list) {
+        nlohmann::json results = nlohmann::json::array();
+        for (const auto& item : list.items) {
+            results.push_back({{"index", item.index}, {"name", item.name}, {"url", item.url}});
+        }
+        return nlohmann::json{{"count", list.items.size()}, {"results", std::move(results)}}.dump();
+    }
+
+    // Null unless the body is an object with a "results" array
+    static const nlohmann::json* FindResults(const nlohmann::json& json) {
+        if (!json.is_object()) {
+            return nullptr;
+        }
+        auto results = json.find("results");
+        return results != json.end() && results->is_array() ? &*results : nullptr;
+    }
+
+    // Nullopt for a row that is not a list this cache wrote
+    static std::optional<std::vector<ApiClient::ApiItem>> DecodeList(const std::string& body) {
+        auto json = nlohmann::json::parse(body, nullptr, false);
+        const auto* results = FindResults(json);
+        if (!results) {
+            return std::nullopt;
+        }
+        std::vector<ApiClient::ApiItem> items;
+        try {
+            for (const auto& result : *results) {
+                items.push_back({result.value("index", ""), result.value("name", ""), result.value("url", "")});
+            }
+        } catch (const nlohmann::json::exception&) {
+            return std::nullopt;
+        }
+        return items;
+    }
+
+    static std::string JoinEndpoints(const std::vector<std::string>& endpoints) {
+        std::string joined;
+        for (const auto& endpoint : endpoints) {
+            joined += (joined.empty() ? "" : ",") + endpoint;
+        }
+        return joined;
+    }
+
+    // One row per (query, endpoints); the rest of the key rides in the body.
+    // The query is repeated there because the column's collation ignores accents
+    static std::string EncodeSearch(const Write& write) {
+        nlohmann::json results = nlohmann::json::array();
+        for (const auto& hit : *write.search) {
+            results.push_back({{"endpoint", hit.endpoint}, {"index", hit.item.index}, {"name", hit.item.name},
+                               {"url", hit.item.url}, {"matched_field", hit.matched_field},
+                               {"relevance_score", hit.relevance_score}});
+        }
+        return nlohmann::json{{"query", write.index}, {"max_results", write.max_results},
+                              {"dataset_version", write.dataset_version}, {"results", std::move(results)}}.dump();
+    }
+
+    // Results kept for a larger max_results answer a smaller one: they are
+    // sorted stably, so the shorter answer is a prefix
+    static std::shared_ptr<const std::vector<SearchHit>> DecodeSearch(const std::string& body, const std::string& query,
+                                                                      int max_results, uint64_t dataset_version) {
+        auto json = nlohmann::json::parse(body, nullptr, false);
+        const auto* results = FindResults(json);
+        if (!results) {
+            return nullptr;
+        }
+        auto hits = std::make_shared<std::vector<SearchHit>>();
+        try {
+            if (json.value("query", "") != query || json.value("dataset_version", uint64_t{0}) != dataset_version) {
+                return nullptr;
+            }
+            int stored_max = json.value("max_results", 0);
+            if (stored_max < max_results && static_cast<int>(results->size()) >= stored_max) {
+                return nullptr;
+            }
+            for (const auto& result : *results) {
+                if (static_cast<int>(hits->size()) == max_results) {
+                    break;
+                }
+                SearchHit hit;
+                hit.endpoint = result.value("endpoint", "");
+                hit.item = {result.value("index", ""), result.value("name", ""), result.value("url", "")};
+                hit.matched_field = result.value("matched_field", "");
+                hit.relevance_score = result.value("relevance_score", 0.0f);
+                hits->push_back(std::move(hit));
+            }
+        } catch (const nlohmann::json::exception&) {
+            // A field of the wrong type
+            return nullptr;
+        }
+        return hits;
+    }
+
+    void Enqueue(Write write) {
+        if (queue_.TryPush(std::move(write))) {
+            writes_queued_++;
+        } else {
+            writes_dropped_++;
+        }
+    }
+
+    void RunWriter() {
+        std::vector<Write> batch;
+        batch.reserve(options_.batch_size);
+        while (true) {
+            // Read before draining so everything queued before shutdown is flushed
+            bool stopping = stopping_.load();
+            Write write;
+            while (batch.size() < options_.batch_size && queue_.TryPop(write)) {
+                batch.push_back(std::move(write));
+            }
+            if (!batch.empty()) {
+                Flush(batch);
+                batch.clear();
+            } else if (stopping) {
+                return;
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(options_.flush_interval_ms));
+            }
+        }
+    }
+
+    void Flush(const std::vector<Write>& batch) {
+        bool ok = WithConnection([&](MYSQL* connection) {
+            std::string items;
+            std::string lists;
+            std::string searches;
+            std::string replaced_searches;
+            for (const auto& write : batch) {
+                if (write.item) {
+                    const auto& etag = write.item->validators.etag;
+                    items += items.empty() ? "" : ",";
+                    items += "(" + Quote(connection, write.endpoint) + "," + Quote(connection, write.index) + "," +
+                             Quote(connection, write.item->raw_json) + "," +
+                             (etag.empty() || etag.size() > kMaxEtagSize ? "NULL" : Quote(connection, etag)) + ")";
+                } else if (write.list) {
+                    lists += lists.empty() ? "" : ",";
+                    lists += "(" + Quote(connection, write.endpoint) + ",0,0," +
+                             Quote(connection, EncodeList(*write.list)) + ")";
+                } else if (write.search) {
+                    std::string endpoints = Quote(connection, write.endpoint);
+                    searches += searches.empty() ? "" : ",";
+                    searches += "(" + Quote(connection, write.index) + "," + endpoints + "," +
+                                Quote(connection, EncodeSearch(write)) + ")";
+                    replaced_searches += replaced_searches.empty() ? "" : " OR ";
+                    replaced_searches += "(" + Equals(connection, "query", write.index) +
+                                         " AND BINARY endpoints = " + endpoints + ")";
+                }
+            }
+            // updated_at is set explicitly: ON UPDATE only fires when a value changes. On an older
+            // unicode_ci unique key a case variant lands on the same row, so the key
+            // columns are rewritten too and the BINARY lookups never see the wrong body
+            if (!items.empty()) {
+                Query(connection, "INSERT INTO api_cache (endpoint, item_index, raw_json, etag) VALUES " + items +
+                                  " ON DUPLICATE KEY UPDATE endpoint = VALUES(endpoint),"
+                                  " item_index = VALUES(item_index), raw_json = VALUES(raw_json), etag = VALUES(etag),"
+                                  " updated_at = CURRENT_TIMESTAMP");
+            }
+            if (!lists.empty()) {
+                Query(connection, "INSERT INTO api_list_cache (endpoint, page, page_size, raw_json) VALUES " + lists +
+                                  " ON DUPLICATE KEY UPDATE endpoint = VALUES(endpoint), raw_json = VALUES(raw_json),"
+                                  " updated_at = CURRENT_TIMESTAMP");
+            }
+            // search_cache has no unique key to upsert on
+            if (!searches.empty()) {
+                Query(connection, "DELETE FROM search_cache WHERE " + replaced_searches);
+                Query(connection, "INSERT INTO search_cache (query, endpoints, results) VALUES " + searches);
+            }
+        });
+        if (ok) {
+            writes_stored_ += batch.size();
+        } else {
+            writes_dropped_ += batch.size();
+        }
+    }
+};
+
+} // namespace
+#endif
+
+bool IsMariaDbAvailable() {
+#ifdef DND5E_HAVE_MARIADB
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<L2Cache> CreateMariaDbCache(const MariaDbOptions& options) {
+#ifdef DND5E_HAVE_MARIADB
+    return std::make_unique<MariaDbCache>(options);
+#else
+    (void)options;
+    throw std::runtime_error("MariaDB L2 cache requested but this build has no MariaDB client library");
+#endif
+}
+
+} // namespace dnd5e
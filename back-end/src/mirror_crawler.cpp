@@ -0,0 +1,235 @@
+#include "mirror_crawler.h"
+#include "list_stream_parser.h"
+#include "local_data_source.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+namespace dnd5e {
+
+MirrorCrawler::MirrorCrawler(std::shared_ptr<ApiClient> api_client, const MirrorOptions& options)
+    : api_client_(std::move(api_client)), options_(options), stop_requested_(false), active_tasks_(0),
+      tokens_(options.burst), last_refill_(std::chrono::steady_clock::now()) {
+    if (options_.output_dir.empty()) {
+        throw std::invalid_argument("Mirror output directory is required");
+    }
+    if (options_.concurrency == 0) {
+        throw std::invalid_argument("Mirror concurrency must be positive");
+    }
+}
+
+MirrorCrawler::Stats MirrorCrawler::Run() {
+    std::vector<std::string> endpoints = options_.endpoints.empty() ? api_client_->GetEndpoints() : options_.endpoints;
+    std::vector<Task> tasks;
+    for (const auto& endpoint : endpoints) {
+        if (!api_client_->IsValidEndpoint(endpoint)) {
+            throw std::invalid_argument("Invalid endpoint: " + endpoint);
+        }
+        tasks.push_back({endpoint, ""});
+    }
+
+    std::filesystem::create_directories(options_.output_dir);
+    Enqueue(std::move(tasks));
+
+    std::vector<std::thread> workers;
+    workers.reserve(options_.concurrency);
+    for (size_t i = 0; i < options_.concurrency; ++i) {
+        workers.emplace_back(&MirrorCrawler::RunWorker, this);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.stopped = stop_requested_.load();
+    return stats_;
+}
+
+void MirrorCrawler::Stop() {
+    stop_requested_ = true;
+}
+
+void MirrorCrawler::RunWorker() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            // An empty queue only means "done" once no running list can add items to it
+            queue_cv_.wait_for(lock, std::chrono::milliseconds(100), [this]() {
+                return stop_requested_ || !queue_.empty() || active_tasks_ == 0;
+            });
+            if (stop_requested_ || (queue_.empty() && active_tasks_ == 0)) {
+                queue_cv_.notify_all();
+                return;
+            }
+            if (queue_.empty()) {
+                continue;
+            }
+            task = std::move(queue_.front());
+            queue_.pop_front();
+            active_tasks_++;
+        }
+
+        try {
+            if (task.index.empty()) {
+                MirrorList(task.endpoint);
+            } else {
+                MirrorItem(task.endpoint, task.index);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to mirror " << task.endpoint << (task.index.empty() ? "" : "/" + task.index)
+                      << ": " << e.what() << std::endl;
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.failures++;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            active_tasks_--;
+        }
+        queue_cv_.notify_all();
+    }
+}
+
+void MirrorCrawler::Enqueue(std::vector<Task> tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        queue_.insert(queue_.end(), std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()));
+    }
+    queue_cv_.notify_all();
+}
+
+void MirrorCrawler::MirrorList(const std::string& endpoint) {
+    std::string path = GetListPath(endpoint);
+    std::vector<ApiClient::ApiItem> items;
+    bool fetched = false;
+
+    if (std::filesystem::exists(path)) {
+        // Resuming: the list on disk already says which items to expect
+        try {
+            std::ifstream input(path, std::ios::binary);
+            std::string body((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+            ListStreamParser parser;
+            parser.Feed(body.data(), body.size());
+            items = parser.Finish().results;
+        } catch (const std::exception& e) {
+            std::cerr << "Refetching unreadable mirror list " << path << ": " << e.what() << std::endl;
+            std::filesystem::remove(path);
+        }
+    }
+
+    if (!std::filesystem::exists(path)) {
+        if (!AcquireToken()) {
+            return;
+        }
+        auto response = api_client_->GetList(endpoint);
+
+        auto results = nlohmann::json::array();
+        for (const auto& item : response.results) {
+            results.push_back({{"index", item.index}, {"name", item.name}, {"url", item.url}});
+        }
+        WriteFileAtomically(path, nlohmann::json{{"count", response.count}, {"results", std::move(results)}}.dump());
+        items = std::move(response.results);
+        fetched = true;
+    }
+
+    std::vector<Task> tasks;
+    size_t skipped = 0;
+    size_t unsafe = 0;
+    for (const auto& item : items) {
+        if (!IsSafeDataName(item.index)) {
+            std::cerr << "Skipping " << endpoint << " item with unusable index: " << item.index << std::endl;
+            unsafe++;
+        } else if (std::filesystem::exists(GetItemPath(endpoint, item.index))) {
+            skipped++;
+        } else {
+            tasks.push_back({endpoint, item.index});
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        (fetched ? stats_.lists_fetched : stats_.lists_skipped)++;
+        stats_.items_skipped += skipped;
+        stats_.failures += unsafe;
+    }
+    std::cout << "Mirroring " << endpoint << ": " << tasks.size() << " items to fetch, "
+              << skipped << " already on disk" << std::endl;
+
+    std::filesystem::create_directories(std::filesystem::path(options_.output_dir) / endpoint);
+    Enqueue(std::move(tasks));
+}
+
+void MirrorCrawler::MirrorItem(const std::string& endpoint, const std::string& index) {
+    if (!AcquireToken()) {
+        return;
+    }
+    auto item = api_client_->GetItem(endpoint, index);
+    WriteFileAtomically(GetItemPath(endpoint, index), item.raw_json);
+
+    size_t fetched;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        fetched = ++stats_.items_fetched;
+    }
+    if (fetched % 100 == 0) {
+        std::cout << "Mirrored " << fetched << " items" << std::endl;
+    }
+}
+
+bool MirrorCrawler::AcquireToken() {
+    if (options_.requests_per_second <= 0) {
+        return !stop_requested_;
+    }
+
+    while (!stop_requested_) {
+        std::chrono::duration<double> wait;
+        {
+            std::lock_guard<std::mutex> lock(bucket_mutex_);
+            auto now = std::chrono::steady_clock::now();
+            double elapsed = std::chrono::duration<double>(now - last_refill_).count();
+            tokens_ = std::min(std::max(options_.burst, 1.0), tokens_ + elapsed * options_.requests_per_second);
+            last_refill_ = now;
+            if (tokens_ >= 1.0) {
+                tokens_ -= 1.0;
+                return true;
+            }
+            wait = std::chrono::duration<double>((1.0 - tokens_) / options_.requests_per_second);
+        }
+        // Short naps keep Stop() responsive at low rates
+        std::this_thread::sleep_for(std::min<std::chrono::duration<double>>(wait, std::chrono::milliseconds(100)));
+    }
+    return false;
+}
+
+std::string MirrorCrawler::GetListPath(const std::string& endpoint) const {
+    return (std::filesystem::path(options_.output_dir) / (endpoint + ".json")).string();
+}
+
+std::string MirrorCrawler::GetItemPath(const std::string& endpoint, const std::string& index) const {
+    return (std::filesystem::path(options_.output_dir) / endpoint / (index + ".json")).string();
+}
+
+void MirrorCrawler::WriteFileAtomically(const std::string& path, const std::string& contents) {
+    // A crash mid-write leaves only the .part file, which resume ignores
+    std::string temp_path = path + ".part";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Failed to write " + temp_path);
+        }
+    }
+    std::filesystem::rename(temp_path, path);
+}
+
+} // namespace dnd5e
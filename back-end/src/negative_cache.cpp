@@ -0,0 +1,41 @@
+#include "negative_cache.h"
+
+namespace dnd5e {
+
+NegativeCache::NegativeCache(Clock::duration ttl, size_t max_entries)
+    : ttl_(ttl), max_entries_(max_entries) {
+}
+
+bool NegativeCache::Contains(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = expires_at_.find(key);
+    if (it == expires_at_.end()) {
+        return false;
+    }
+    if (Clock::now() >= it->second) {
+        expires_at_.erase(it);
+        return false;
+    }
+    return true;
+}
+
+void NegativeCache::Add(const std::string& key) {
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (expires_at_.size() >= max_entries_ && expires_at_.find(key) == expires_at_.end()) {
+        for (auto it = expires_at_.begin(); it != expires_at_.end();) {
+            it = now >= it->second ? expires_at_.erase(it) : std::next(it);
+        }
+        if (expires_at_.size() >= max_entries_) {
+            expires_at_.clear();
+        }
+    }
+    expires_at_[key] = now + ttl_;
+}
+
+size_t NegativeCache::GetSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return expires_at_.size();
+}
+
+} // namespace dnd5e
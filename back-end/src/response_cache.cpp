@@ -0,0 +1,99 @@
+#include "response_cache.h"
+#include <functional>
+#include <stdexcept>
+
+namespace dnd5e {
+
+namespace {
+    // Rough per-entry bookkeeping (list node, hash node, slice headers)
+    constexpr size_t kEntryOverhead = 192;
+}
+
+ResponseCache::ResponseCache(size_t capacity_bytes, size_t shard_count)
+    : capacity_bytes_(capacity_bytes), shard_capacity_(0), hits_(0), misses_(0), invalidated_(0) {
+    if (shard_count == 0) {
+        throw std::invalid_argument("Response cache needs at least one shard");
+    }
+    shard_capacity_ = capacity_bytes_ / shard_count;
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+std::optional<ResponseCache::Entry> ResponseCache::Get(const std::string& key) {
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        misses_++;
+        return std::nullopt;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    // Copying the ByteBuffer only takes references on its slices
+    return it->second->entry;
+}
+
+void ResponseCache::Put(const std::string& key, Entry entry) {
+    size_t charge = key.size() + entry.response.Length() + entry.endpoint.size() + entry.index.size() + kEntryOverhead;
+    if (charge > shard_capacity_) {
+        return;
+    }
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        shard.bytes -= it->second->charge;
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+    while (!shard.lru.empty() && shard.bytes + charge > shard_capacity_) {
+        auto& victim = shard.lru.back();
+        shard.bytes -= victim.charge;
+        shard.index.erase(victim.key);
+        shard.lru.pop_back();
+        shard.evictions++;
+    }
+    shard.lru.push_front({key, std::move(entry), charge});
+    shard.index[key] = shard.lru.begin();
+    shard.bytes += charge;
+    shard.insertions++;
+}
+
+void ResponseCache::RecordHit() {
+    hits_++;
+}
+
+void ResponseCache::RecordInvalidated(const std::string& key) {
+    invalidated_++;
+    Shard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        shard.bytes -= it->second->charge;
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+}
+
+ResponseCache::Stats ResponseCache::GetStats() const {
+    Stats stats;
+    stats.hits = hits_.load();
+    stats.misses = misses_.load();
+    stats.invalidated = invalidated_.load();
+    stats.capacity_bytes = capacity_bytes_;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.insertions += shard->insertions;
+        stats.evictions += shard->evictions;
+        stats.entries += shard->index.size();
+        stats.bytes += shard->bytes;
+    }
+    return stats;
+}
+
+ResponseCache::Shard& ResponseCache::GetShard(const std::string& key) {
+    return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+} // namespace dnd5e
@@ -2,20 +2,44 @@
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <future>
 #include <iostream>
 
 namespace dnd5e {
 
-SearchEngine::SearchEngine(std::shared_ptr<ApiClient> api_client)
-    : api_client_(api_client) {
+namespace {
+    // Lets an aborted caller stop waiting; the fetch itself runs to completion
+    template <typename T>
+    void WaitUnlessAborted(std::future<T>& future, const RequestControl& control) {
+        if (!control.deadline && !control.is_cancelled) {
+            return;
+        }
+        while (future.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready) {
+            control.ThrowIfAborted();
+        }
+    }
+    
+    // FNV-1a, each field followed by a NUL so field boundaries count
+    uint64_t HashField(uint64_t hash, const std::string& field) {
+        for (unsigned char c : field) {
+            hash = (hash ^ c) * 1099511628211ULL;
+        }
+        return hash * 1099511628211ULL;
+    }
+    
+    constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+}
+
+SearchEngine::SearchEngine(std::shared_ptr<ApiClient> api_client, BackgroundRefresher* refresher, L2Cache* l2_cache)
+    : api_client_(api_client), refresher_(refresher), l2_cache_(l2_cache), refresh_interval_(std::chrono::hours(1)),
+      refresh_jitter_(0.1), fresh_hits_(0), stale_hits_(0), misses_(0), l2_search_hits_(0), search_scans_(0) {
 }
 
 std::vector<SearchHit> SearchEngine::Search(
     const std::string& query,
     const std::vector<std::string>& endpoints,
-    int max_results) {
-    
-    std::vector<SearchHit> all_results;
+    int max_results,
+    const RequestControl& control) {
     
     // If no specific endpoints provided, search all
     std::vector<std::string> search_endpoints = endpoints;
@@ -23,13 +47,103 @@ std::vector<SearchHit> SearchEngine::Search(
         search_endpoints = api_client_->GetEndpoints();
     }
     
+    return ScanLists(NormalizeQuery(query), LoadSearchLists(search_endpoints, control), max_results);
+}
+
+std::shared_ptr<const std::vector<SearchHit>> SearchEngine::CachedSearch(
+    const std::string& query,
+    const std::vector<std::string>& endpoints,
+    int max_results,
+    const RequestControl& control) {
+    
+    std::string normalized_query = NormalizeQuery(query);
+    std::vector<std::string> search_endpoints = endpoints.empty() ? api_client_->GetEndpoints() : endpoints;
+    std::sort(search_endpoints.begin(), search_endpoints.end());
+    search_endpoints.erase(std::unique(search_endpoints.begin(), search_endpoints.end()), search_endpoints.end());
+    
+    if (!result_cache_) {
+        return std::make_shared<const std::vector<SearchHit>>(
+            ScanLists(normalized_query, LoadSearchLists(search_endpoints, control), max_results));
+    }
+    
+    std::string key = normalized_query + "\n";
     for (const auto& endpoint : search_endpoints) {
-        auto endpoint_results = SearchInEndpoint(query, endpoint, max_results);
+        key += endpoint + ",";
+    }
+    key += "\n" + std::to_string(max_results);
+    
+    // Only fresh lists can answer from cache; otherwise the scan below gets them refreshed
+    auto version = FreshDatasetVersion(search_endpoints);
+    if (version) {
+        if (auto hits = result_cache_->Get(key, *version)) {
+            return hits;
+        }
+        if (l2_cache_) {
+            if (auto hits = l2_cache_->GetSearch(normalized_query, search_endpoints, max_results, *version)) {
+                l2_search_hits_++;
+                result_cache_->Put(key, *version, hits);
+                return hits;
+            }
+        }
+    }
+    
+    search_scans_++;
+    auto lists = LoadSearchLists(search_endpoints, control);
+    auto hits = std::make_shared<const std::vector<SearchHit>>(ScanLists(normalized_query, lists, max_results));
+    // Results from stale or placeholder lists are served but not kept
+    uint64_t scanned_version = DatasetVersion(lists);
+    if (FreshDatasetVersion(search_endpoints) == scanned_version) {
+        result_cache_->Put(key, scanned_version, hits);
+        if (l2_cache_) {
+            l2_cache_->PutSearch(normalized_query, search_endpoints, max_results, scanned_version, hits);
+        }
+    }
+    return hits;
+}
+
+std::vector<SearchHit> SearchEngine::SearchInEndpoint(
+    const std::string& query,
+    const std::string& endpoint,
+    int max_results,
+    const RequestControl& control) {
+    
+    return ScanList(NormalizeQuery(query), endpoint, *GetEndpointData(endpoint, control), max_results);
+}
+
+SearchEngine::SearchLists SearchEngine::LoadSearchLists(const std::vector<std::string>& endpoints,
+                                                        const RequestControl& control) {
+    // Fetch every uncached endpoint concurrently before scanning
+    std::vector<std::string> missing_endpoints;
+    {
+        std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+        for (const auto& endpoint : endpoints) {
+            if (cached_data_.find(endpoint) == cached_data_.end()) {
+                missing_endpoints.push_back(endpoint);
+            }
+        }
+    }
+    if (!missing_endpoints.empty()) {
+        PreloadData(missing_endpoints, control);
+    }
+    
+    SearchLists lists;
+    lists.reserve(endpoints.size());
+    for (const auto& endpoint : endpoints) {
+        lists.emplace_back(endpoint, GetEndpointData(endpoint, control));
+    }
+    return lists;
+}
+
+std::vector<SearchHit> SearchEngine::ScanLists(const std::string& query, const SearchLists& lists, int max_results) const {
+    std::vector<SearchHit> all_results;
+    for (const auto& [endpoint, snapshot] : lists) {
+        auto endpoint_results = ScanList(query, endpoint, *snapshot, max_results);
         all_results.insert(all_results.end(), endpoint_results.begin(), endpoint_results.end());
     }
     
-    // Sort by relevance score (highest first)
-    std::sort(all_results.begin(), all_results.end(),
+    // Sort by relevance score (highest first); stable so equal scores keep
+    // list order and a repeated search returns the same page
+    std::stable_sort(all_results.begin(), all_results.end(),
         [](const SearchHit& a, const SearchHit& b) {
             return a.relevance_score > b.relevance_score;
         });
@@ -42,23 +156,18 @@ std::vector<SearchHit> SearchEngine::Search(
     return all_results;
 }
 
-std::vector<SearchHit> SearchEngine::SearchInEndpoint(
-    const std::string& query,
-    const std::string& endpoint,
-    int max_results) {
-    
+std::vector<SearchHit> SearchEngine::ScanList(const std::string& query, const std::string& endpoint,
+                                              const ListSnapshot& list, int max_results) const {
     std::vector<SearchHit> results;
-    auto items = GetEndpointData(endpoint);
-    
-    for (const auto& item : items) {
+    for (const auto& item : list.items) {
         auto result = SearchInItem(item, query, endpoint);
         if (result.has_value()) {
-            results.push_back(result.value());
+            results.push_back(std::move(*result));
         }
     }
     
     // Sort by relevance score
-    std::sort(results.begin(), results.end(),
+    std::stable_sort(results.begin(), results.end(),
         [](const SearchHit& a, const SearchHit& b) {
             return a.relevance_score > b.relevance_score;
         });
@@ -71,16 +180,37 @@ std::vector<SearchHit> SearchEngine::SearchInEndpoint(
     return results;
 }
 
-void SearchEngine::PreloadData(const std::vector<std::string>& endpoints) {
+void SearchEngine::PreloadData(const std::vector<std::string>& endpoints, const RequestControl& control) {
     std::vector<std::string> load_endpoints = endpoints;
     if (load_endpoints.empty()) {
         load_endpoints = api_client_->GetEndpoints();
     }
     
+    // Lists found in memory or L2 are served as by LoadEndpointData. The rest are
+    // fetched on the transport's event loop, all at once so the network waits
+    // overlap, and coalesced with any fetch of the same list already in flight
+    std::vector<std::pair<std::string, std::future<ApiClient::ApiResponse>>> pending;
     for (const auto& endpoint : load_endpoints) {
+        ApiClient::Validators validators;
+        bool expired = false;
+        auto cached = FindCachedList(endpoint, validators, expired);
+        if (cached && (!expired || refresher_)) {
+            LoadEndpointData(endpoint, control);
+            continue;
+        }
+        // There is no async revalidation, so a stale copy without a refresher is refetched whole
+        if (cached) {
+            stale_hits_++;
+        } else {
+            misses_++;
+        }
+        pending.emplace_back(endpoint, api_client_->GetListAsync(endpoint));
+    }
+    
+    for (auto& [endpoint, future] : pending) {
+        WaitUnlessAborted(future, control);
         try {
-            auto response = api_client_->GetList(endpoint);
-            cached_data_[endpoint] = response.results;
+            StoreEndpointData(endpoint, future.get());
         } catch (const std::exception& e) {
             // Log error but continue with other endpoints
             std::cerr << "Failed to preload data for " << endpoint << ": " << e.what() << std::endl;
@@ -89,34 +219,149 @@ void SearchEngine::PreloadData(const std::vector<std::string>& endpoints) {
 }
 
 void SearchEngine::ClearCache() {
+    std::unique_lock<std::shared_mutex> lock(cache_mutex_);
     cached_data_.clear();
 }
 
+std::shared_ptr<const ListSnapshot> SearchEngine::GetList(const std::string& endpoint, const RequestControl& control) {
+    try {
+        return LoadEndpointData(endpoint, control);
+    } catch (const UpstreamError& e) {
+        // Upstream is struggling: a stale list beats no list
+        auto cached = e.IsRetryable() ? GetCachedList(endpoint) : nullptr;
+        if (!cached) {
+            throw;
+        }
+        return cached;
+    }
+}
+
+std::shared_ptr<const ListSnapshot> SearchEngine::GetCachedList(const std::string& endpoint) const {
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+    auto it = cached_data_.find(endpoint);
+    return it != cached_data_.end() ? it->second.snapshot : nullptr;
+}
+
+std::shared_ptr<const ListSnapshot> SearchEngine::GetFreshList(const std::string& endpoint) const {
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+    auto it = cached_data_.find(endpoint);
+    if (it == cached_data_.end() || std::chrono::steady_clock::now() >= it->second.fresh_until) {
+        return nullptr;
+    }
+    return it->second.snapshot;
+}
+
+std::optional<bool> SearchEngine::ContainsIndex(const std::string& endpoint, const std::string& index) const {
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+    auto it = cached_data_.find(endpoint);
+    if (it == cached_data_.end() || std::chrono::steady_clock::now() >= it->second.fresh_until) {
+        return std::nullopt;
+    }
+    return it->second.snapshot->positions.count(index) > 0;
+}
+
 std::unordered_map<std::string, size_t> SearchEngine::GetCacheStats() const {
     std::unordered_map<std::string, size_t> stats;
-    for (const auto& [endpoint, items] : cached_data_) {
-        stats[endpoint] = items.size();
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+    for (const auto& [endpoint, entry] : cached_data_) {
+        stats[endpoint] = entry.snapshot->items.size();
+    }
+    return stats;
+}
+
+SearchEngine::ListCacheStats SearchEngine::GetListCacheStats() const {
+    ListCacheStats stats;
+    stats.fresh_hits = fresh_hits_.load();
+    stats.stale_hits = stale_hits_.load();
+    stats.misses = misses_.load();
+    return stats;
+}
+
+std::vector<SearchEngine::ExportedList> SearchEngine::ExportLists() const {
+    std::vector<ExportedList> exported;
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+    exported.reserve(cached_data_.size());
+    for (const auto& [endpoint, entry] : cached_data_) {
+        exported.push_back({endpoint, entry.snapshot, entry.validators, entry.fresh_until});
+    }
+    return exported;
+}
+
+std::shared_ptr<const ListSnapshot> SearchEngine::RestoreList(const std::string& endpoint, std::vector<ApiClient::ApiItem> items,
+                                                              ApiClient::Validators validators,
+                                                              std::chrono::steady_clock::time_point fresh_until) {
+    CachedList entry;
+    entry.snapshot = MakeSnapshot(std::move(items));
+    entry.validators = std::move(validators);
+    entry.fresh_until = fresh_until;
+    
+    std::unique_lock<std::shared_mutex> lock(cache_mutex_);
+    return cached_data_.emplace(endpoint, std::move(entry)).first->second.snapshot;
+}
+
+void SearchEngine::SetResultCacheSize(size_t max_entries) {
+    result_cache_ = max_entries > 0 ? std::make_unique<SearchResultCache>(max_entries) : nullptr;
+}
+
+std::optional<SearchEngine::SearchCacheStats> SearchEngine::GetSearchCacheStats() const {
+    if (!result_cache_) {
+        return std::nullopt;
     }
+    auto cache = result_cache_->GetStats();
+    SearchCacheStats stats;
+    stats.hits = cache.hits;
+    stats.l2_hits = l2_search_hits_.load();
+    stats.scans = search_scans_.load();
+    stats.invalidated = cache.invalidated;
+    stats.entries = cache.entries;
     return stats;
 }
 
+uint64_t SearchEngine::DatasetVersion(const SearchLists& lists) {
+    uint64_t version = kFnvOffsetBasis;
+    for (const auto& [endpoint, snapshot] : lists) {
+        version = HashField(HashField(version, endpoint), std::to_string(snapshot->version));
+    }
+    return version;
+}
+
+std::optional<uint64_t> SearchEngine::FreshDatasetVersion(const std::vector<std::string>& endpoints) const {
+    auto now = std::chrono::steady_clock::now();
+    uint64_t version = kFnvOffsetBasis;
+    std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+    for (const auto& endpoint : endpoints) {
+        auto it = cached_data_.find(endpoint);
+        if (it == cached_data_.end() || now >= it->second.fresh_until) {
+            return std::nullopt;
+        }
+        version = HashField(HashField(version, endpoint), std::to_string(it->second.snapshot->version));
+    }
+    return version;
+}
+
+void SearchEngine::SetRefreshInterval(std::chrono::seconds interval, double jitter) {
+    refresh_interval_ = interval;
+    refresh_jitter_ = jitter;
+}
+
 float SearchEngine::CalculateRelevanceScore(
-    const ApiClient::ApiItem& item,
+    const std::string& name,
+    const std::string& index,
     const std::string& query,
     const std::string& matched_field) const {
     
     float score = 0.0f;
     
     // Exact match gets highest score
-    if (item.name == query || item.index == query) {
+    if (name == query || index == query) {
         score += 1.0f;
     }
     // Starts with query gets high score
-    else if (item.name.find(query) == 0 || item.index.find(query) == 0) {
+    else if (name.find(query) == 0 || index.find(query) == 0) {
         score += 0.8f;
     }
     // Contains query gets medium score
-    else if (ContainsQuery(item.name, query) || ContainsQuery(item.index, query)) {
+    else if (name.find(query) != std::string::npos || index.find(query) != std::string::npos) {
         score += 0.6f;
     }
     
@@ -131,39 +376,147 @@ float SearchEngine::CalculateRelevanceScore(
     return std::min(score, 1.0f);
 }
 
-bool SearchEngine::ContainsQuery(const std::string& text, const std::string& query) const {
-    if (text.empty() || query.empty()) {
-        return false;
+std::string SearchEngine::NormalizeQuery(const std::string& query) {
+    size_t begin = query.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = query.find_last_not_of(" \t\r\n");
+    std::string normalized = query.substr(begin, end - begin + 1);
+    std::transform(normalized.begin(), normalized.end(), normalized.begin(),
+        [](unsigned char c) { return std::tolower(c); });
+    return normalized;
+}
+
+std::shared_ptr<const ListSnapshot> SearchEngine::GetEndpointData(const std::string& endpoint, const RequestControl& control) {
+    try {
+        return LoadEndpointData(endpoint, control);
+    } catch (const RequestAbortedError&) {
+        throw;
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to get data for " << endpoint << ": " << e.what() << std::endl;
+        
+        // Serve whatever we still have rather than nothing
+        auto cached = GetCachedList(endpoint);
+        return cached ? cached : std::make_shared<const ListSnapshot>();
+    }
+}
+
+std::shared_ptr<const ListSnapshot> SearchEngine::FindCachedList(const std::string& endpoint,
+                                                                 ApiClient::Validators& validators, bool& expired) {
+    {
+        std::shared_lock<std::shared_mutex> lock(cache_mutex_);
+        auto it = cached_data_.find(endpoint);
+        if (it != cached_data_.end()) {
+            validators = it->second.validators;
+            expired = std::chrono::steady_clock::now() >= it->second.fresh_until;
+            return it->second.snapshot;
+        }
     }
     
-    // Convert both to lowercase for case-insensitive search
-    std::string lower_text = text;
-    std::string lower_query = query;
+    if (l2_cache_) {
+        if (auto stored = l2_cache_->GetList(endpoint)) {
+            auto fresh_until = L2Cache::FreshUntil(stored->stored_at, JitterTtl(refresh_interval_, refresh_jitter_));
+            validators = stored->validators;
+            expired = std::chrono::steady_clock::now() >= fresh_until;
+            return RestoreList(endpoint, std::move(stored->items), std::move(stored->validators), fresh_until);
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const ListSnapshot> SearchEngine::LoadEndpointData(const std::string& endpoint, const RequestControl& control) {
+    ApiClient::Validators validators;
+    bool expired = false;
+    auto cached = FindCachedList(endpoint, validators, expired);
+    if (cached && !expired) {
+        fresh_hits_++;
+        return cached;
+    }
     
-    std::transform(lower_text.begin(), lower_text.end(), lower_text.begin(),
-        [](unsigned char c) { return std::tolower(c); });
-    std::transform(lower_query.begin(), lower_query.end(), lower_query.begin(),
-        [](unsigned char c) { return std::tolower(c); });
+    if (!cached) {
+        misses_++;
+        return RefreshEndpointData(endpoint, validators, control);
+    }
     
-    return lower_text.find(lower_query) != std::string::npos;
+    stale_hits_++;
+    if (!refresher_) {
+        return RefreshEndpointData(endpoint, validators, control);
+    }
+    // Stale-while-revalidate: this caller gets the old list right away
+    refresher_->Schedule("list:" + endpoint, [this, endpoint, validators]() {
+        RefreshEndpointData(endpoint, validators, {});
+    });
+    return cached;
 }
 
-std::vector<ApiClient::ApiItem> SearchEngine::GetEndpointData(const std::string& endpoint) {
-    // Check cache first
-    auto it = cached_data_.find(endpoint);
-    if (it != cached_data_.end()) {
-        return it->second;
+std::shared_ptr<const ListSnapshot> SearchEngine::RefreshEndpointData(
+    const std::string& endpoint,
+    const ApiClient::Validators& validators,
+    const RequestControl& control) {
+    
+    if (!validators.etag.empty() || !validators.last_modified.empty()) {
+        auto response = api_client_->GetListIfModified(endpoint, validators, control);
+        if (response.has_value()) {
+            return StoreEndpointData(endpoint, std::move(response.value()));
+        }
+        
+        // 304: keep the parsed list and just restart its freshness window
+        std::shared_ptr<const ListSnapshot> snapshot;
+        {
+            std::unique_lock<std::shared_mutex> lock(cache_mutex_);
+            auto it = cached_data_.find(endpoint);
+            if (it != cached_data_.end()) {
+                it->second.fresh_until = NextFreshUntil();
+                snapshot = it->second.snapshot;
+            }
+        }
+        if (snapshot) {
+            // Restarts the stored copy's age too
+            if (l2_cache_) {
+                l2_cache_->PutList(endpoint, snapshot, validators);
+            }
+            return snapshot;
+        }
     }
     
     // Fetch from API and cache
-    try {
-        auto response = api_client_->GetList(endpoint);
-        cached_data_[endpoint] = response.results;
-        return response.results;
-    } catch (const std::exception& e) {
-        std::cerr << "Failed to get data for " << endpoint << ": " << e.what() << std::endl;
-        return {};
+    return StoreEndpointData(endpoint, api_client_->GetList(endpoint, control));
+}
+
+std::chrono::steady_clock::time_point SearchEngine::NextFreshUntil() const {
+    return std::chrono::steady_clock::now() + JitterTtl(refresh_interval_, refresh_jitter_);
+}
+
+std::shared_ptr<const ListSnapshot> SearchEngine::StoreEndpointData(const std::string& endpoint, ApiClient::ApiResponse response) {
+    auto snapshot = MakeSnapshot(std::move(response.results));
+    
+    if (l2_cache_) {
+        l2_cache_->PutList(endpoint, snapshot, response.validators);
+    }
+    
+    CachedList entry;
+    entry.snapshot = snapshot;
+    entry.validators = std::move(response.validators);
+    entry.fresh_until = NextFreshUntil();
+    
+    std::unique_lock<std::shared_mutex> lock(cache_mutex_);
+    cached_data_[endpoint] = std::move(entry);
+    return snapshot;
+}
+
+std::shared_ptr<const ListSnapshot> SearchEngine::MakeSnapshot(std::vector<ApiClient::ApiItem> items) {
+    auto snapshot = std::make_shared<ListSnapshot>();
+    snapshot->items = std::move(items);
+    snapshot->positions.reserve(snapshot->items.size());
+    uint64_t version = kFnvOffsetBasis;
+    for (size_t i = 0; i < snapshot->items.size(); ++i) {
+        const auto& item = snapshot->items[i];
+        snapshot->positions.emplace(item.index, i);
+        version = HashField(HashField(HashField(version, item.index), item.name), item.url);
     }
+    snapshot->version = version;
+    return snapshot;
 }
 
 std::optional<SearchHit> SearchEngine::SearchInItem(
@@ -171,28 +524,34 @@ std::optional<SearchHit> SearchEngine::SearchInItem(
     const std::string& query,
     const std::string& endpoint) const {
     
-    std::string matched_field;
-    bool found = false;
+    if (query.empty()) {
+        return std::nullopt;
+    }
+    
+    // query is already normalized; match case-insensitively
+    std::string name = item.name;
+    std::string index = item.index;
+    for (std::string* text : {&name, &index}) {
+        std::transform(text->begin(), text->end(), text->begin(),
+            [](unsigned char c) { return std::tolower(c); });
+    }
     
+    std::string matched_field;
     // Check name field
-    if (ContainsQuery(item.name, query)) {
+    if (name.find(query) != std::string::npos) {
         matched_field = "name";
-        found = true;
     }
     // Check index field
-    else if (ContainsQuery(item.index, query)) {
+    else if (index.find(query) != std::string::npos) {
         matched_field = "index";
-        found = true;
-    }
-    
-    if (!found) {
+    } else {
         return std::nullopt;
     }
     
     SearchHit result;
     result.item = item;
     result.matched_field = matched_field;
-    result.relevance_score = CalculateRelevanceScore(item, query, matched_field);
+    result.relevance_score = CalculateRelevanceScore(name, index, query, matched_field);
     result.endpoint = endpoint;
     
     return result;
@@ -0,0 +1,58 @@
+#include "search_result_cache.h"
+#include <stdexcept>
+
+namespace dnd5e {
+
+SearchResultCache::SearchResultCache(size_t max_entries)
+    : max_entries_(max_entries), hits_(0), misses_(0), invalidated_(0) {
+    if (max_entries_ == 0) {
+        throw std::invalid_argument("Search result cache needs room for at least one entry");
+    }
+}
+
+SearchResultCache::Hits SearchResultCache::Get(const std::string& key, uint64_t dataset_version) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        misses_++;
+        return nullptr;
+    }
+    if (it->second->dataset_version != dataset_version) {
+        invalidated_++;
+        lru_.erase(it->second);
+        index_.erase(it);
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    hits_++;
+    return it->second->hits;
+}
+
+void SearchResultCache::Put(const std::string& key, uint64_t dataset_version, Hits hits) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        it->second->dataset_version = dataset_version;
+        it->second->hits = std::move(hits);
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+    if (lru_.size() >= max_entries_) {
+        index_.erase(lru_.back().key);
+        lru_.pop_back();
+    }
+    lru_.push_front({key, dataset_version, std::move(hits)});
+    index_[key] = lru_.begin();
+}
+
+SearchResultCache::Stats SearchResultCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.invalidated = invalidated_;
+    stats.entries = index_.size();
+    return stats;
+}
+
+} // namespace dnd5e
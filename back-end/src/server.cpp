@@ -1,4 +1,6 @@
 #include "server.h"
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/health_check_service_interface.h>
@@ -6,17 +8,82 @@
 
 namespace dnd5e {
 
-Server::Server(const std::string& server_address)
-    : server_address_(server_address), is_running_(false) {
+Server::Server(const std::string& server_address, const ServerOptions& options)
+    : server_address_(server_address), options_(options), is_running_(false), periodic_stopping_(false) {
+}
+
+Server::~Server() {
+    StopPeriodic();
 }
 
 bool Server::Initialize() {
     try {
         // Create API client
-        auto api_client = std::make_shared<ApiClient>();
+        std::unique_ptr<UpstreamTransport> transport;
+        if (options_.fake_upstream) {
+            FakeTransportOptions fake_options = *options_.fake_upstream;
+            fake_options.base_url = options_.api_base_url;
+            auto fake = std::make_unique<FakeTransport>(fake_options);
+            std::cout << "Using fake upstream from " << fake_options.data_dir << " (" << fake->GetEntryCount()
+                      << " entries, median latency " << fake_options.latency_median_ms << " ms, error rate "
+                      << fake_options.error_rate * 100 << "%)" << std::endl;
+            transport = std::move(fake);
+        }
+        api_client_ = std::make_shared<ApiClient>(options_.api_base_url, options_.api_client, std::move(transport));
+        if (const LocalDataSource* local_source = api_client_->GetLocalDataSource()) {
+            std::cout << "Serving from local data " << local_source->GetPath()
+                      << " (no upstream traffic)" << std::endl;
+        }
+        if (options_.api_client.http2) {
+            std::cout << "Upstream HTTP/2 multiplexing enabled (max streams: "
+                      << options_.api_client.http2_max_streams << ")" << std::endl;
+        }
+        if (options_.api_client.hedge) {
+            std::cout << "Upstream request hedging enabled (p" << options_.api_client.hedge_percentile * 100
+                      << ", budget " << options_.api_client.hedge_budget * 100 << "%)" << std::endl;
+        }
+        std::cout << "Item JSON backend: " << api_client_->GetJsonBackendName() << std::endl;
+        
+        if (options_.warm_connections > 0 && !api_client_->GetLocalDataSource()) {
+            // Pay DNS and TLS here rather than on the first requests after a deploy
+            WarmUpstream();
+            StartPeriodic(options_.warm_interval, [this]() { api_client_->WarmUp(options_.warm_connections); });
+        }
         
         // Create service implementation
-        service_ = std::make_unique<Dnd5eServiceImpl>(api_client);
+        std::shared_ptr<L2Cache> l2_cache;
+        if (options_.mariadb && options_.kv_store) {
+            throw std::invalid_argument("Use either a MariaDB or an embedded L2 cache, not both");
+        }
+        if (options_.kv_store) {
+            l2_cache = OpenKvStoreCache(*options_.kv_store);
+        }
+        if (options_.mariadb) {
+            l2_cache = CreateMariaDbCache(*options_.mariadb);
+            std::cout << "MariaDB L2 cache: " << options_.mariadb->user << "@" << options_.mariadb->host << ":"
+                      << options_.mariadb->port << "/" << options_.mariadb->database << std::endl;
+        }
+        service_ = std::make_unique<Dnd5eServiceImpl>(api_client_, options_.service, std::move(l2_cache));
+        if (options_.service.item_cache_bytes > 0) {
+            std::cout << "Item cache budget: " << options_.service.item_cache_bytes / 1024 << " KiB ("
+                      << (options_.service.item_cache_policy == CachePolicy::TinyLfu ? "W-TinyLFU" : "LRU") << ")"
+                      << std::endl;
+        }
+        if (options_.response_cache_bytes > 0) {
+            cached_service_ = std::make_unique<CachedResponseService>(*service_, options_.response_cache_bytes,
+                                                                      options_.response_miss_threads,
+                                                                      options_.response_miss_queue);
+            std::cout << "Response cache budget: " << options_.response_cache_bytes / 1024 << " KiB" << std::endl;
+        }
+        std::cout << "Cache TTL " << options_.service.cache_ttl.count() << " s +/- "
+                  << options_.service.cache_ttl_jitter * 100 << "%, "
+                  << (options_.service.refresh_threads > 0 ? "stale entries refreshed in the background"
+                                                           : "stale entries refreshed inline") << std::endl;
+        
+        if (!options_.snapshot_path.empty()) {
+            LoadSnapshot();
+            StartPeriodic(options_.snapshot_interval, [this]() { SaveSnapshot(); });
+        }
         
         return true;
     } catch (const std::exception& e) {
@@ -51,6 +118,11 @@ void Server::Stop() {
         std::cout << "Stopping server..." << std::endl;
         server_->Shutdown();
         is_running_ = false;
+        StopPeriodic();
+        if (!options_.snapshot_path.empty()) {
+            SaveSnapshot();
+        }
+        LogStats();
     }
 }
 
@@ -68,12 +140,179 @@ const std::string& Server::GetAddress() const {
     return server_address_;
 }
 
+void Server::LogStats() const {
+    if (!api_client_) {
+        return;
+    }
+    
+    std::cout << "Upstream request stats:" << std::endl;
+    for (const auto& [name, value] : api_client_->GetRequestStats()) {
+        std::cout << "  " << name << ": " << value << std::endl;
+    }
+    
+    if (options_.api_client.hedge) {
+        auto hedge = api_client_->GetHedgeStats();
+        double hedge_rate = hedge.primary_requests > 0
+            ? 100.0 * static_cast<double>(hedge.hedges_sent) / static_cast<double>(hedge.primary_requests)
+            : 0.0;
+        double win_rate = hedge.hedges_sent > 0
+            ? 100.0 * static_cast<double>(hedge.hedges_won) / static_cast<double>(hedge.hedges_sent)
+            : 0.0;
+        std::cout << "Upstream hedging: " << hedge.hedges_sent << " hedges for " << hedge.primary_requests
+                  << " requests (" << std::fixed << std::setprecision(1) << hedge_rate << "% hedged, "
+                  << win_rate << "% won, " << hedge.hedges_throttled << " throttled by budget)" << std::endl;
+    }
+    
+    for (const auto& endpoint : api_client_->GetEndpoints()) {
+        const CircuitBreaker* breaker = api_client_->GetCircuitBreaker(endpoint);
+        if (breaker && breaker->GetTripCount() > 0) {
+            std::cout << "Upstream circuit for " << endpoint << ": opened " << breaker->GetTripCount()
+                      << " times, " << breaker->GetRejectedCount() << " requests failed fast" << std::endl;
+        }
+    }
+    
+    std::cout << "Upstream transfer stats (wire / decoded bytes):" << std::endl;
+    for (const auto& [endpoint, stats] : api_client_->GetTransferStats()) {
+        double saved = stats.decoded_bytes > 0
+            ? 100.0 * (1.0 - static_cast<double>(stats.wire_bytes) / static_cast<double>(stats.decoded_bytes))
+            : 0.0;
+        std::cout << "  " << endpoint << ": " << stats.requests << " requests, "
+                  << stats.wire_bytes << " / " << stats.decoded_bytes << " bytes ("
+                  << std::fixed << std::setprecision(1) << saved << "% saved)" << std::endl;
+    }
+    
+    if (!service_) {
+        return;
+    }
+    
+    auto lists = service_->GetSearchEngine().GetListCacheStats();
+    std::cout << "List cache: " << lists.fresh_hits << " fresh hits, " << lists.stale_hits << " stale hits, "
+              << lists.misses << " blocking misses" << std::endl;
+    
+    if (auto searches = service_->GetSearchEngine().GetSearchCacheStats()) {
+        std::cout << "Search cache: " << searches->hits << " hits, " << searches->l2_hits << " L2 hits, "
+                  << searches->scans << " scans, " << searches->invalidated << " invalidated by new data, "
+                  << searches->entries << " searches kept" << std::endl;
+    }
+    
+    if (const ItemCache* item_cache = service_->GetItemCache()) {
+        auto cache = item_cache->GetStats();
+        size_t lookups = cache.fresh_hits + cache.stale_hits + cache.misses;
+        double hit_rate = lookups > 0
+            ? 100.0 * static_cast<double>(cache.fresh_hits + cache.stale_hits) / static_cast<double>(lookups)
+            : 0.0;
+        std::cout << "Item cache: " << cache.fresh_hits << " fresh hits, " << cache.stale_hits << " stale hits, "
+                  << cache.misses << " blocking misses (" << std::fixed << std::setprecision(1) << hit_rate
+                  << "% hit rate), " << cache.evictions << " evictions, " << cache.rejections << " rejected by admission, " << cache.entries << " items in "
+                  << cache.bytes << " / " << cache.capacity_bytes << " bytes" << std::endl;
+    }
+    
+    if (cached_service_) {
+        auto responses = cached_service_->GetStats();
+        std::cout << "Response cache: " << responses.hits << " hits, " << responses.misses << " misses, "
+                  << responses.invalidated << " invalidated, " << responses.evictions << " evictions, "
+                  << responses.entries << " responses in " << responses.bytes << " / " << responses.capacity_bytes
+                  << " bytes; " << cached_service_->GetRejectedMisses() << " misses rejected with the queue full"
+                  << std::endl;
+    }
+    
+    auto not_found = service_->GetNotFoundStats();
+    std::cout << "GetItem NOT_FOUND: " << not_found.rejected_by_list << " rejected by cached lists, "
+              << not_found.negative_hits << " from recent 404s, " << not_found.upstream_not_found
+              << " upstream 404s" << std::endl;
+    
+    if (const BackgroundRefresher* refresher = service_->GetRefresher()) {
+        auto refreshes = refresher->GetStats();
+        std::cout << "Background refreshes: " << refreshes.completed << " completed, " << refreshes.failed
+                  << " failed, " << refreshes.skipped << " skipped as already pending" << std::endl;
+    }
+    
+    if (const L2Cache* l2_cache = service_->GetL2Cache()) {
+        auto l2 = l2_cache->GetStats();
+        std::cout << "L2 cache (" << l2_cache->GetName() << "): " << l2.hits << " hits, " << l2.misses << " misses, "
+                  << l2.errors << " errors; " << l2.writes_stored << " of " << l2.writes_queued << " writes stored, "
+                  << l2.writes_dropped << " dropped";
+        if (l2.compactions > 0) {
+            std::cout << "; " << l2.compactions << " compactions";
+        }
+        std::cout << std::endl;
+    }
+}
+
+void Server::WarmUpstream() {
+    auto start = std::chrono::steady_clock::now();
+    size_t warmed = api_client_->WarmUp(options_.warm_connections);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "Warmed " << warmed << "/" << options_.warm_connections << " upstream connections in "
+              << elapsed.count() << " ms" << std::endl;
+}
+
+void Server::SaveSnapshot() {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    try {
+        auto start = std::chrono::steady_clock::now();
+        auto stats = service_->SaveCacheSnapshot(options_.snapshot_path);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "Saved cache snapshot " << options_.snapshot_path << " (" << stats.lists << " lists, "
+                  << stats.items << " items, " << stats.bytes << " bytes) in " << elapsed.count() << " ms" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to save cache snapshot: " << e.what() << std::endl;
+    }
+}
+
+void Server::LoadSnapshot() {
+    try {
+        auto start = std::chrono::steady_clock::now();
+        auto stats = service_->LoadCacheSnapshot(options_.snapshot_path);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        if (stats) {
+            std::cout << "Restored " << stats->lists << " lists and " << stats->items << " items from "
+                      << options_.snapshot_path << " in " << elapsed.count() / 1000.0 << " ms" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        // A snapshot only saves upstream calls; starting cold is always safe
+        std::cerr << "Skipping cache snapshot: " << e.what() << std::endl;
+    }
+}
+
+void Server::StartPeriodic(std::chrono::seconds interval, std::function<void()> task) {
+    if (interval.count() <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(periodic_mutex_);
+    periodic_threads_.emplace_back([this, interval, task = std::move(task)]() {
+        std::unique_lock<std::mutex> lock(periodic_mutex_);
+        while (!periodic_cv_.wait_for(lock, interval, [this]() { return periodic_stopping_; })) {
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    });
+}
+
+void Server::StopPeriodic() {
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(periodic_mutex_);
+        periodic_stopping_ = true;
+        threads.swap(periodic_threads_);
+    }
+    periodic_cv_.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
 void Server::SetupServerBuilder(grpc::ServerBuilder& builder) {
     // Add listening port
     builder.AddListeningPort(server_address_, grpc::InsecureServerCredentials());
     
     // Register service
-    builder.RegisterService(service_.get());
+    if (cached_service_) {
+        builder.RegisterService(cached_service_.get());
+    } else {
+        builder.RegisterService(service_.get());
+    }
     
     // Enable health checking
     grpc::EnableDefaultHealthCheckService(true);
@@ -0,0 +1,42 @@
+#include "upstream_transport.h"
+#include "upstream_error.h"
+
+namespace dnd5e {
+
+bool UpstreamResponse::AppendBody(const char* data, size_t size) {
+    decoded_bytes += size;
+
+    // Error bodies and anything but a 200 keep the buffered path
+    if (body_consumer && status == 200) {
+        try {
+            body_consumer(data, size);
+        } catch (...) {
+            body_error = std::current_exception();
+            return false;
+        }
+        return true;
+    }
+
+    body.append(data, size);
+    return true;
+}
+
+bool RequestControl::IsCancelled() const {
+    return is_cancelled && is_cancelled();
+}
+
+bool RequestControl::IsExpired() const {
+    return deadline && std::chrono::steady_clock::now() >= *deadline;
+}
+
+void RequestControl::ThrowIfAborted() const {
+    // gRPC also marks a call cancelled once its deadline passes, so expiry goes first
+    if (IsExpired()) {
+        throw DeadlineExceededError();
+    }
+    if (IsCancelled()) {
+        throw RequestCancelledError();
+    }
+}
+
+} // namespace dnd5e
@@ -0,0 +1,181 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include "dnd5e_service.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    // Header field offsets, see the layout in cache_snapshot.cpp
+    constexpr size_t kRecordCountOffset = 12;
+    constexpr size_t kSavedAtOffset = 16;
+
+    ServiceOptions Options() {
+        ServiceOptions options;
+        options.refresh_threads = 0;
+        options.cache_ttl_jitter = 0;
+        return options;
+    }
+
+    grpc::StatusCode FetchList(Dnd5eServiceImpl& service) {
+        GetListRequest request;
+        request.set_endpoint("spells");
+        GetListResponse response;
+        return service.GetList(nullptr, &request, &response).error_code();
+    }
+
+    grpc::StatusCode FetchItem(Dnd5eServiceImpl& service, const std::string& index) {
+        GetItemRequest request;
+        request.set_endpoint("spells");
+        request.set_index(index);
+        GetItemResponse response;
+        return service.GetItem(nullptr, &request, &response).error_code();
+    }
+
+    std::string ReadFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    void WriteFile(const std::string& path, const std::string& contents) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+    }
+
+    template <typename T>
+    void Patch(std::string& contents, size_t offset, T value) {
+        std::memcpy(&contents[offset], &value, sizeof(T));
+    }
+
+    // A snapshot holding the spells list and two items
+    struct Saved {
+        TempDir data{"snapshot-data"};
+        std::string path;
+
+        Saved() {
+            WriteDataDir(data.Path(), {{"spells", {"fireball", "shield"}}});
+            path = data.File("cache.snap");
+            Dnd5eServiceImpl service(MakeFakeClient(data.Path(), std::make_shared<RequestCounts>(), 1.0), Options());
+            CHECK_EQ(FetchList(service), grpc::StatusCode::OK);
+            CHECK_EQ(FetchItem(service, "fireball"), grpc::StatusCode::OK);
+            CHECK_EQ(FetchItem(service, "shield"), grpc::StatusCode::OK);
+            auto stats = service.SaveCacheSnapshot(path);
+            CHECK_EQ(stats.lists, size_t{1});
+            CHECK_EQ(stats.items, size_t{2});
+        }
+    };
+
+    // Loading throws with this in the message, or returns "" if it loaded
+    std::string LoadError(Dnd5eServiceImpl& service, const std::string& path) {
+        try {
+            service.LoadCacheSnapshot(path);
+        } catch (const std::runtime_error& e) {
+            return e.what();
+        }
+        return "";
+    }
+
+    void RestartServesFromSnapshot() {
+        Saved saved;
+        auto counts = std::make_shared<RequestCounts>();
+        Dnd5eServiceImpl service(MakeFakeClient(saved.data.Path(), counts, 1.0), Options());
+        auto stats = service.LoadCacheSnapshot(saved.path);
+        CHECK(stats.has_value());
+        CHECK_EQ(stats->lists, size_t{1});
+        CHECK_EQ(stats->items, size_t{2});
+
+        CHECK(service.GetSearchEngine().GetFreshList("spells") != nullptr);
+        CHECK_EQ(FetchList(service), grpc::StatusCode::OK);
+        CHECK_EQ(FetchItem(service, "fireball"), grpc::StatusCode::OK);
+        CHECK_EQ(FetchItem(service, "shield"), grpc::StatusCode::OK);
+        CHECK_EQ(counts->Total(), size_t{0});
+
+        CHECK(!service.LoadCacheSnapshot(saved.data.File("missing.snap")).has_value());
+    }
+
+    void TimeOnDiskAgesEntries() {
+        Saved saved;
+        std::string contents = ReadFile(saved.path);
+        // Saved two hours ago, longer than the one hour TTL
+        auto saved_at = std::chrono::system_clock::now() - std::chrono::hours(2);
+        Patch(contents, kSavedAtOffset,
+              static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                  saved_at.time_since_epoch()).count()));
+        WriteFile(saved.path, contents);
+
+        auto counts = std::make_shared<RequestCounts>();
+        Dnd5eServiceImpl service(MakeFakeClient(saved.data.Path(), counts, 1.0), Options());
+        CHECK(service.LoadCacheSnapshot(saved.path).has_value());
+
+        // Restored, but stale: each one is revalidated before it is served
+        CHECK(service.GetSearchEngine().GetFreshList("spells") == nullptr);
+        CHECK_EQ(FetchList(service), grpc::StatusCode::OK);
+        CHECK_EQ(FetchItem(service, "fireball"), grpc::StatusCode::OK);
+        CHECK_EQ(counts->For("/spells"), size_t{1});
+        CHECK_EQ(counts->For("/spells/fireball"), size_t{1});
+        CHECK(service.GetSearchEngine().GetFreshList("spells") != nullptr);
+    }
+
+    void DifferentUpstreamIsRejected() {
+        Saved saved;
+        auto counts = std::make_shared<RequestCounts>();
+        auto other = std::make_shared<ApiClient>(
+            "http://other.test/api/2014", ApiClientOptions(),
+            std::make_unique<CountingTransport>(FakeOptions(saved.data.Path(), "http://other.test/api/2014", 1.0),
+                                                counts));
+        Dnd5eServiceImpl service(other, Options());
+        CHECK(LoadError(service, saved.path).find("different upstream") != std::string::npos);
+        CHECK(service.GetSearchEngine().GetFreshList("spells") == nullptr);
+        CHECK(service.GetItemCache()->GetStats().entries == 0);
+    }
+
+    void CorruptSnapshotsRestoreNothing() {
+        Saved saved;
+        const std::string original = ReadFile(saved.path);
+        auto list_record = original.find("spells");
+        CHECK(list_record != std::string::npos);
+        // The list payload's item count follows the record key, its validators and nothing else
+        auto list_count = original.find(std::string("\x02\0\0\0", 4), list_record);
+        CHECK(list_count != std::string::npos);
+
+        auto record_count = original;
+        Patch(record_count, kRecordCountOffset, uint32_t{0xFFFFFFFF});
+        auto item_count = original;
+        Patch(item_count, list_count, uint32_t{0x7FFFFFFF});
+        auto flipped_magic = original;
+        flipped_magic[0] = 'X';
+        auto trailing = original + "x";
+
+        for (const auto& [name, contents] : {std::pair{"truncated", original.substr(0, original.size() - 3)},
+                                             std::pair{"record count", record_count},
+                                             std::pair{"item count", item_count},
+                                             std::pair{"magic", flipped_magic},
+                                             std::pair{"trailing bytes", trailing},
+                                             std::pair{"empty", std::string()}}) {
+            WriteFile(saved.path, contents);
+            Dnd5eServiceImpl service(MakeFakeClient(saved.data.Path(), std::make_shared<RequestCounts>(), 1.0),
+                                     Options());
+            if (LoadError(service, saved.path).empty()) {
+                std::cerr << "loaded a snapshot with a bad " << name << std::endl;
+                CHECK(false);
+            }
+            CHECK(service.GetSearchEngine().GetFreshList("spells") == nullptr);
+            CHECK(service.GetItemCache()->GetStats().entries == 0);
+        }
+    }
+}
+
+int main() {
+    Run("RestartServesFromSnapshot", RestartServesFromSnapshot);
+    Run("TimeOnDiskAgesEntries", TimeOnDiskAgesEntries);
+    Run("DifferentUpstreamIsRejected", DifferentUpstreamIsRejected);
+    Run("CorruptSnapshotsRestoreNothing", CorruptSnapshotsRestoreNothing);
+    return Finish();
+}
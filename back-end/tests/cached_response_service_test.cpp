@@ -0,0 +1,104 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+
+#include "cached_response_service.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    // One miss worker with room for one more waiting miss
+    struct Harness {
+        TempDir data{"response-cache-data"};
+        std::shared_ptr<RequestCounts> counts = std::make_shared<RequestCounts>();
+        std::unique_ptr<Dnd5eServiceImpl> service;
+        std::unique_ptr<CachedResponseService> cached;
+        std::unique_ptr<grpc::Server> server;
+        std::unique_ptr<Dnd5eService::Stub> stub;
+
+        explicit Harness(double latency_ms) {
+            WriteDataDir(data.Path(), {{"spells", {"bless", "fireball", "shield"}}});
+            ServiceOptions options;
+            options.refresh_threads = 0;
+            service = std::make_unique<Dnd5eServiceImpl>(MakeFakeClient(data.Path(), counts, latency_ms), options);
+            cached = std::make_unique<CachedResponseService>(*service, size_t{1} << 20, 1, 1);
+            grpc::ServerBuilder builder;
+            builder.RegisterService(cached.get());
+            server = builder.BuildAndStart();
+            stub = Dnd5eService::NewStub(server->InProcessChannel(grpc::ChannelArguments()));
+        }
+
+        ~Harness() {
+            server->Shutdown();
+        }
+
+        grpc::StatusCode FetchItem(const std::string& index) {
+            GetItemRequest request;
+            request.set_endpoint("spells");
+            request.set_index(index);
+            GetItemResponse response;
+            grpc::ClientContext context;
+            return stub->GetItem(&context, request, &response).error_code();
+        }
+
+        grpc::StatusCode FetchList() {
+            GetListRequest request;
+            request.set_endpoint("spells");
+            request.set_page_size(10);
+            GetListResponse response;
+            grpc::ClientContext context;
+            auto status = stub->GetList(&context, request, &response);
+            CHECK(!status.ok() || response.items_size() == 3);
+            return status.error_code();
+        }
+    };
+
+    void RepeatedRequestsAreAnsweredFromTheCache() {
+        Harness harness(1.0);
+        CHECK_EQ(harness.FetchList(), grpc::StatusCode::OK);
+        CHECK_EQ(harness.FetchItem("fireball"), grpc::StatusCode::OK);
+        for (int i = 0; i < 3; ++i) {
+            CHECK_EQ(harness.FetchList(), grpc::StatusCode::OK);
+            CHECK_EQ(harness.FetchItem("fireball"), grpc::StatusCode::OK);
+        }
+        auto stats = harness.cached->GetStats();
+        CHECK_EQ(stats.misses, size_t{2});
+        CHECK_EQ(stats.hits, size_t{6});
+        CHECK_EQ(harness.counts->Total(), size_t{2});
+    }
+
+    void FullMissQueueIsResourceExhausted() {
+        Harness harness(300.0);
+        const std::vector<std::string> indexes = {"bless", "fireball", "shield"};
+        std::vector<grpc::StatusCode> statuses(indexes.size());
+        std::vector<std::thread> callers;
+        // The first miss occupies the worker, the second waits, the third finds the queue full
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            callers.emplace_back([&, i]() { statuses[i] = harness.FetchItem(indexes[i]); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        for (auto& caller : callers) {
+            caller.join();
+        }
+        CHECK_EQ(statuses[0], grpc::StatusCode::OK);
+        CHECK_EQ(statuses[1], grpc::StatusCode::OK);
+        CHECK_EQ(statuses[2], grpc::StatusCode::RESOURCE_EXHAUSTED);
+        CHECK_EQ(harness.cached->GetRejectedMisses(), size_t{1});
+        // A rejected miss never reached the service
+        CHECK_EQ(harness.counts->For("/spells/shield"), size_t{0});
+
+        // Once the queue drains, misses are accepted again
+        CHECK_EQ(harness.FetchItem("shield"), grpc::StatusCode::OK);
+    }
+}
+
+int main() {
+    Run("RepeatedRequestsAreAnsweredFromTheCache", RepeatedRequestsAreAnsweredFromTheCache);
+    Run("FullMissQueueIsResourceExhausted", FullMissQueueIsResourceExhausted);
+    return Finish();
+}
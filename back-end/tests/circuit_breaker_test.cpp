@@ -0,0 +1,234 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "circuit_breaker.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    using State = CircuitBreaker::State;
+
+    constexpr auto kOpenDuration = std::chrono::milliseconds(50);
+
+    void WaitOutOpenWindow() {
+        std::this_thread::sleep_for(kOpenDuration + std::chrono::milliseconds(10));
+    }
+
+    // The exception GetList threw, or null when it returned
+    template <typename Fn>
+    std::exception_ptr Capture(Fn&& fn) {
+        try {
+            fn();
+        } catch (...) {
+            return std::current_exception();
+        }
+        return nullptr;
+    }
+
+    template <typename E>
+    bool Is(std::exception_ptr error) {
+        try {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        } catch (const E&) {
+            return true;
+        } catch (...) {
+        }
+        return false;
+    }
+
+    // Retries back off for a millisecond and an open breaker probes after kOpenDuration
+    std::shared_ptr<ApiClient> MakeClient(std::shared_ptr<RequestCounts> counts, const FakeTransportOptions& fake,
+                                          ApiClientOptions options = ApiClientOptions()) {
+        options.retry_base_delay_ms = 1;
+        options.retry_max_delay_ms = 1;
+        options.breaker_open_ms = kOpenDuration.count();
+        return std::make_shared<ApiClient>(kFakeBaseUrl, options, std::make_unique<CountingTransport>(fake, counts));
+    }
+
+    void OpensAfterThresholdConsecutiveFailures() {
+        CircuitBreaker breaker(3, kOpenDuration);
+        breaker.RecordFailure();
+        breaker.RecordFailure();
+        // A success in between resets the run
+        breaker.RecordSuccess();
+        breaker.RecordFailure();
+        breaker.RecordFailure();
+        CHECK(breaker.GetState() == State::Closed);
+        CHECK(breaker.AllowRequest());
+
+        breaker.RecordFailure();
+        CHECK(breaker.GetState() == State::Open);
+        CHECK_EQ(breaker.GetTripCount(), size_t{1});
+        CHECK(!breaker.AllowRequest());
+        CHECK(!breaker.AllowRequest());
+        CHECK_EQ(breaker.GetRejectedCount(), size_t{2});
+    }
+
+    void HalfOpenLetsOneProbeThroughAndSuccessCloses() {
+        CircuitBreaker breaker(1, kOpenDuration);
+        breaker.RecordFailure();
+        CHECK(breaker.GetState() == State::Open);
+
+        WaitOutOpenWindow();
+        CHECK(breaker.AllowRequest());
+        CHECK(breaker.GetState() == State::HalfOpen);
+        // Only the probe goes out while its outcome is pending
+        CHECK(!breaker.AllowRequest());
+
+        breaker.RecordSuccess();
+        CHECK(breaker.GetState() == State::Closed);
+        CHECK(breaker.AllowRequest());
+        CHECK_EQ(breaker.GetTripCount(), size_t{1});
+    }
+
+    void FailedProbeReopens() {
+        CircuitBreaker breaker(3, kOpenDuration);
+        for (int i = 0; i < 3; ++i) {
+            breaker.RecordFailure();
+        }
+        WaitOutOpenWindow();
+        CHECK(breaker.AllowRequest());
+
+        // One failure is enough in half-open, whatever the threshold
+        breaker.RecordFailure();
+        CHECK(breaker.GetState() == State::Open);
+        CHECK_EQ(breaker.GetTripCount(), size_t{2});
+        CHECK(!breaker.AllowRequest());
+    }
+
+    void UnreportedProbeLetsAnotherThroughNextWindow() {
+        CircuitBreaker breaker(1, kOpenDuration);
+        breaker.RecordFailure();
+        WaitOutOpenWindow();
+        CHECK(breaker.AllowRequest());
+        CHECK(!breaker.AllowRequest());
+
+        WaitOutOpenWindow();
+        CHECK(breaker.AllowRequest());
+        CHECK(breaker.GetState() == State::HalfOpen);
+    }
+
+    void ServerErrorsAreRetriedAndCounted() {
+        TempDir data("breaker-data");
+        WriteDataDir(data.Path(), {{"spells", {"fireball"}}});
+        auto counts = std::make_shared<RequestCounts>();
+        FakeTransportOptions fake = FakeOptions(data.Path(), kFakeBaseUrl, 1.0);
+        fake.error_rate = 1.0;
+        ApiClientOptions options;
+        options.breaker_failure_threshold = 100;
+        auto client = MakeClient(counts, fake, options);
+
+        auto error = Capture([&]() { client->GetList("spells"); });
+        CHECK(Is<UpstreamError>(error));
+        CHECK_EQ(counts->Total(), size_t{3});
+
+        // The async path retries the same way
+        error = Capture([&]() { client->GetListAsync("spells").get(); });
+        CHECK(Is<UpstreamError>(error));
+        CHECK_EQ(counts->Total(), size_t{6});
+        CHECK(client->GetCircuitBreaker("spells")->GetState() == State::Closed);
+    }
+
+    void OpenBreakerFailsFastUntilProbe() {
+        TempDir data("breaker-data");
+        WriteDataDir(data.Path(), {{"spells", {"fireball"}}});
+        auto counts = std::make_shared<RequestCounts>();
+        FakeTransportOptions fake = FakeOptions(data.Path(), kFakeBaseUrl, 1.0);
+        fake.error_rate = 1.0;
+        ApiClientOptions options;
+        options.max_attempts = 1;
+        options.breaker_failure_threshold = 2;
+        auto client = MakeClient(counts, fake, options);
+
+        Capture([&]() { client->GetList("spells"); });
+        Capture([&]() { client->GetList("spells"); });
+        const CircuitBreaker* breaker = client->GetCircuitBreaker("spells");
+        CHECK(breaker->GetState() == State::Open);
+
+        CHECK(Is<CircuitOpenError>(Capture([&]() { client->GetList("spells"); })));
+        CHECK(Is<CircuitOpenError>(Capture([&]() { client->GetListAsync("spells").get(); })));
+        CHECK_EQ(counts->Total(), size_t{2});
+        // Other endpoints have their own breaker
+        CHECK(client->GetCircuitBreaker("monsters")->GetState() == State::Closed);
+
+        // The probe still fails and re-opens the circuit
+        WaitOutOpenWindow();
+        CHECK(!Is<CircuitOpenError>(Capture([&]() { client->GetList("spells"); })));
+        CHECK_EQ(counts->Total(), size_t{3});
+        CHECK(breaker->GetState() == State::Open);
+        CHECK_EQ(breaker->GetTripCount(), size_t{2});
+    }
+
+    void NotFoundIsNeitherRetriedNorCounted() {
+        TempDir data("breaker-data");
+        WriteDataDir(data.Path(), {{"spells", {"fireball"}}});
+        auto counts = std::make_shared<RequestCounts>();
+        ApiClientOptions options;
+        options.breaker_failure_threshold = 1;
+        auto client = MakeClient(counts, FakeOptions(data.Path(), kFakeBaseUrl, 1.0), options);
+
+        for (int i = 0; i < 5; ++i) {
+            auto error = Capture([&]() { client->GetItem("spells", "missing"); });
+            CHECK(Is<UpstreamError>(error));
+            CHECK(!Is<CircuitOpenError>(error));
+        }
+        CHECK_EQ(counts->For("/spells/missing"), size_t{5});
+        const CircuitBreaker* breaker = client->GetCircuitBreaker("spells");
+        CHECK(breaker->GetState() == State::Closed);
+        CHECK_EQ(breaker->GetTripCount(), size_t{0});
+    }
+
+    void AbortedRequestsAreNeitherRetriedNorCounted() {
+        TempDir data("breaker-data");
+        WriteDataDir(data.Path(), {{"spells", {"fireball"}}});
+        auto counts = std::make_shared<RequestCounts>();
+        ApiClientOptions options;
+        options.breaker_failure_threshold = 1;
+        auto client = MakeClient(counts, FakeOptions(data.Path(), kFakeBaseUrl, 200.0), options);
+
+        // The fake's reply would arrive after the deadline, so the transfer times out
+        RequestControl deadline;
+        deadline.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+        CHECK(Is<DeadlineExceededError>(Capture([&]() { client->GetItem("spells", "fireball", deadline); })));
+        CHECK_EQ(counts->Total(), size_t{1});
+
+        // Cancelled while the transfer is running
+        auto cancelled = std::make_shared<std::atomic<bool>>(false);
+        RequestControl cancel;
+        cancel.is_cancelled = [cancelled]() { return cancelled->load(); };
+        std::thread canceller([cancelled]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            *cancelled = true;
+        });
+        CHECK(Is<RequestCancelledError>(Capture([&]() { client->GetItem("spells", "fireball", cancel); })));
+        canceller.join();
+        CHECK_EQ(counts->Total(), size_t{2});
+
+        // Already cancelled: nothing goes upstream at all
+        CHECK(Is<RequestCancelledError>(Capture([&]() { client->GetList("spells", cancel); })));
+        CHECK_EQ(counts->Total(), size_t{2});
+
+        const CircuitBreaker* breaker = client->GetCircuitBreaker("spells");
+        CHECK(breaker->GetState() == State::Closed);
+        CHECK_EQ(breaker->GetTripCount(), size_t{0});
+    }
+}
+
+int main() {
+    Run("OpensAfterThresholdConsecutiveFailures", OpensAfterThresholdConsecutiveFailures);
+    Run("HalfOpenLetsOneProbeThroughAndSuccessCloses", HalfOpenLetsOneProbeThroughAndSuccessCloses);
+    Run("FailedProbeReopens", FailedProbeReopens);
+    Run("UnreportedProbeLetsAnotherThroughNextWindow", UnreportedProbeLetsAnotherThroughNextWindow);
+    Run("ServerErrorsAreRetriedAndCounted", ServerErrorsAreRetriedAndCounted);
+    Run("OpenBreakerFailsFastUntilProbe", OpenBreakerFailsFastUntilProbe);
+    Run("NotFoundIsNeitherRetriedNorCounted", NotFoundIsNeitherRetriedNorCounted);
+    Run("AbortedRequestsAreNeitherRetriedNorCounted", AbortedRequestsAreNeitherRetriedNorCounted);
+    return Finish();
+}
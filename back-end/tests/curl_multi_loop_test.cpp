@@ -0,0 +1,48 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "curl_multi_loop.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    void PendingTimersRunAtShutdown() {
+        std::atomic<int> ran{0};
+        {
+            CurlMultiLoop loop;
+            loop.Schedule(CurlMultiLoop::Clock::now() + std::chrono::hours(1), [&]() { ran++; });
+        }
+        CHECK_EQ(ran.load(), 1);
+    }
+
+    void TimerSubmitsFailAtShutdown() {
+        CURL* handle = curl_easy_init();
+        std::atomic<int> aborted{0};
+        {
+            auto loop = std::make_unique<CurlMultiLoop>();
+            CurlMultiLoop* raw = loop.get();
+            // Like a retry backoff: the timer submits the next attempt
+            raw->Schedule(CurlMultiLoop::Clock::now() + std::chrono::hours(1), [&, raw]() {
+                raw->Submit(handle, [&](CURL*, CURLcode result) {
+                    if (result == CURLE_ABORTED_BY_CALLBACK) {
+                        aborted++;
+                    }
+                });
+            });
+            loop.reset();
+        }
+        CHECK_EQ(aborted.load(), 1);
+        curl_easy_cleanup(handle);
+    }
+}
+
+int main() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    Run("PendingTimersRunAtShutdown", PendingTimersRunAtShutdown);
+    Run("TimerSubmitsFailAtShutdown", TimerSubmitsFailAtShutdown);
+    curl_global_cleanup();
+    return Finish();
+}
@@ -0,0 +1,134 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dnd5e_service.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    struct Fixture {
+        TempDir data{"cursor-data"};
+        std::shared_ptr<RequestCounts> counts = std::make_shared<RequestCounts>();
+        std::unique_ptr<Dnd5eServiceImpl> service;
+
+        explicit Fixture(const std::vector<std::string>& spells) {
+            WriteDataDir(data.Path(), {{"spells", spells}, {"monsters", {"goblin"}}});
+            ServiceOptions options;
+            options.refresh_threads = 0;
+            service = std::make_unique<Dnd5eServiceImpl>(MakeFakeClient(data.Path(), counts, 1.0), options);
+        }
+
+        grpc::Status Page(const std::string& cursor, int page_size, GetListResponse& response,
+                          const std::string& endpoint = "spells") {
+            GetListRequest request;
+            request.set_endpoint(endpoint);
+            request.set_page_size(page_size);
+            request.set_cursor(cursor);
+            response.Clear();
+            return service->GetList(nullptr, &request, &response);
+        }
+    };
+
+    std::vector<std::string> Indexes(const GetListResponse& response) {
+        std::vector<std::string> indexes;
+        for (const auto& item : response.items()) {
+            indexes.push_back(item.index());
+        }
+        return indexes;
+    }
+
+    const std::vector<std::string> kSpells = {"acid-arrow", "bless", "cure-wounds", "fireball", "shield"};
+
+    void CursorsWalkTheWholeList() {
+        Fixture fixture(kSpells);
+        GetListResponse response;
+        std::vector<std::string> seen;
+        std::string cursor;
+        int pages = 0;
+        do {
+            CHECK(fixture.Page(cursor, 2, response).ok());
+            auto indexes = Indexes(response);
+            seen.insert(seen.end(), indexes.begin(), indexes.end());
+            CHECK_EQ(response.has_more(), !response.next_cursor().empty());
+            CHECK_EQ(response.total_count(), 5);
+            cursor = response.next_cursor();
+            pages++;
+        } while (!cursor.empty() && pages < 10);
+        CHECK_EQ(pages, 3);
+        CHECK(seen == kSpells);
+    }
+
+    void MalformedCursorsAreInvalidArgument() {
+        Fixture fixture(kSpells);
+        GetListResponse response;
+        CHECK(fixture.Page("", 2, response).ok());
+        std::string cursor = response.next_cursor();
+        CHECK(!cursor.empty());
+
+        std::string flipped = cursor;
+        flipped[flipped.size() / 2] = flipped[flipped.size() / 2] == 'A' ? 'B' : 'A';
+        std::vector<std::string> bad = {
+            "not a cursor!",
+            "%%%%",
+            std::string("AB\0CD", 5),
+            flipped,
+            cursor.substr(0, cursor.size() - 2),
+        };
+        for (const auto& garbage : bad) {
+            auto status = fixture.Page(garbage, 2, response);
+            CHECK_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+            CHECK_EQ(response.items_size(), 0);
+        }
+
+        // A cursor from one endpoint does not page another
+        CHECK(fixture.Page("", 0, response, "monsters").ok());
+        auto status = fixture.Page(cursor, 2, response, "monsters");
+        CHECK_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+    }
+
+    void CursorKeepsItsPlaceAcrossARefresh() {
+        std::string cursor;
+        {
+            Fixture before(kSpells);
+            GetListResponse response;
+            CHECK(before.Page("", 2, response).ok());
+            cursor = response.next_cursor();
+        }
+
+        // Items inserted ahead of the cursor do not shift the next page
+        Fixture after({"aid", "acid-arrow", "alarm", "bless", "cure-wounds", "fireball", "shield"});
+        GetListResponse response;
+        CHECK(after.Page(cursor, 2, response).ok());
+        CHECK(Indexes(response) == std::vector<std::string>({"cure-wounds", "fireball"}));
+        CHECK_EQ(response.page(), 2);
+        CHECK_EQ(response.total_count(), 7);
+    }
+
+    void CursorOutlivingItsItemIsInvalidArgument() {
+        std::string cursor;
+        {
+            Fixture before(kSpells);
+            GetListResponse response;
+            CHECK(before.Page("", 2, response).ok());
+            cursor = response.next_cursor();
+        }
+
+        // "bless", the last item the cursor served, left the list
+        Fixture after({"acid-arrow", "cure-wounds", "fireball", "shield"});
+        GetListResponse response;
+        auto status = after.Page(cursor, 2, response);
+        CHECK_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+        CHECK(status.error_message().find("bless") != std::string::npos);
+    }
+}
+
+int main() {
+    Run("CursorsWalkTheWholeList", CursorsWalkTheWholeList);
+    Run("MalformedCursorsAreInvalidArgument", MalformedCursorsAreInvalidArgument);
+    Run("CursorKeepsItsPlaceAcrossARefresh", CursorKeepsItsPlaceAcrossARefresh);
+    Run("CursorOutlivingItsItemIsInvalidArgument", CursorOutlivingItsItemIsInvalidArgument);
+    return Finish();
+}
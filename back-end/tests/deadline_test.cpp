@@ -0,0 +1,126 @@
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <grpcpp/grpcpp.h>
+
+#include "dnd5e_service.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    // Hands calls to the service under test and keeps the status its handler
+    // returned; the client only ever sees its own deadline or cancellation
+    class RecordingService final : public Dnd5eService::Service {
+    public:
+        explicit RecordingService(Dnd5eServiceImpl& service) : service_(service) {}
+
+        grpc::Status GetItem(grpc::ServerContext* context, const GetItemRequest* request,
+                             GetItemResponse* response) override {
+            auto status = service_.GetItem(context, request, response);
+            handled_.set_value(status.error_code());
+            return status;
+        }
+
+        grpc::StatusCode WaitForHandler() {
+            auto future = handled_.get_future();
+            if (future.wait_for(std::chrono::seconds(5)) != std::future_status::ready) {
+                return grpc::StatusCode::UNKNOWN;
+            }
+            return future.get();
+        }
+
+    private:
+        Dnd5eServiceImpl& service_;
+        std::promise<grpc::StatusCode> handled_;
+    };
+
+    // The fake answers long after the client stops waiting
+    constexpr double kSlowUpstreamMs = 500.0;
+
+    struct Harness {
+        TempDir data{"deadline-data"};
+        std::shared_ptr<RequestCounts> counts = std::make_shared<RequestCounts>();
+        std::unique_ptr<Dnd5eServiceImpl> service;
+        std::unique_ptr<RecordingService> recording;
+        std::unique_ptr<grpc::Server> server;
+        std::unique_ptr<Dnd5eService::Stub> stub;
+
+        Harness() {
+            WriteDataDir(data.Path(), {{"spells", {"fireball"}}});
+            ServiceOptions options;
+            options.refresh_threads = 0;
+            service = std::make_unique<Dnd5eServiceImpl>(MakeFakeClient(data.Path(), counts, kSlowUpstreamMs), options);
+            recording = std::make_unique<RecordingService>(*service);
+            grpc::ServerBuilder builder;
+            builder.RegisterService(recording.get());
+            server = builder.BuildAndStart();
+            stub = Dnd5eService::NewStub(server->InProcessChannel(grpc::ChannelArguments()));
+        }
+
+        ~Harness() {
+            server->Shutdown();
+        }
+    };
+
+    GetItemRequest Fireball() {
+        GetItemRequest request;
+        request.set_endpoint("spells");
+        request.set_index("fireball");
+        return request;
+    }
+
+    void ExpiredDeadlineIsDeadlineExceeded() {
+        Harness harness;
+        grpc::ClientContext context;
+        context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(50));
+        GetItemResponse response;
+        auto started = std::chrono::steady_clock::now();
+        auto status = harness.stub->GetItem(&context, Fireball(), &response);
+        CHECK_EQ(status.error_code(), grpc::StatusCode::DEADLINE_EXCEEDED);
+
+        CHECK_EQ(harness.recording->WaitForHandler(), grpc::StatusCode::DEADLINE_EXCEEDED);
+        // The upstream fetch was abandoned rather than waited out, and not retried
+        CHECK(std::chrono::steady_clock::now() - started < std::chrono::milliseconds(400));
+        CHECK_EQ(harness.counts->Total(), size_t{1});
+    }
+
+    void ClientCancellationIsCancelled() {
+        Harness harness;
+        grpc::ClientContext context;
+        std::thread canceller([&context]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            context.TryCancel();
+        });
+        GetItemResponse response;
+        auto started = std::chrono::steady_clock::now();
+        auto status = harness.stub->GetItem(&context, Fireball(), &response);
+        canceller.join();
+        CHECK_EQ(status.error_code(), grpc::StatusCode::CANCELLED);
+
+        CHECK_EQ(harness.recording->WaitForHandler(), grpc::StatusCode::CANCELLED);
+        CHECK(std::chrono::steady_clock::now() - started < std::chrono::milliseconds(400));
+        CHECK_EQ(harness.counts->Total(), size_t{1});
+    }
+
+    void GenerousDeadlineStillSucceeds() {
+        Harness harness;
+        grpc::ClientContext context;
+        context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(5));
+        GetItemResponse response;
+        auto status = harness.stub->GetItem(&context, Fireball(), &response);
+        CHECK_EQ(status.error_code(), grpc::StatusCode::OK);
+        CHECK_EQ(harness.recording->WaitForHandler(), grpc::StatusCode::OK);
+        CHECK_EQ(response.item().name(), std::string("Name of fireball"));
+    }
+}
+
+int main() {
+    Run("ExpiredDeadlineIsDeadlineExceeded", ExpiredDeadlineIsDeadlineExceeded);
+    Run("ClientCancellationIsCancelled", ClientCancellationIsCancelled);
+    Run("GenerousDeadlineStillSucceeds", GenerousDeadlineStillSucceeds);
+    return Finish();
+}
@@ -0,0 +1,121 @@
+#include <memory>
+#include <string>
+
+#include "item_cache.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    // One shard, so every entry competes with every other. Its 1% window is
+    // smaller than any entry, so each Put goes straight to admission
+    constexpr size_t kCapacity = 10000;
+    constexpr size_t kMainCapacity = kCapacity - kCapacity / 100;
+
+    // Charge is the body plus the key twice plus a fixed overhead; keys are
+    // kept to one letter so bodies set the charge
+    ItemCache::Value MakeValue(size_t body_size) {
+        auto item = std::make_shared<ApiClient::ItemResponse>();
+        item->raw_json = std::string(body_size, 'x');
+        return item;
+    }
+
+    const auto kFresh = ItemCache::Clock::now() + std::chrono::hours(1);
+
+    void Read(ItemCache& cache, const std::string& key, int times) {
+        for (int i = 0; i < times; ++i) {
+            cache.Get(key);
+        }
+    }
+
+    void OneHitCandidatesCannotDisplaceAHotEntry() {
+        ItemCache cache(kCapacity, 1, CachePolicy::TinyLfu);
+        cache.Put("h", MakeValue(6000), kFresh);
+        Read(cache, "h", 10);
+
+        // A scan of items nobody asked for twice, each needing h's space
+        for (int i = 0; i < 50; ++i) {
+            cache.Put("s" + std::to_string(i), MakeValue(5000), kFresh);
+        }
+        auto stats = cache.GetStats();
+        CHECK_EQ(stats.rejections, size_t{50});
+        CHECK_EQ(stats.evictions, size_t{0});
+        CHECK(cache.Get("h").value != nullptr);
+        CHECK(cache.Get("s0").value == nullptr);
+    }
+
+    void RejectionEvictsNothing() {
+        ItemCache cache(kCapacity, 1, CachePolicy::TinyLfu);
+        // a is read a little, then stays in probation; b is hot and protected
+        Read(cache, "a", 2);
+        cache.Put("a", MakeValue(4000), kFresh);
+        cache.Put("b", MakeValue(4000), kFresh);
+        Read(cache, "b", 10);
+
+        // c beats a but would also need b's space, and b wins
+        Read(cache, "c", 3);
+        cache.Put("c", MakeValue(6000), kFresh);
+
+        auto stats = cache.GetStats();
+        CHECK_EQ(stats.rejections, size_t{1});
+        CHECK_EQ(stats.evictions, size_t{0});
+        CHECK_EQ(stats.entries, size_t{2});
+        CHECK(cache.Get("a").value != nullptr);
+        CHECK(cache.Get("b").value != nullptr);
+    }
+
+    void FrequentCandidateEvictsEveryVictimItNeeds() {
+        ItemCache cache(kCapacity, 1, CachePolicy::TinyLfu);
+        Read(cache, "a", 1);
+        cache.Put("a", MakeValue(4000), kFresh);
+        Read(cache, "b", 1);
+        cache.Put("b", MakeValue(4000), kFresh);
+
+        Read(cache, "c", 5);
+        cache.Put("c", MakeValue(6000), kFresh);
+
+        auto stats = cache.GetStats();
+        CHECK_EQ(stats.rejections, size_t{0});
+        CHECK_EQ(stats.evictions, size_t{2});
+        CHECK(stats.bytes <= kMainCapacity);
+        CHECK(cache.Get("c").value != nullptr);
+        CHECK(cache.Get("a").value == nullptr);
+        CHECK(cache.Get("b").value == nullptr);
+    }
+
+    void PeekChangesNothing() {
+        ItemCache cache(kCapacity, 1, CachePolicy::TinyLfu);
+        Read(cache, "a", 1);
+        cache.Put("a", MakeValue(4000), kFresh);
+        Read(cache, "b", 1);
+        cache.Put("b", MakeValue(4000), kFresh);
+        cache.Put("old", MakeValue(10), ItemCache::Clock::now());
+        auto before = cache.GetStats();
+
+        for (int i = 0; i < 5; ++i) {
+            CHECK(cache.Peek("a").value != nullptr);
+            CHECK(cache.Peek("c").value == nullptr);
+        }
+        CHECK(!cache.Peek("a").stale);
+        CHECK(cache.Peek("old").stale);
+        auto stats = cache.GetStats();
+        CHECK_EQ(stats.fresh_hits, before.fresh_hits);
+        CHECK_EQ(stats.stale_hits, before.stale_hits);
+        CHECK_EQ(stats.misses, before.misses);
+
+        // Peeks earn c no frequency, so unlike five reads they cannot displace a and b
+        cache.Put("c", MakeValue(6000), kFresh);
+        CHECK_EQ(cache.GetStats().rejections, size_t{1});
+        CHECK(cache.Peek("a").value != nullptr);
+        CHECK(cache.Peek("b").value != nullptr);
+    }
+}
+
+int main() {
+    Run("OneHitCandidatesCannotDisplaceAHotEntry", OneHitCandidatesCannotDisplaceAHotEntry);
+    Run("RejectionEvictsNothing", RejectionEvictsNothing);
+    Run("FrequentCandidateEvictsEveryVictimItNeeds", FrequentCandidateEvictsEveryVictimItNeeds);
+    Run("PeekChangesNothing", PeekChangesNothing);
+    return Finish();
+}
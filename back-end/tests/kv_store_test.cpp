@@ -0,0 +1,177 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "kv_store_cache.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    std::shared_ptr<const ApiClient::ItemResponse> MakeItem(const std::string& index, const std::string& body) {
+        auto item = std::make_shared<ApiClient::ItemResponse>();
+        item->name = "Name of " + index;
+        item->url = "/api/2014/spells/" + index;
+        item->raw_json = body;
+        item->validators.etag = "\"" + index + "\"";
+        return item;
+    }
+
+    std::string Body(L2Cache& store, const std::string& index) {
+        auto stored = store.GetItem("spells", index);
+        return stored ? stored->item.raw_json : "<missing>";
+    }
+
+    std::string ReadFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    KvStoreOptions StoreOptions(const TempDir& dir) {
+        KvStoreOptions options;
+        options.path = dir.File("cache.log");
+        options.max_bytes = size_t{1} << 20;
+        options.flush_interval_ms = 1;
+        return options;
+    }
+
+    void TornTailIsCutOffAtOpen() {
+        TempDir dir("kv-store");
+        auto options = StoreOptions(dir);
+        {
+            // Closing drains the write queue, in order
+            auto store = OpenKvStoreCache(options);
+            store->PutItem("spells", "acid-arrow", MakeItem("acid-arrow", "{\"a\":1}"));
+            store->PutItem("spells", "bless", MakeItem("bless", "{\"b\":2}"));
+            store->PutItem("spells", "cure-wounds", MakeItem("cure-wounds", "{\"c\":3}"));
+        }
+        auto full_size = std::filesystem::file_size(options.path);
+        // A crash partway through appending the last record
+        std::filesystem::resize_file(options.path, full_size - 5);
+
+        {
+            auto store = OpenKvStoreCache(options);
+            CHECK_EQ(Body(*store, "acid-arrow"), std::string("{\"a\":1}"));
+            CHECK_EQ(Body(*store, "bless"), std::string("{\"b\":2}"));
+            CHECK_EQ(Body(*store, "cure-wounds"), std::string("<missing>"));
+            CHECK(std::filesystem::file_size(options.path) < full_size - 5);
+
+            // Appends after the cut land on a clean record boundary
+            store->PutItem("spells", "cure-wounds", MakeItem("cure-wounds", "{\"c\":4}"));
+        }
+
+        auto store = OpenKvStoreCache(options);
+        CHECK_EQ(Body(*store, "bless"), std::string("{\"b\":2}"));
+        CHECK_EQ(Body(*store, "cure-wounds"), std::string("{\"c\":4}"));
+    }
+
+    void CorruptRecordDropsItAndEverythingAfter() {
+        TempDir dir("kv-store");
+        auto options = StoreOptions(dir);
+        {
+            auto store = OpenKvStoreCache(options);
+            store->PutItem("spells", "acid-arrow", MakeItem("acid-arrow", "{\"a\":1}"));
+            store->PutItem("spells", "bless", MakeItem("bless", "{\"marker\":2}"));
+            store->PutItem("spells", "cure-wounds", MakeItem("cure-wounds", "{\"c\":3}"));
+        }
+
+        // Flip one byte inside the middle record's value
+        std::string contents = ReadFile(options.path);
+        auto position = contents.find("marker");
+        CHECK(position != std::string::npos);
+        {
+            std::fstream file(options.path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(static_cast<std::streamoff>(position));
+            file.put('M');
+        }
+
+        auto store = OpenKvStoreCache(options);
+        CHECK_EQ(Body(*store, "acid-arrow"), std::string("{\"a\":1}"));
+        CHECK_EQ(Body(*store, "bless"), std::string("<missing>"));
+        CHECK_EQ(Body(*store, "cure-wounds"), std::string("<missing>"));
+    }
+
+    void CompactionKeepsTheLatestValuePerKey() {
+        TempDir dir("kv-store");
+        auto options = StoreOptions(dir);
+        options.max_bytes = 4096;
+        // One record per append, so every rewrite is a separate flush
+        options.batch_size = 1;
+        const std::string padding(150, 'x');
+        constexpr int kRounds = 60;
+        {
+            auto store = OpenKvStoreCache(options);
+            for (int round = 0; round < kRounds; ++round) {
+                std::string tag = "round-" + std::to_string(round) + "-";
+                store->PutItem("spells", "acid-arrow", MakeItem("acid-arrow", tag + "a" + padding));
+                store->PutItem("spells", "bless", MakeItem("bless", tag + "b" + padding));
+                if (round == 0) {
+                    store->PutItem("spells", "shield", MakeItem("shield", "written-once"));
+                }
+            }
+            auto stats = store->GetStats();
+            CHECK_EQ(stats.writes_dropped, size_t{0});
+        }
+
+        // Far more was written than fits, so the log must have been compacted
+        auto size = std::filesystem::file_size(options.path);
+        CHECK(size <= options.max_bytes);
+        std::string contents = ReadFile(options.path);
+        CHECK(contents.find("round-0-") == std::string::npos);
+
+        std::string last = "round-" + std::to_string(kRounds - 1) + "-";
+        auto store = OpenKvStoreCache(options);
+        CHECK_EQ(Body(*store, "acid-arrow"), last + "a" + padding);
+        CHECK_EQ(Body(*store, "bless"), last + "b" + padding);
+        CHECK_EQ(Body(*store, "shield"), std::string("written-once"));
+    }
+
+    // Waits until the writer has stored or dropped everything queued so far
+    L2CacheStats Drain(L2Cache& store) {
+        for (;;) {
+            auto stats = store.GetStats();
+            if (stats.writes_stored + stats.writes_dropped >= stats.writes_queued) {
+                return stats;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void FullStoreDoesNotCompactForEveryBatch() {
+        TempDir dir("kv-store");
+        auto options = StoreOptions(dir);
+        options.max_bytes = 4096;
+        options.batch_size = 1;
+        const std::string padding(100, 'x');
+        auto store = OpenKvStoreCache(options);
+
+        // Distinct keys until the log is full of live records
+        for (int i = 0; Drain(*store).writes_dropped == 0; ++i) {
+            std::string index = "spell-" + std::to_string(i);
+            store->PutItem("spells", index, MakeItem(index, padding));
+        }
+        CHECK_EQ(store->GetStats().compactions, size_t{0});
+
+        // Each rewrite leaves one dead record: far too little to be worth a compaction each time
+        for (int round = 0; round < 50; ++round) {
+            store->PutItem("spells", "spell-0", MakeItem("spell-0", std::to_string(round) + padding));
+            Drain(*store);
+        }
+        auto stats = store->GetStats();
+        CHECK(stats.compactions <= size_t{1});
+        CHECK(stats.writes_dropped > size_t{1});
+        CHECK(std::filesystem::file_size(options.path) <= options.max_bytes);
+    }
+}
+
+int main() {
+    Run("TornTailIsCutOffAtOpen", TornTailIsCutOffAtOpen);
+    Run("CorruptRecordDropsItAndEverythingAfter", CorruptRecordDropsItAndEverythingAfter);
+    Run("CompactionKeepsTheLatestValuePerKey", CompactionKeepsTheLatestValuePerKey);
+    Run("FullStoreDoesNotCompactForEveryBatch", FullStoreDoesNotCompactForEveryBatch);
+    return Finish();
+}
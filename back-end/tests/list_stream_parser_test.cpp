@@ -0,0 +1,192 @@
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "list_stream_parser.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    ApiClient::ApiResponse ParseInChunks(const std::string& body, size_t chunk_size) {
+        ListStreamParser parser;
+        for (size_t offset = 0; offset < body.size(); offset += chunk_size) {
+            parser.Feed(body.data() + offset, std::min(chunk_size, body.size() - offset));
+        }
+        return parser.Finish();
+    }
+
+    // Empty when the body parses; the error message otherwise
+    std::string ParseError(const std::string& body, size_t chunk_size = 1) {
+        try {
+            ParseInChunks(body, chunk_size);
+        } catch (const std::runtime_error& e) {
+            return e.what();
+        }
+        return "";
+    }
+
+    std::string Describe(const ApiClient::ApiResponse& response) {
+        std::string out = std::to_string(response.count) + ":";
+        for (const auto& item : response.results) {
+            out += "[" + item.index + "|" + item.name + "|" + item.url + "]";
+        }
+        return out;
+    }
+
+    // Every split of the body, down to one byte at a time, parses the same
+    void CheckEveryChunking(const std::string& body, const std::string& expected) {
+        for (size_t chunk_size = 1; chunk_size <= body.size(); ++chunk_size) {
+            std::string actual = Describe(ParseInChunks(body, chunk_size));
+            if (actual != expected) {
+                CHECK_EQ(actual, expected);
+                std::cerr << "  with chunk size " << chunk_size << std::endl;
+                return;
+            }
+        }
+    }
+
+    void ChunkBoundariesInsideStringsAndEscapes() {
+        std::string body =
+            "{\"count\": 2, \"results\": ["
+            "{\"index\": \"tashas-hideous-laughter\", \"name\": \"Tasha\\u2019s \\\"Hideous\\\" Laughter\","
+            " \"url\": \"\\/api\\/2014\\/spells\\/tashas-hideous-laughter\"},"
+            "{\"index\": \"dragon\", \"name\": \"Tab\\there\\\\\\n\\ud83d\\udc09\", \"url\": \"/api/2014/monsters/dragon\"}"
+            "]}";
+        std::string expected =
+            "2:[tashas-hideous-laughter|Tasha\xE2\x80\x99s \"Hideous\" Laughter|/api/2014/spells/tashas-hideous-laughter]"
+            "[dragon|Tab\there\\\n\xF0\x9F\x90\x89|/api/2014/monsters/dragon]";
+        CheckEveryChunking(body, expected);
+    }
+
+    void LoneSurrogatesBecomeReplacementCharacters() {
+        std::string body = "{\"results\": [{\"index\": \"a\", \"name\": \"x\\ud83dy\\udc09z\"}], \"count\": 1}";
+        CheckEveryChunking(body, "1:[a|x\xEF\xBF\xBDy\xEF\xBF\xBDz|]");
+    }
+
+    void ResultsBeforeOrAfterCount() {
+        std::string item = "{\"index\": \"bless\", \"name\": \"Bless\", \"url\": \"/api/2014/spells/bless\"}";
+        std::string expected = "1:[bless|Bless|/api/2014/spells/bless]";
+        CheckEveryChunking("{\"count\": 1, \"results\": [" + item + "]}", expected);
+        CheckEveryChunking("{\"results\": [" + item + "], \"count\": 1}", expected);
+        // No count at all leaves it zero
+        CheckEveryChunking("{\"results\": [" + item + "]}", "0:[bless|Bless|/api/2014/spells/bless]");
+    }
+
+    void UnknownFieldsAreSkipped() {
+        std::string body =
+            "{\"meta\": {\"results\": [{\"index\": \"decoy\"}], \"count\": 99}, \"count\": 1,"
+            " \"results\": [{\"level\": 3, \"tags\": [\"a\", {\"index\": \"nested\"}], \"index\": \"fly\","
+            " \"ritual\": false, \"extra\": null, \"name\": \"Fly\", \"range\": -1.5e2, \"url\": \"/fly\"}],"
+            " \"next\": null}";
+        CheckEveryChunking(body, "1:[fly|Fly|/fly]");
+        CheckEveryChunking("{\"count\": 0, \"results\": []}", "0:");
+    }
+
+    void MalformedBodiesAreRejected() {
+        std::vector<std::string> bad = {
+            "",
+            "[]",
+            "{\"count\" 1}",
+            "{\"count\": 1,}",
+            "{\"results\": [{\"index\": \"a\"},]}",
+            "{\"results\": [{\"index\": \"a\"}}",
+            "{\"results\": [{\"index\": \"a\\x\"}]}",
+            "{\"results\": [{\"index\": \"a\\u12G4\"}]}",
+            "{\"results\": [{\"index\": \"a\nb\"}]}",
+            "{\"count\": tru}",
+            "{\"count\": 1.5}",
+            "{\"count\": 1} {}",
+            "{\"count\": 1}]",
+        };
+        for (const auto& body : bad) {
+            std::string error = ParseError(body);
+            if (error.find("Failed to parse JSON response") == std::string::npos) {
+                std::cerr << "accepted: " << body << std::endl;
+                CHECK(false);
+            }
+        }
+    }
+
+    void TruncatedBodiesAreRejected() {
+        std::string body = "{\"count\": 1, \"results\": [{\"index\": \"a\\u00e9\", \"name\": \"A\", \"url\": \"/a\"}]}";
+        CHECK_EQ(ParseError(body), std::string());
+        for (size_t size = 0; size < body.size(); ++size) {
+            if (ParseError(body.substr(0, size), 3).empty()) {
+                std::cerr << "accepted a " << size << " byte prefix" << std::endl;
+                CHECK(false);
+            }
+        }
+    }
+
+    // A consumer that throws makes AppendBody return false, which the curl
+    // write callback turns into CURLE_WRITE_ERROR; the parse error is kept
+    void ConsumerErrorsAbortTheTransfer() {
+        auto parser = std::make_shared<ListStreamParser>();
+        UpstreamResponse response;
+        response.status = 200;
+        response.body_consumer = [parser](const char* data, size_t size) { parser->Feed(data, size); };
+
+        std::string good = "{\"count\": 1, \"results\": [";
+        CHECK(response.AppendBody(good.data(), good.size()));
+        CHECK(!response.body_error);
+        std::string bad = "{\"index\" \"a\"}";
+        CHECK(!response.AppendBody(bad.data(), bad.size()));
+        CHECK(response.body_error != nullptr);
+        try {
+            std::rethrow_exception(response.body_error);
+        } catch (const std::runtime_error& e) {
+            CHECK(std::string(e.what()).find("unexpected") != std::string::npos);
+        }
+        CHECK(response.body.empty());
+
+        // Error statuses keep the buffered path and never reach the parser
+        UpstreamResponse not_found;
+        not_found.status = 404;
+        not_found.body_consumer = response.body_consumer;
+        CHECK(not_found.AppendBody(bad.data(), bad.size()));
+        CHECK_EQ(not_found.body, bad);
+    }
+
+    void ClientSurfacesParseErrors() {
+        TempDir data("list-parser-data");
+        WriteDataDir(data.Path(), {{"spells", {"fireball"}}});
+        std::ofstream(std::filesystem::path(data.Path()) / "monsters.json") << "{\"count\": 1, \"results\": [{\"index\": ";
+        std::ofstream(std::filesystem::path(data.Path()) / "equipment.json") << "{\"count\": 1, \"results\": [}";
+
+        auto counts = std::make_shared<RequestCounts>();
+        FakeTransportOptions fake = FakeOptions(data.Path(), kFakeBaseUrl, 1.0);
+        fake.chunk_size = 7;
+        auto client = std::make_shared<ApiClient>(kFakeBaseUrl, ApiClientOptions(),
+                                                  std::make_unique<CountingTransport>(fake, counts));
+
+        CHECK_EQ(Describe(client->GetList("spells")), std::string("1:[fireball|Name of fireball|/api/2014/spells/fireball]"));
+        for (const std::string endpoint : {"monsters", "equipment"}) {
+            std::string error;
+            try {
+                client->GetList(endpoint);
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            CHECK(error.find("Failed to parse JSON response") != std::string::npos);
+            // A body upstream got wrong is not retried
+            CHECK_EQ(counts->For("/" + endpoint), size_t{1});
+        }
+    }
+}
+
+int main() {
+    Run("ChunkBoundariesInsideStringsAndEscapes", ChunkBoundariesInsideStringsAndEscapes);
+    Run("LoneSurrogatesBecomeReplacementCharacters", LoneSurrogatesBecomeReplacementCharacters);
+    Run("ResultsBeforeOrAfterCount", ResultsBeforeOrAfterCount);
+    Run("UnknownFieldsAreSkipped", UnknownFieldsAreSkipped);
+    Run("MalformedBodiesAreRejected", MalformedBodiesAreRejected);
+    Run("TruncatedBodiesAreRejected", TruncatedBodiesAreRejected);
+    Run("ConsumerErrorsAbortTheTransfer", ConsumerErrorsAbortTheTransfer);
+    Run("ClientSurfacesParseErrors", ClientSurfacesParseErrors);
+    return Finish();
+}
@@ -0,0 +1,116 @@
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "local_data_source.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    // <root>/data is the data tree; <root>/secret.json sits just outside it and
+    // <root>/data/spells/secret.json is the only legitimate way to reach a "secret"
+    struct Tree {
+        TempDir root{"local-data"};
+        std::string data_dir;
+        std::string secret;
+
+        Tree() {
+            data_dir = root.File("data");
+            WriteDataDir(data_dir, {{"spells", {"fireball"}}});
+            secret = root.File("secret");
+            std::ofstream(secret + ".json") << "{\"index\": \"secret\", \"name\": \"Secret\", \"url\": \"/secret\"}";
+        }
+    };
+
+    // Names that would resolve outside the data root if joined naively
+    std::vector<std::pair<std::string, std::string>> EscapingItems(const Tree& tree) {
+        return {
+            {"spells", "../../secret"},
+            {"spells", "../fireball"},
+            {"..", "secret"},
+            {"spells", tree.secret},
+            {tree.root.Path(), "secret"},
+            {"spells", "..\\..\\secret"},
+            {"spells", std::string("fireball\0/../../secret", 22)},
+            {"spells", ".hidden"},
+            {"spells", ""},
+        };
+    }
+
+    std::vector<std::string> EscapingLists(const Tree& tree) {
+        return {"../secret", "..", "spells/../../secret", tree.secret, "", ".spells"};
+    }
+
+    void CheckRejects(const LocalDataSource& source, const Tree& tree) {
+        CHECK(source.ReadItem("spells", "fireball").has_value());
+        CHECK(source.ReadList("spells").has_value());
+        for (const auto& [endpoint, index] : EscapingItems(tree)) {
+            if (source.ReadItem(endpoint, index)) {
+                std::cerr << "read item " << endpoint << " / " << index << std::endl;
+                CHECK(false);
+            }
+        }
+        for (const auto& endpoint : EscapingLists(tree)) {
+            if (source.ReadList(endpoint)) {
+                std::cerr << "read list " << endpoint << std::endl;
+                CHECK(false);
+            }
+        }
+    }
+
+    void DirectoryRejectsNamesOutsideTheRoot() {
+        Tree tree;
+        CheckRejects(*OpenDataDirectory(tree.data_dir), tree);
+    }
+
+    void PackRejectsNamesOutsideTheRoot() {
+        Tree tree;
+        std::string pack = tree.root.File("srd.pack");
+        CHECK_EQ(WriteDataPack(tree.data_dir, pack, {"spells"}), size_t{2});
+        CheckRejects(*OpenDataPack(pack), tree);
+    }
+
+    void SafeNames() {
+        CHECK(IsSafeDataName("fireball"));
+        CHECK(IsSafeDataName("ability-scores"));
+        CHECK(IsSafeDataName("a..b"));
+        CHECK(!IsSafeDataName(""));
+        CHECK(!IsSafeDataName("."));
+        CHECK(!IsSafeDataName(".."));
+        CHECK(!IsSafeDataName("../x"));
+        CHECK(!IsSafeDataName("/etc/passwd"));
+        CHECK(!IsSafeDataName("a/b"));
+        CHECK(!IsSafeDataName("a\\b"));
+        CHECK(!IsSafeDataName(std::string("a\0b", 3)));
+    }
+
+    void ClientAnswersEscapesAsNotFound() {
+        Tree tree;
+        ApiClientOptions options;
+        options.data_dir = tree.data_dir;
+        ApiClient client(kFakeBaseUrl, options);
+
+        CHECK_EQ(client.GetItem("spells", "fireball").name, std::string("Name of fireball"));
+        for (const auto& index : {std::string("../../secret"), tree.secret}) {
+            long status = 0;
+            try {
+                client.GetItem("spells", index);
+            } catch (const UpstreamError& e) {
+                status = e.GetHttpStatus();
+            }
+            CHECK_EQ(status, 404L);
+        }
+    }
+}
+
+int main() {
+    Run("DirectoryRejectsNamesOutsideTheRoot", DirectoryRejectsNamesOutsideTheRoot);
+    Run("PackRejectsNamesOutsideTheRoot", PackRejectsNamesOutsideTheRoot);
+    Run("SafeNames", SafeNames);
+    Run("ClientAnswersEscapesAsNotFound", ClientAnswersEscapesAsNotFound);
+    return Finish();
+}
@@ -0,0 +1,89 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "dnd5e_service.h"
+#include "negative_cache.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    grpc::StatusCode FetchItem(Dnd5eServiceImpl& service, const std::string& index) {
+        GetItemRequest request;
+        request.set_endpoint("spells");
+        request.set_index(index);
+        GetItemResponse response;
+        return service.GetItem(nullptr, &request, &response).error_code();
+    }
+
+    void UpstreamNotFoundIsAnsweredLocallyUntilTtl() {
+        TempDir data("negative-cache-data");
+        WriteDataDir(data.Path(), {{"spells", {"fireball"}}});
+        auto counts = std::make_shared<RequestCounts>();
+        ServiceOptions options;
+        options.refresh_threads = 0;
+        options.negative_ttl = std::chrono::seconds(1);
+        Dnd5eServiceImpl service(MakeFakeClient(data.Path(), counts, 1.0), options);
+
+        // No list is cached, so only upstream can say the item is missing
+        CHECK_EQ(FetchItem(service, "no-such-spell"), grpc::StatusCode::NOT_FOUND);
+        CHECK_EQ(counts->For("/spells/no-such-spell"), size_t{1});
+
+        for (int i = 0; i < 5; ++i) {
+            CHECK_EQ(FetchItem(service, "no-such-spell"), grpc::StatusCode::NOT_FOUND);
+        }
+        CHECK_EQ(counts->For("/spells/no-such-spell"), size_t{1});
+        auto stats = service.GetNotFoundStats();
+        CHECK_EQ(stats.upstream_not_found, size_t{1});
+        CHECK_EQ(stats.negative_hits, size_t{5});
+
+        // Other items are unaffected
+        CHECK_EQ(FetchItem(service, "fireball"), grpc::StatusCode::OK);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        CHECK_EQ(FetchItem(service, "no-such-spell"), grpc::StatusCode::NOT_FOUND);
+        CHECK_EQ(counts->For("/spells/no-such-spell"), size_t{2});
+        CHECK_EQ(service.GetNotFoundStats().upstream_not_found, size_t{2});
+    }
+
+    void ZeroTtlAlwaysAsksUpstream() {
+        TempDir data("negative-cache-data");
+        WriteDataDir(data.Path(), {{"spells", {"fireball"}}});
+        auto counts = std::make_shared<RequestCounts>();
+        ServiceOptions options;
+        options.refresh_threads = 0;
+        options.negative_ttl = std::chrono::seconds(0);
+        Dnd5eServiceImpl service(MakeFakeClient(data.Path(), counts, 1.0), options);
+
+        for (int i = 0; i < 3; ++i) {
+            CHECK_EQ(FetchItem(service, "no-such-spell"), grpc::StatusCode::NOT_FOUND);
+        }
+        CHECK_EQ(counts->For("/spells/no-such-spell"), size_t{3});
+        CHECK_EQ(service.GetNotFoundStats().negative_hits, size_t{0});
+    }
+
+    void KeysExpireAndTheCacheStaysBounded() {
+        NegativeCache cache(std::chrono::milliseconds(50), 4);
+        cache.Add("spells/a");
+        CHECK(cache.Contains("spells/a"));
+        CHECK(!cache.Contains("spells/b"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(80));
+        CHECK(!cache.Contains("spells/a"));
+
+        for (int i = 0; i < 20; ++i) {
+            cache.Add("spells/" + std::to_string(i));
+            CHECK(cache.GetSize() <= size_t{4});
+        }
+        CHECK(cache.Contains("spells/19"));
+    }
+}
+
+int main() {
+    Run("UpstreamNotFoundIsAnsweredLocallyUntilTtl", UpstreamNotFoundIsAnsweredLocallyUntilTtl);
+    Run("ZeroTtlAlwaysAsksUpstream", ZeroTtlAlwaysAsksUpstream);
+    Run("KeysExpireAndTheCacheStaysBounded", KeysExpireAndTheCacheStaysBounded);
+    return Finish();
+}
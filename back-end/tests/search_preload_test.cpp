@@ -0,0 +1,99 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kv_store_cache.h"
+#include "search_engine.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    const std::vector<std::string> kEndpoints = {"spells", "monsters", "equipment"};
+
+    void WriteLists(const std::string& root) {
+        WriteDataDir(root, {{"spells", {"fireball", "fire-shield"}},
+                            {"monsters", {"fire-giant", "goblin"}},
+                            {"equipment", {"tinderbox"}}});
+    }
+
+    void ConcurrentColdSearchesFetchEachListOnce() {
+        TempDir data("search-preload-data");
+        WriteLists(data.Path());
+        auto counts = std::make_shared<RequestCounts>();
+        SearchEngine engine(MakeFakeClient(data.Path(), counts, 50.0));
+
+        constexpr int kCallers = 8;
+        std::atomic<int> found{0};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < kCallers; ++i) {
+            threads.emplace_back([&]() {
+                if (engine.Search("fire", kEndpoints).size() == 3) {
+                    found++;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        CHECK_EQ(found.load(), kCallers);
+        for (const auto& endpoint : kEndpoints) {
+            CHECK_EQ(counts->For("/" + endpoint), size_t{1});
+        }
+    }
+
+    void ColdSearchIsServedFromL2() {
+        TempDir data("search-preload-data");
+        TempDir store("search-preload-store");
+        WriteLists(data.Path());
+        KvStoreOptions options;
+        options.path = store.File("cache.log");
+        options.max_bytes = size_t{1} << 20;
+
+        {
+            auto l2 = OpenKvStoreCache(options);
+            SearchEngine engine(MakeFakeClient(data.Path(), std::make_shared<RequestCounts>(), 1.0), nullptr,
+                                l2.get());
+            CHECK_EQ(engine.Search("fire", kEndpoints).size(), size_t{3});
+        }
+
+        // A restarted engine finds every list in L2 and does not go upstream
+        auto l2 = OpenKvStoreCache(options);
+        auto counts = std::make_shared<RequestCounts>();
+        SearchEngine engine(MakeFakeClient(data.Path(), counts, 1.0), nullptr, l2.get());
+        CHECK_EQ(engine.Search("fire", kEndpoints).size(), size_t{3});
+        CHECK_EQ(counts->Total(), size_t{0});
+    }
+
+    void AbortedSearchStopsWaiting() {
+        TempDir data("search-preload-data");
+        WriteLists(data.Path());
+        auto counts = std::make_shared<RequestCounts>();
+        SearchEngine engine(MakeFakeClient(data.Path(), counts, 300.0));
+
+        RequestControl control;
+        control.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+        auto started = std::chrono::steady_clock::now();
+        bool expired = false;
+        try {
+            engine.Search("fire", kEndpoints, 100, control);
+        } catch (const DeadlineExceededError&) {
+            expired = true;
+        }
+        CHECK(expired);
+        CHECK(std::chrono::steady_clock::now() - started < std::chrono::milliseconds(250));
+        // Every list was requested up front, not one after another
+        CHECK_EQ(counts->Total(), kEndpoints.size());
+    }
+}
+
+int main() {
+    Run("ConcurrentColdSearchesFetchEachListOnce", ConcurrentColdSearchesFetchEachListOnce);
+    Run("ColdSearchIsServedFromL2", ColdSearchIsServedFromL2);
+    Run("AbortedSearchStopsWaiting", AbortedSearchStopsWaiting);
+    return Finish();
+}
@@ -0,0 +1,76 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "search_engine.h"
+#include "test_support.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    const std::vector<std::string> kEndpoints = {"spells"};
+
+    // Item names are "Name of <index>"
+    std::unique_ptr<SearchEngine> MakeEngine(const TempDir& data) {
+        WriteDataDir(data.Path(), {{"spells", {"fireball", "wall-of-fire", "shield"}}});
+        auto engine = std::make_unique<SearchEngine>(MakeFakeClient(data.Path(), std::make_shared<RequestCounts>(), 1.0));
+        engine->SetResultCacheSize(16);
+        return engine;
+    }
+
+    std::string Describe(const std::vector<SearchHit>& hits) {
+        std::string out;
+        for (const auto& hit : hits) {
+            out += hit.item.index + ":" + hit.matched_field + ":" + std::to_string(hit.relevance_score) + " ";
+        }
+        return out;
+    }
+
+    void QueriesIgnoreCaseAndSurroundingWhitespace() {
+        TempDir data("search-query-data");
+        auto engine = MakeEngine(data);
+        auto expected = Describe(engine->Search("fire", kEndpoints));
+        CHECK_EQ(expected, std::string("fireball:name:1.000000 wall-of-fire:name:0.800000 "));
+        for (const std::string query : {"FIRE", "  Fire\t", "\nfIrE  "}) {
+            CHECK_EQ(Describe(engine->Search(query, kEndpoints)), expected);
+            CHECK_EQ(Describe(*engine->CachedSearch(query, kEndpoints, 100)), expected);
+        }
+    }
+
+    void ScoringIgnoresCase() {
+        TempDir data("search-query-data");
+        auto engine = MakeEngine(data);
+        // Exact index match despite the case difference
+        auto hits = engine->Search("FIREBALL", kEndpoints);
+        CHECK_EQ(hits.size(), size_t{1});
+        CHECK(!hits.empty() && hits[0].relevance_score == 1.0f);
+        // Prefix of the name, which starts with "Name of"
+        hits = engine->Search("NAME OF S", kEndpoints);
+        CHECK_EQ(Describe(hits), std::string("shield:name:1.000000 "));
+    }
+
+    void BlankQueriesMatchNothing() {
+        TempDir data("search-query-data");
+        auto engine = MakeEngine(data);
+        for (const std::string query : {"", " ", " \t\n "}) {
+            CHECK(engine->Search(query, kEndpoints).empty());
+            CHECK(engine->CachedSearch(query, kEndpoints, 100)->empty());
+        }
+    }
+
+    void InteriorWhitespaceIsKept() {
+        TempDir data("search-query-data");
+        auto engine = MakeEngine(data);
+        CHECK_EQ(engine->Search("name of", kEndpoints).size(), size_t{3});
+        CHECK(engine->Search("name  of", kEndpoints).empty());
+    }
+}
+
+int main() {
+    Run("QueriesIgnoreCaseAndSurroundingWhitespace", QueriesIgnoreCaseAndSurroundingWhitespace);
+    Run("ScoringIgnoresCase", ScoringIgnoresCase);
+    Run("BlankQueriesMatchNothing", BlankQueriesMatchNothing);
+    Run("InteriorWhitespaceIsKept", InteriorWhitespaceIsKept);
+    return Finish();
+}
@@ -0,0 +1,274 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "single_flight.h"
+#include "test_support.h"
+#include "upstream_error.h"
+
+using namespace dnd5e;
+using namespace dnd5e::testing;
+
+namespace {
+    constexpr int kCallers = 8;
+
+    // Starts kCallers threads at once and waits for them all
+    template <typename Fn>
+    void RunConcurrently(Fn&& fn) {
+        std::atomic<bool> go{false};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < kCallers; ++i) {
+            threads.emplace_back([&, i]() {
+                while (!go) {
+                    std::this_thread::yield();
+                }
+                fn(i);
+            });
+        }
+        go = true;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    void FollowersShareTheLeadersResult() {
+        SingleFlight<int> flights;
+        std::atomic<int> executions{0};
+        std::vector<SingleFlight<int>::ResultPtr> results(kCallers);
+        RunConcurrently([&](int i) {
+            results[i] = flights.Do("key", [&]() {
+                executions++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                return 42;
+            });
+        });
+        CHECK_EQ(executions.load(), 1);
+        CHECK_EQ(flights.GetExecutedCount(), size_t{1});
+        CHECK_EQ(flights.GetCoalescedCount(), size_t{kCallers - 1});
+        for (const auto& result : results) {
+            CHECK(result == results[0]);
+            CHECK_EQ(*result, 42);
+        }
+    }
+
+    void DifferentKeysDoNotCoalesce() {
+        SingleFlight<int> flights;
+        std::atomic<int> executions{0};
+        RunConcurrently([&](int i) {
+            flights.Do("key-" + std::to_string(i), [&]() {
+                executions++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                return i;
+            });
+        });
+        CHECK_EQ(executions.load(), kCallers);
+    }
+
+    void FollowersGetTheLeadersException() {
+        SingleFlight<int> flights;
+        std::atomic<int> executions{0};
+        std::atomic<int> failures{0};
+        RunConcurrently([&](int) {
+            try {
+                flights.Do("key", [&]() -> int {
+                    executions++;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    throw UpstreamError("HTTP error: 503", 503, true);
+                });
+            } catch (const UpstreamError& e) {
+                if (e.GetHttpStatus() == 503) {
+                    failures++;
+                }
+            }
+        });
+        CHECK_EQ(executions.load(), 1);
+        CHECK_EQ(failures.load(), kCallers);
+
+        // A finished call, failed or not, is not reused
+        auto result = flights.Do("key", []() { return 7; });
+        CHECK_EQ(*result, 7);
+    }
+
+    void AbandoningFollowerStopsWaitingAlone() {
+        SingleFlight<int> flights;
+        std::atomic<bool> leader_started{false};
+        SingleFlight<int>::ResultPtr leader_result;
+        std::thread leader([&]() {
+            leader_result = flights.Do("key", [&]() {
+                leader_started = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(300));
+                return 1;
+            });
+        });
+        while (!leader_started) {
+            std::this_thread::yield();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto give_up_at = start + std::chrono::milliseconds(30);
+        bool abandoned = false;
+        try {
+            flights.Do("key", []() { return 2; }, [&]() {
+                if (std::chrono::steady_clock::now() >= give_up_at) {
+                    throw RequestCancelledError();
+                }
+            });
+        } catch (const RequestCancelledError&) {
+            abandoned = true;
+        }
+        auto waited = std::chrono::steady_clock::now() - start;
+        leader.join();
+
+        CHECK(abandoned);
+        CHECK(waited < std::chrono::milliseconds(200));
+        CHECK(leader_result && *leader_result == 1);
+        CHECK_EQ(flights.GetExecutedCount(), size_t{1});
+    }
+
+    void AsyncCallersJoinABlockingLeader() {
+        SingleFlight<int> flights;
+        std::atomic<bool> leader_started{false};
+        std::thread leader([&]() {
+            flights.Do("key", [&]() {
+                leader_started = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                return 5;
+            });
+        });
+        while (!leader_started) {
+            std::this_thread::yield();
+        }
+
+        std::atomic<int> starts{0};
+        std::promise<int> answer;
+        flights.DoAsync("key", [&](auto) { starts++; },
+                        [&](SingleFlight<int>::ResultPtr result, std::exception_ptr error) {
+                            answer.set_value(error ? -1 : *result);
+                        });
+        leader.join();
+
+        CHECK_EQ(answer.get_future().get(), 5);
+        CHECK_EQ(starts.load(), 0);
+        CHECK_EQ(flights.GetExecutedCount(), size_t{1});
+    }
+
+    void ConcurrentAsyncListFetchesHitUpstreamOnce() {
+        TempDir data("single-flight-data");
+        WriteDataDir(data.Path(), {{"spells", {"fireball", "shield"}}});
+        auto counts = std::make_shared<RequestCounts>();
+        auto client = MakeFakeClient(data.Path(), counts, 50.0);
+
+        std::vector<std::future<ApiClient::ApiResponse>> futures;
+        for (int i = 0; i < kCallers; ++i) {
+            futures.push_back(client->GetListAsync("spells"));
+        }
+        // A blocking caller arriving meanwhile joins the same fetch
+        CHECK_EQ(client->GetList("spells").results.size(), size_t{2});
+        for (auto& future : futures) {
+            CHECK_EQ(future.get().results.size(), size_t{2});
+        }
+        CHECK_EQ(counts->For("/spells"), size_t{1});
+    }
+
+    void ConcurrentAsyncItemFetchesShareFailures() {
+        TempDir data("single-flight-data");
+        WriteDataDir(data.Path(), {{"spells", {"fireball"}}});
+        auto counts = std::make_shared<RequestCounts>();
+        auto client = MakeFakeClient(data.Path(), counts, 50.0);
+
+        std::vector<std::future<ApiClient::ItemResponse>> found;
+        std::vector<std::future<ApiClient::ItemResponse>> missing;
+        for (int i = 0; i < kCallers; ++i) {
+            found.push_back(client->GetItemAsync("spells", "fireball"));
+            missing.push_back(client->GetItemAsync("spells", "no-such-spell"));
+        }
+        int not_found = 0;
+        for (int i = 0; i < kCallers; ++i) {
+            CHECK_EQ(found[i].get().name, std::string("Name of fireball"));
+            try {
+                missing[i].get();
+            } catch (const UpstreamError& e) {
+                if (e.GetHttpStatus() == 404) {
+                    not_found++;
+                }
+            }
+        }
+        CHECK_EQ(counts->For("/spells/fireball"), size_t{1});
+        CHECK_EQ(counts->For("/spells/no-such-spell"), size_t{1});
+        CHECK_EQ(not_found, kCallers);
+    }
+
+    void ConcurrentItemFetchesHitUpstreamOnce() {
+        TempDir data("single-flight-data");
+        WriteDataDir(data.Path(), {{"spells", {"fireball", "shield"}}});
+        auto counts = std::make_shared<RequestCounts>();
+        auto client = MakeFakeClient(data.Path(), counts, 50.0);
+
+        std::vector<std::string> names(kCallers);
+        RunConcurrently([&](int i) {
+            names[i] = client->GetItem("spells", "fireball").name;
+        });
+        CHECK_EQ(counts->For("/spells/fireball"), size_t{1});
+        for (const auto& name : names) {
+            CHECK_EQ(name, std::string("Name of fireball"));
+        }
+
+        // Sequential calls are separate flights
+        client->GetItem("spells", "fireball");
+        CHECK_EQ(counts->For("/spells/fireball"), size_t{2});
+    }
+
+    void ConcurrentListFetchesHitUpstreamOnce() {
+        TempDir data("single-flight-data");
+        WriteDataDir(data.Path(), {{"spells", {"fireball", "shield"}}});
+        auto counts = std::make_shared<RequestCounts>();
+        auto client = MakeFakeClient(data.Path(), counts, 50.0);
+
+        std::atomic<int> complete{0};
+        RunConcurrently([&](int) {
+            if (client->GetList("spells").results.size() == 2) {
+                complete++;
+            }
+        });
+        CHECK_EQ(counts->For("/spells"), size_t{1});
+        CHECK_EQ(complete.load(), kCallers);
+    }
+
+    void UpstreamFailureReachesEveryCaller() {
+        TempDir data("single-flight-data");
+        WriteDataDir(data.Path(), {{"spells", {"fireball"}}});
+        auto counts = std::make_shared<RequestCounts>();
+        auto client = MakeFakeClient(data.Path(), counts, 50.0);
+
+        std::atomic<int> not_found{0};
+        RunConcurrently([&](int) {
+            try {
+                client->GetItem("spells", "no-such-spell");
+            } catch (const UpstreamError& e) {
+                if (e.GetHttpStatus() == 404) {
+                    not_found++;
+                }
+            }
+        });
+        // 404 is not retried, so one shared request answers everyone
+        CHECK_EQ(counts->For("/spells/no-such-spell"), size_t{1});
+        CHECK_EQ(not_found.load(), kCallers);
+    }
+}
+
+int main() {
+    Run("FollowersShareTheLeadersResult", FollowersShareTheLeadersResult);
+    Run("DifferentKeysDoNotCoalesce", DifferentKeysDoNotCoalesce);
+    Run("FollowersGetTheLeadersException", FollowersGetTheLeadersException);
+    Run("AbandoningFollowerStopsWaitingAlone", AbandoningFollowerStopsWaitingAlone);
+    Run("ConcurrentItemFetchesHitUpstreamOnce", ConcurrentItemFetchesHitUpstreamOnce);
+    Run("ConcurrentListFetchesHitUpstreamOnce", ConcurrentListFetchesHitUpstreamOnce);
+    Run("UpstreamFailureReachesEveryCaller", UpstreamFailureReachesEveryCaller);
+    Run("AsyncCallersJoinABlockingLeader", AsyncCallersJoinABlockingLeader);
+    Run("ConcurrentAsyncListFetchesHitUpstreamOnce", ConcurrentAsyncListFetchesHitUpstreamOnce);
+    Run("ConcurrentAsyncItemFetchesShareFailures", ConcurrentAsyncItemFetchesShareFailures);
+    return Finish();
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "api_client.h"
+#include "fake_transport.h"
+
+// Minimal checks for the test executables; a failed CHECK is reported and
+// the test binary exits non-zero from Finish()
+#define CHECK(condition)                                                                           \
+    do {                                                                                           \
+        if (!(condition)) {                                                                        \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #condition << std::endl; \
+            ::dnd5e::testing::Failures()++;                                                        \
+        }                                                                                          \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                 \
+    do {                                                                                           \
+        auto actual_value = (actual);                                                              \
+        auto expected_value = (expected);                                                          \
+        if (!(actual_value == expected_value)) {                                                   \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ failed: " #actual " == " #expected \
+                      << " (" << actual_value << " vs " << expected_value << ")" << std::endl;     \
+            ::dnd5e::testing::Failures()++;                                                        \
+        }                                                                                          \
+    } while (0)
+
+namespace dnd5e::testing {
+
+inline std::atomic<int>& Failures() {
+    static std::atomic<int> failures{0};
+    return failures;
+}
+
+// Runs one named case and reports it
+template <typename Fn>
+void Run(const char* name, Fn&& fn) {
+    int before = Failures();
+    try {
+        fn();
+    } catch (const std::exception& e) {
+        std::cerr << name << ": unexpected exception: " << e.what() << std::endl;
+        Failures()++;
+    }
+    std::cout << (Failures() == before ? "[ OK   ] " : "[ FAIL ] ") << name << std::endl;
+}
+
+inline int Finish() {
+    if (Failures() > 0) {
+        std::cerr << Failures() << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Fresh directory under the system temp dir, removed with the object
+class TempDir {
+public:
+    explicit TempDir(const std::string& name)
+        : path_(std::filesystem::temp_directory_path() /
+                (name + "-" + std::to_string(::getpid()) + "-" + std::to_string(Counter()++))) {
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    std::string Path() const { return path_.string(); }
+    std::string File(const std::string& name) const { return (path_ / name).string(); }
+
+private:
+    std::filesystem::path path_;
+
+    static std::atomic<int>& Counter() {
+        static std::atomic<int> counter{0};
+        return counter;
+    }
+};
+
+// Writes a small SRD tree in the local data layout: one item file per index
+// and the endpoint's list file
+inline void WriteDataDir(const std::string& root, const std::map<std::string, std::vector<std::string>>& endpoints) {
+    for (const auto& [endpoint, indexes] : endpoints) {
+        std::filesystem::create_directories(std::filesystem::path(root) / endpoint);
+        nlohmann::json results = nlohmann::json::array();
+        for (const auto& index : indexes) {
+            std::string url = "/api/2014/" + endpoint + "/" + index;
+            nlohmann::json item = {{"index", index}, {"name", "Name of " + index}, {"url", url}};
+            std::ofstream(std::filesystem::path(root) / endpoint / (index + ".json")) << item.dump();
+            results.push_back(item);
+        }
+        nlohmann::json list = {{"count", indexes.size()}, {"results", results}};
+        std::ofstream(std::filesystem::path(root) / (endpoint + ".json")) << list.dump();
+    }
+}
+
+// Upstream requests seen by a CountingTransport, keyed by URL
+class RequestCounts {
+public:
+    void Add(const std::string& url) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        counts_[url]++;
+        total_++;
+    }
+    size_t Total() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return total_;
+    }
+    // Requests whose URL ends with suffix, e.g. "/spells/fireball"
+    size_t For(const std::string& suffix) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t count = 0;
+        for (const auto& [url, n] : counts_) {
+            if (url.size() >= suffix.size() && url.compare(url.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                count += n;
+            }
+        }
+        return count;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, size_t> counts_;
+    size_t total_ = 0;
+};
+
+// FakeTransport that records every request it is handed
+class CountingTransport final : public UpstreamTransport {
+public:
+    CountingTransport(const FakeTransportOptions& options, std::shared_ptr<RequestCounts> counts)
+        : inner_(options), counts_(std::move(counts)) {}
+
+    const char* GetName() const override { return "counting-fake"; }
+
+    void Perform(const UpstreamRequest& request, UpstreamResponse& response) override {
+        counts_->Add(request.url);
+        inner_.Perform(request, response);
+    }
+
+    RequestId Submit(const UpstreamRequest& request, std::shared_ptr<UpstreamResponse> response,
+                     Completion on_done) override {
+        counts_->Add(request.url);
+        return inner_.Submit(request, std::move(response), std::move(on_done));
+    }
+
+    void Cancel(RequestId id) override { inner_.Cancel(id); }
+
+    void Schedule(Clock::time_point when, std::function<void()> fn) override {
+        inner_.Schedule(when, std::move(fn));
+    }
+
+private:
+    FakeTransport inner_;
+    std::shared_ptr<RequestCounts> counts_;
+};
+
+inline FakeTransportOptions FakeOptions(const std::string& data_dir, const std::string& base_url,
+                                        double latency_ms = 5.0) {
+    FakeTransportOptions options;
+    options.data_dir = data_dir;
+    options.base_url = base_url;
+    options.latency_median_ms = latency_ms;
+    options.latency_sigma = 0.01;
+    return options;
+}
+
+constexpr const char* kFakeBaseUrl = "http://upstream.test/api/2014";
+
+// ApiClient whose upstream is the data_dir tree, counting requests into counts
+inline std::shared_ptr<ApiClient> MakeFakeClient(const std::string& data_dir, std::shared_ptr<RequestCounts> counts,
+                                                 double latency_ms = 5.0,
+                                                 const ApiClientOptions& options = ApiClientOptions()) {
+    return std::make_shared<ApiClient>(
+        kFakeBaseUrl, options,
+        std::make_unique<CountingTransport>(FakeOptions(data_dir, kFakeBaseUrl, latency_ms), std::move(counts)));
+}
+
+} // namespace dnd5e::testing